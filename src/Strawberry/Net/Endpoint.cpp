@@ -97,13 +97,13 @@ namespace Strawberry::Net
 
 	Endpoint Endpoint::AnyIPv4(uint16_t portNumber) noexcept
 	{
-		return Endpoint(IPv6Address::Any(), portNumber);
+		return Endpoint(IPv4Address::Any(), portNumber);
 	}
 
 
 	Endpoint Endpoint::AnyIPv6(uint16_t portNumber) noexcept
 	{
-		return Endpoint(IPv4Address::Any(), portNumber);
+		return Endpoint(IPv6Address::Any(), portNumber);
 	}
 
 
@@ -2,6 +2,8 @@
 
 
 #include "Strawberry/Core/Types/Variant.hpp"
+// Standard Library
+#include <cstddef>
 
 
 namespace Strawberry::Net
@@ -25,6 +27,12 @@ namespace Strawberry::Net
 	struct ErrorMessageSize{};
 	struct ErrorIPAddressFamily{};
 	struct ErrorAddressNotAvailable{};
+	struct ErrorNotSupported{};
+	struct ErrorWantRead{};
+	/// A non-blocking operation has to wait for the socket to be writable.
+	/// Writes which sent part of their data first say how much.
+	struct ErrorWantWrite { size_t bytesWritten = 0; };
+	struct ErrorTimeout{};
 	struct ErrorUnknown{};
 
 
@@ -49,5 +57,9 @@ namespace Strawberry::Net
 		ErrorMessageSize,
 		ErrorIPAddressFamily,
 		ErrorAddressNotAvailable,
+		ErrorNotSupported,
+		ErrorWantRead,
+		ErrorWantWrite,
+		ErrorTimeout,
 		ErrorUnknown>;
 }
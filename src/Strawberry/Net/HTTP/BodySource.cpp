@@ -0,0 +1,48 @@
+#include "Strawberry/Net/HTTP/BodySource.hpp"
+
+
+#include "Strawberry/Core/IO/Logging.hpp"
+#include <cerrno>
+
+
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+#include <unistd.h>
+#elif STRAWBERRY_TARGET_WINDOWS
+#include <io.h>
+#endif
+
+
+namespace Strawberry::Net::HTTP
+{
+    BodySource::BodySource(Generator generator, Core::Optional<size_t> length)
+        : mGenerator(std::move(generator))
+        , mLength(length) {}
+
+
+    BodySource BodySource::FromFileDescriptor(int fileDescriptor, Core::Optional<size_t> length)
+    {
+        return BodySource([fileDescriptor, remaining = length](std::span<uint8_t> buffer) mutable -> Core::Result<size_t, Error>
+        {
+            size_t count = remaining ? std::min(*remaining, buffer.size()) : buffer.size();
+            if (count == 0) return size_t(0);
+
+            while (true)
+            {
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+                auto bytesRead = read(fileDescriptor, buffer.data(), count);
+#elif STRAWBERRY_TARGET_WINDOWS
+                auto bytesRead = _read(fileDescriptor, buffer.data(), static_cast<unsigned int>(count));
+#endif
+                if (bytesRead < 0)
+                {
+                    if (errno == EINTR) continue;
+                    Core::Logging::Error("Failed to read HTTP request body from file. Error code: {}.", errno);
+                    return Error(ErrorSystem {});
+                }
+
+                if (remaining) *remaining -= static_cast<size_t>(bytesRead);
+                return static_cast<size_t>(bytesRead);
+            }
+        }, length);
+    }
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,83 @@
+#pragma once
+
+
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <span>
+
+
+namespace Strawberry::Net::HTTP
+{
+    /// A request body which is produced a part at a time while it is sent, so it never has to be held in memory.
+    /// Bodies of known length are sent with Content-Length, and others with chunked transfer coding.
+    class BodySource
+    {
+        public:
+            /// Writes the next part of the body into the buffer, and returns how many bytes it wrote, or 0 at the end.
+            using Generator = std::function<Core::Result<size_t, Error>(std::span<uint8_t> buffer)>;
+
+
+            explicit BodySource(Generator generator, Core::Optional<size_t> length = {});
+
+
+            /// Reads the body from a file descriptor, until the end of the file or until length bytes have been read.
+            /// The descriptor is left open.
+            static BodySource FromFileDescriptor(int fileDescriptor, Core::Optional<size_t> length = {});
+
+
+            /// Sends each buffer in turn. The buffers are read while the body is sent, so must outlive it.
+            template<std::forward_iterator I>
+                requires std::convertible_to<std::iter_reference_t<I>, std::span<const uint8_t>>
+            static BodySource FromBuffers(I begin, I end)
+            {
+                size_t length = 0;
+                for (auto it = begin; it != end; ++it) length += std::span<const uint8_t>(*it).size();
+
+                return BodySource([begin, end, offset = size_t(0)](std::span<uint8_t> buffer) mutable -> Core::Result<size_t, Error>
+                {
+                    size_t written = 0;
+                    while (begin != end && written < buffer.size())
+                    {
+                        std::span<const uint8_t> current = *begin;
+                        size_t count = std::min(current.size() - offset, buffer.size() - written);
+                        std::memcpy(buffer.data() + written, current.data() + offset, count);
+                        written += count;
+                        offset  += count;
+
+                        if (offset == current.size())
+                        {
+                            ++begin;
+                            offset = 0;
+                        }
+                    }
+                    return written;
+                }, length);
+            }
+
+
+            /// Returns the length of the body, if it is known in advance.
+            [[nodiscard]] Core::Optional<size_t> GetLength() const
+            {
+                return mLength;
+            }
+
+
+            /// Writes the next part of the body into the buffer, and returns how many bytes were written, or 0 at the end.
+            Core::Result<size_t, Error> Read(std::span<uint8_t> buffer)
+            {
+                return mGenerator(buffer);
+            }
+
+        private:
+            Generator              mGenerator;
+            Core::Optional<size_t> mLength;
+    };
+} // namespace Strawberry::Net::HTTP
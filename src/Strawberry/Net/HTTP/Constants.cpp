@@ -4,22 +4,25 @@
 #include "Strawberry/Core/Util/Strings.hpp"
 
 
+#include <array>
+#include <cstdint>
+#include <iterator>
 #include <map>
 
 
 namespace Strawberry::Net::HTTP
 {
-    std::string Verb::ToString() const
+    std::string_view Verb::ToString() const
     {
-        switch (*this)
-        {
-            case Verb::POST: return "POST";
-            case Verb::GET: return "GET";
-            case Verb::PUT: return "PUT";
-            case Verb::PATCH: return "PATCH";
-            case Verb::DEL: return "DELETE";
-            default: std::abort();
-        }
+        static constexpr std::string_view NAMES[] = {"POST", "GET", "PUT", "PATCH", "DELETE"};
+        if (static_cast<size_t>(mValue) >= std::size(NAMES)) std::abort();
+        return NAMES[mValue];
+    }
+
+
+    bool Verb::IsIdempotent() const
+    {
+        return *this == Verb::GET || *this == Verb::PUT || *this == Verb::DEL;
     }
 
 
@@ -45,35 +48,160 @@ namespace Strawberry::Net::HTTP
     }
 
 
-    Core::Optional<Version> Version::Parse(const std::string& string)
+    Core::Optional<Version> Version::Parse(std::string_view string)
     {
-        static const std::map<std::string, Version> mapping = {
-            {"1.0", Version::VERSION_1_0},
-            {"1.1", Version::VERSION_1_1},
-            {"2", Version::VERSION_2},
-            {"3", Version::VERSION_3},
-        };
+        if (string == "1.1") return Version::VERSION_1_1;
+        if (string == "1.0") return Version::VERSION_1_0;
+        if (string == "2") return Version::VERSION_2;
+        if (string == "3") return Version::VERSION_3;
+        return {};
+    }
+
+
+    std::string_view Version::ToString() const
+    {
+        static constexpr std::string_view NAMES[] = {"1.0", "1.1", "2", "3"};
+        if (static_cast<size_t>(mValue) >= std::size(NAMES)) std::abort();
+        return NAMES[mValue];
+    }
+
+
+    /// Names of the well-known header fields, in the order of HeaderName::_Enum.
+    static constexpr std::array<std::string_view, HeaderName::COUNT> HEADER_NAMES = {
+        "Accept",
+        "Accept-Encoding",
+        "Accept-Language",
+        "Accept-Ranges",
+        "Age",
+        "Allow",
+        "Authorization",
+        "Cache-Control",
+        "Connection",
+        "Content-Disposition",
+        "Content-Encoding",
+        "Content-Language",
+        "Content-Length",
+        "Content-Location",
+        "Content-Range",
+        "Content-Type",
+        "Cookie",
+        "Date",
+        "ETag",
+        "Expect",
+        "Expires",
+        "Host",
+        "If-Match",
+        "If-Modified-Since",
+        "If-None-Match",
+        "If-Range",
+        "If-Unmodified-Since",
+        "Keep-Alive",
+        "Last-Modified",
+        "Location",
+        "Origin",
+        "Pragma",
+        "Proxy-Authorization",
+        "Proxy-Connection",
+        "Range",
+        "Referer",
+        "Retry-After",
+        "Sec-WebSocket-Accept",
+        "Sec-WebSocket-Key",
+        "Sec-WebSocket-Version",
+        "Server",
+        "Set-Cookie",
+        "TE",
+        "Trailer",
+        "Transfer-Encoding",
+        "Upgrade",
+        "User-Agent",
+        "Vary",
+        "Via",
+        "WWW-Authenticate",
+    };
 
-        if (mapping.contains(string))
+
+    static constexpr char ToLowercase(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+
+    /// Case-insensitive FNV-1a, seeded and mixed so that each seed gives unrelated slots.
+    static constexpr uint32_t HashHeaderName(std::string_view name, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : name)
         {
-            return mapping.at(string);
+            hash ^= static_cast<uint8_t>(ToLowercase(c));
+            hash *= 16777619u;
         }
-        else
+
+        hash ^= hash >> 15;
+        hash *= 0x2C1B3C6Du;
+        hash ^= hash >> 12;
+        return hash;
+    }
+
+
+    static constexpr size_t HEADER_HASH_SLOTS = 256;
+    static constexpr uint8_t HEADER_HASH_EMPTY = 0xFF;
+    static_assert(HeaderName::COUNT < HEADER_HASH_EMPTY);
+
+
+    /// Finds the first seed which gives every well-known name its own slot.
+    static constexpr uint32_t FindHeaderHashSeed()
+    {
+        for (uint32_t seed = 0;; seed++)
         {
-            return {};
+            std::array<bool, HEADER_HASH_SLOTS> used {};
+            bool                                collision = false;
+            for (auto name : HEADER_NAMES)
+            {
+                auto& slot = used[HashHeaderName(name, seed) % HEADER_HASH_SLOTS];
+                collision |= slot;
+                slot = true;
+            }
+
+            if (!collision) return seed;
         }
     }
 
 
-    std::string Version::ToString() const
+    static constexpr uint32_t HEADER_HASH_SEED = FindHeaderHashSeed();
+
+
+    static constexpr std::array<uint8_t, HEADER_HASH_SLOTS> HEADER_HASH_TABLE = []()
     {
-        switch (*this)
+        std::array<uint8_t, HEADER_HASH_SLOTS> table {};
+        table.fill(HEADER_HASH_EMPTY);
+        for (size_t i = 0; i < HEADER_NAMES.size(); i++)
         {
-            case Version::VERSION_1_0: return "1.0";
-            case Version::VERSION_1_1: return "1.1";
-            case Version::VERSION_2: return "2";
-            case Version::VERSION_3: return "3";
-            default: std::abort();
+            table[HashHeaderName(HEADER_NAMES[i], HEADER_HASH_SEED) % HEADER_HASH_SLOTS] = static_cast<uint8_t>(i);
         }
+        return table;
+    }();
+
+
+    Core::Optional<HeaderName> HeaderName::Parse(std::string_view string)
+    {
+        const uint8_t index = HEADER_HASH_TABLE[HashHeaderName(string, HEADER_HASH_SEED) % HEADER_HASH_SLOTS];
+        if (index == HEADER_HASH_EMPTY) return {};
+
+        // Any string can hash to a slot, so check it really is the name there.
+        const auto name = HEADER_NAMES[index];
+        if (name.size() != string.size()) return {};
+        for (size_t i = 0; i < name.size(); i++)
+        {
+            if (ToLowercase(name[i]) != ToLowercase(string[i])) return {};
+        }
+
+        return static_cast<HeaderName::_Enum>(index);
+    }
+
+
+    std::string_view HeaderName::ToString() const
+    {
+        return HEADER_NAMES[mValue];
     }
 } // namespace Strawberry::Net::HTTP
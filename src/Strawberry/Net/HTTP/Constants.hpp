@@ -2,7 +2,9 @@
 
 
 #include "Strawberry/Core/Types/Optional.hpp"
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 
 namespace Strawberry::Net::HTTP
@@ -30,8 +32,11 @@ namespace Strawberry::Net::HTTP
             }
 
 
-            static Core::Optional<Verb> Parse(const std::string& string);
-            [[nodiscard]] std::string   ToString() const;
+            static Core::Optional<Verb>   Parse(const std::string& string);
+            [[nodiscard]] std::string_view ToString() const;
+            /// Returns whether repeating a request with this method has the same effect as sending it once,
+            /// so that it can safely be retried (RFC 9110 section 9.2.2).
+            [[nodiscard]] bool          IsIdempotent() const;
 
         private:
             _Enum mValue;
@@ -60,8 +65,90 @@ namespace Strawberry::Net::HTTP
             }
 
 
-            static Core::Optional<Version> Parse(const std::string& string);
-            [[nodiscard]] std::string      ToString() const;
+            static Core::Optional<Version> Parse(std::string_view string);
+            [[nodiscard]] std::string_view ToString() const;
+
+        private:
+            _Enum mValue;
+    };
+
+
+    /// The header field names which Header can find without comparing strings.
+    class HeaderName
+    {
+        public:
+            enum _Enum
+            {
+                ACCEPT,
+                ACCEPT_ENCODING,
+                ACCEPT_LANGUAGE,
+                ACCEPT_RANGES,
+                AGE,
+                ALLOW,
+                AUTHORIZATION,
+                CACHE_CONTROL,
+                CONNECTION,
+                CONTENT_DISPOSITION,
+                CONTENT_ENCODING,
+                CONTENT_LANGUAGE,
+                CONTENT_LENGTH,
+                CONTENT_LOCATION,
+                CONTENT_RANGE,
+                CONTENT_TYPE,
+                COOKIE,
+                DATE,
+                ETAG,
+                EXPECT,
+                EXPIRES,
+                HOST,
+                IF_MATCH,
+                IF_MODIFIED_SINCE,
+                IF_NONE_MATCH,
+                IF_RANGE,
+                IF_UNMODIFIED_SINCE,
+                KEEP_ALIVE,
+                LAST_MODIFIED,
+                LOCATION,
+                ORIGIN,
+                PRAGMA,
+                PROXY_AUTHORIZATION,
+                PROXY_CONNECTION,
+                RANGE,
+                REFERER,
+                RETRY_AFTER,
+                SEC_WEBSOCKET_ACCEPT,
+                SEC_WEBSOCKET_KEY,
+                SEC_WEBSOCKET_VERSION,
+                SERVER,
+                SET_COOKIE,
+                TE,
+                TRAILER,
+                TRANSFER_ENCODING,
+                UPGRADE,
+                USER_AGENT,
+                VARY,
+                VIA,
+                WWW_AUTHENTICATE,
+            };
+
+
+            static constexpr size_t COUNT = WWW_AUTHENTICATE + 1;
+
+        public:
+            inline HeaderName(_Enum value)
+                : mValue(value) {}
+
+
+            inline operator _Enum() const
+            {
+                return mValue;
+            }
+
+
+            /// Returns the well-known name which matches the string case-insensitively, using a perfect hash.
+            static Core::Optional<HeaderName> Parse(std::string_view string);
+            /// Returns the name with its conventional capitalisation, such as "Content-Length".
+            [[nodiscard]] std::string_view    ToString() const;
 
         private:
             _Enum mValue;
@@ -0,0 +1,188 @@
+#include "Strawberry/Net/HTTP/ContentDecoder.hpp"
+
+
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/Logging.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <limits>
+
+
+namespace Strawberry::Net::HTTP
+{
+    static std::string ToLowercase(std::string_view string)
+    {
+        std::string lowercase(string);
+        for (auto& c : lowercase) c = c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        return lowercase;
+    }
+
+
+    struct ZlibDecoder::Stream
+    {
+        z_stream stream {};
+    };
+
+
+    /// Window bits for inflateInit2 which accept either a gzip or a zlib header.
+    static constexpr int DETECT_HEADER_WINDOW_BITS = 15 + 32;
+    /// Window bits for inflateInit2 which read raw deflate data, with no header.
+    static constexpr int RAW_WINDOW_BITS           = -15;
+
+
+    ZlibDecoder::ZlibDecoder(Format format)
+        : mFormat(format)
+        , mStream(std::make_unique<Stream>())
+    {
+        auto result = inflateInit2(&mStream->stream, DETECT_HEADER_WINDOW_BITS);
+        Core::Assert(result == Z_OK);
+    }
+
+
+    ZlibDecoder::~ZlibDecoder()
+    {
+        inflateEnd(&mStream->stream);
+    }
+
+
+    Core::Result<ContentDecoder::Progress, Error> ZlibDecoder::Decode(std::span<const uint8_t> input, std::span<uint8_t> output)
+    {
+        auto& stream = mStream->stream;
+
+        if (mFinished && !input.empty())
+        {
+            // A gzip body may hold several members one after another (RFC 1952 section 2.2).
+            if (mFormat != Format::GZip)
+            {
+                Core::Logging::Error("Received data after the end of a deflate HTTP body.");
+                return Error(ErrorProtocolError {});
+            }
+
+            inflateReset(&stream);
+            mFinished = false;
+        }
+
+        constexpr size_t MAX_LENGTH = std::numeric_limits<uInt>::max();
+        stream.next_in              = const_cast<Bytef*>(input.data());
+        stream.avail_in             = static_cast<uInt>(std::min(input.size(), MAX_LENGTH));
+        stream.next_out             = output.data();
+        stream.avail_out            = static_cast<uInt>(std::min(output.size(), MAX_LENGTH));
+        const auto availableIn      = stream.avail_in;
+        const auto availableOut     = stream.avail_out;
+        const auto previousTotalIn  = stream.total_in;
+
+        // Keep the start of the data, in case it turns out to be raw deflate and has to be read again.
+        while (mFormat == Format::Deflate && !mRaw && mPrefixLength < mPrefix.size() && mPrefixLength - previousTotalIn < input.size())
+        {
+            mPrefix[mPrefixLength] = input[mPrefixLength - previousTotalIn];
+            mPrefixLength++;
+        }
+
+        auto result = inflate(&stream, Z_NO_FLUSH);
+
+        Progress progress {availableIn - stream.avail_in, availableOut - stream.avail_out};
+        switch (result)
+        {
+            case Z_STREAM_END:
+                mFinished = true;
+                [[fallthrough]];
+            case Z_OK:
+            // No progress was possible, because there was no input or no room for output.
+            case Z_BUF_ERROR:
+                return progress;
+            case Z_DATA_ERROR:
+                // Some servers send deflate bodies without the zlib wrapper, which shows up before any output.
+                if (mFormat == Format::Deflate && !mRaw && stream.total_out == 0)
+                {
+                    inflateEnd(&stream);
+                    stream = z_stream {};
+                    auto initResult = inflateInit2(&stream, RAW_WINDOW_BITS);
+                    Core::Assert(initResult == Z_OK);
+                    mRaw = true;
+
+                    // The zlib header is two bytes, so at most one byte was consumed by earlier calls. One byte
+                    // isn't enough for raw deflate to produce any output, so it can be fed back in on its own.
+                    uint8_t unused;
+                    stream.next_in   = mPrefix.data();
+                    stream.avail_in  = static_cast<uInt>(previousTotalIn);
+                    stream.next_out  = &unused;
+                    stream.avail_out = 0;
+                    if (previousTotalIn > 0 && inflate(&stream, Z_NO_FLUSH) != Z_OK)
+                    {
+                        Core::Logging::Error("Failed to decode HTTP body. zlib error: {}.", stream.msg ? stream.msg : "unknown");
+                        return Error(ErrorProtocolError {});
+                    }
+
+                    return Decode(input, output);
+                }
+                [[fallthrough]];
+            default:
+                Core::Logging::Error("Failed to decode HTTP body. zlib error: {}.", stream.msg ? stream.msg : "unknown");
+                return Error(ErrorProtocolError {});
+        }
+    }
+
+
+    bool ZlibDecoder::IsFinished() const
+    {
+        return mFinished;
+    }
+
+
+    ContentDecoderRegistry ContentDecoderRegistry::Default()
+    {
+        ContentDecoderRegistry registry;
+        registry.Register("gzip", [] { return std::make_unique<ZlibDecoder>(ZlibDecoder::Format::GZip); });
+        registry.Register("deflate", [] { return std::make_unique<ZlibDecoder>(ZlibDecoder::Format::Deflate); });
+        return registry;
+    }
+
+
+    void ContentDecoderRegistry::Register(std::string coding, Factory factory)
+    {
+        mFactories.insert_or_assign(ToLowercase(coding), std::move(factory));
+        UpdateAcceptEncoding();
+    }
+
+
+    void ContentDecoderRegistry::Unregister(std::string_view coding)
+    {
+        if (auto it = mFactories.find(ToLowercase(coding)); it != mFactories.end())
+        {
+            mFactories.erase(it);
+            UpdateAcceptEncoding();
+        }
+    }
+
+
+    std::unique_ptr<ContentDecoder> ContentDecoderRegistry::Create(std::string_view contentEncoding) const
+    {
+        while (!contentEncoding.empty() && (contentEncoding.front() == ' ' || contentEncoding.front() == '\t')) contentEncoding.remove_prefix(1);
+        while (!contentEncoding.empty() && (contentEncoding.back() == ' ' || contentEncoding.back() == '\t')) contentEncoding.remove_suffix(1);
+
+        auto coding = ToLowercase(contentEncoding);
+        // x-gzip is an old name for gzip (RFC 9110 section 8.4.1.3).
+        if (coding == "x-gzip") coding = "gzip";
+        if (coding.empty() || coding == "identity") return nullptr;
+
+        auto it = mFactories.find(coding);
+        if (it == mFactories.end())
+        {
+            Core::Logging::Info("Leaving HTTP body with content coding {} undecoded.", coding);
+            return nullptr;
+        }
+
+        return it->second();
+    }
+
+
+    void ContentDecoderRegistry::UpdateAcceptEncoding()
+    {
+        mAcceptEncoding.clear();
+        for (const auto& [coding, factory] : mFactories)
+        {
+            if (!mAcceptEncoding.empty()) mAcceptEncoding += ", ";
+            mAcceptEncoding += coding;
+        }
+    }
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,117 @@
+#pragma once
+
+
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+
+namespace Strawberry::Net::HTTP
+{
+    /// Removes a content coding such as gzip from a response body, a part at a time.
+    ///
+    /// The interface follows the streaming APIs of zlib, brotli and zstd, so that any of them can be plugged in.
+    class ContentDecoder
+    {
+        public:
+            struct Progress
+            {
+                /// Bytes of input which were used.
+                size_t consumed;
+                /// Bytes of output which were written.
+                size_t produced;
+            };
+
+
+            virtual ~ContentDecoder() = default;
+
+
+            /// Decodes as much of the input into the output as will fit. When the output is filled,
+            /// more may be produced by calling again, even without more input.
+            virtual Core::Result<Progress, Error> Decode(std::span<const uint8_t> input, std::span<uint8_t> output) = 0;
+            /// Returns whether the end of the encoded data has been reached.
+            [[nodiscard]] virtual bool            IsFinished() const = 0;
+    };
+
+
+    /// Decodes gzip and deflate codings with zlib.
+    class ZlibDecoder : public ContentDecoder
+    {
+        public:
+            enum class Format
+            {
+                GZip,
+                /// The zlib format. Raw deflate data, which some servers send instead, is also accepted.
+                Deflate,
+            };
+
+
+            explicit ZlibDecoder(Format format);
+            ZlibDecoder(const ZlibDecoder&)            = delete;
+            ZlibDecoder& operator=(const ZlibDecoder&) = delete;
+            ~ZlibDecoder() override;
+
+
+            Core::Result<Progress, Error> Decode(std::span<const uint8_t> input, std::span<uint8_t> output) override;
+            [[nodiscard]] bool            IsFinished() const override;
+
+        private:
+            struct Stream;
+
+
+            Format                  mFormat;
+            std::unique_ptr<Stream> mStream;
+            bool                    mFinished = false;
+            /// Whether the zlib wrapper was missing, so the data is being read as raw deflate.
+            bool                    mRaw      = false;
+            /// The first bytes of deflate data, which are read again if they weren't a zlib header.
+            std::array<uint8_t, 2>  mPrefix {};
+            size_t                  mPrefixLength = 0;
+    };
+
+
+    /// The content codings which a client accepts, and how to decode each of them.
+    class ContentDecoderRegistry
+    {
+        public:
+            using Factory = std::function<std::unique_ptr<ContentDecoder>()>;
+
+
+            /// Returns a registry with gzip and deflate.
+            static ContentDecoderRegistry Default();
+
+
+            /// Adds support for a content coding, or replaces it. This is how codings such as "br" and "zstd"
+            /// can be supported, by wrapping those libraries in a ContentDecoder.
+            void Register(std::string coding, Factory factory);
+            /// Removes support for a content coding.
+            void Unregister(std::string_view coding);
+
+
+            /// Creates a decoder for the value of a Content-Encoding field. Returns nullptr for identity,
+            /// unregistered codings, and multiple codings, since those bodies can only be passed on as they are.
+            [[nodiscard]] std::unique_ptr<ContentDecoder> Create(std::string_view contentEncoding) const;
+            /// Returns the value for Accept-Encoding which lists every registered coding,
+            /// or an empty string if there are none.
+            [[nodiscard]] const std::string&              GetAcceptEncoding() const
+            {
+                return mAcceptEncoding;
+            }
+
+        private:
+            /// Rebuilds the Accept-Encoding value, so that it isn't built for every request.
+            void UpdateAcceptEncoding();
+
+
+            std::map<std::string, Factory, std::less<>> mFactories;
+            std::string                                 mAcceptEncoding;
+    };
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,579 @@
+#include "Strawberry/Net/HTTP/HPACK.hpp"
+
+
+#include "Strawberry/Core/Assert.hpp"
+#include <array>
+#include <utility>
+
+
+namespace Strawberry::Net::HTTP::HPACK
+{
+    /// The fields which the static table holds, at indices 1 to 61 (RFC 7541 appendix A).
+    static constexpr std::pair<std::string_view, std::string_view> STATIC_TABLE[] = {
+        {":authority", ""},
+        {":method", "GET"},
+        {":method", "POST"},
+        {":path", "/"},
+        {":path", "/index.html"},
+        {":scheme", "http"},
+        {":scheme", "https"},
+        {":status", "200"},
+        {":status", "204"},
+        {":status", "206"},
+        {":status", "304"},
+        {":status", "400"},
+        {":status", "404"},
+        {":status", "500"},
+        {"accept-charset", ""},
+        {"accept-encoding", "gzip, deflate"},
+        {"accept-language", ""},
+        {"accept-ranges", ""},
+        {"accept", ""},
+        {"access-control-allow-origin", ""},
+        {"age", ""},
+        {"allow", ""},
+        {"authorization", ""},
+        {"cache-control", ""},
+        {"content-disposition", ""},
+        {"content-encoding", ""},
+        {"content-language", ""},
+        {"content-length", ""},
+        {"content-location", ""},
+        {"content-range", ""},
+        {"content-type", ""},
+        {"cookie", ""},
+        {"date", ""},
+        {"etag", ""},
+        {"expect", ""},
+        {"expires", ""},
+        {"from", ""},
+        {"host", ""},
+        {"if-match", ""},
+        {"if-modified-since", ""},
+        {"if-none-match", ""},
+        {"if-range", ""},
+        {"if-unmodified-since", ""},
+        {"last-modified", ""},
+        {"link", ""},
+        {"location", ""},
+        {"max-forwards", ""},
+        {"proxy-authenticate", ""},
+        {"proxy-authorization", ""},
+        {"range", ""},
+        {"referer", ""},
+        {"refresh", ""},
+        {"retry-after", ""},
+        {"server", ""},
+        {"set-cookie", ""},
+        {"strict-transport-security", ""},
+        {"transfer-encoding", ""},
+        {"user-agent", ""},
+        {"vary", ""},
+        {"via", ""},
+        {"www-authenticate", ""},
+    };
+    static constexpr size_t STATIC_TABLE_SIZE = std::size(STATIC_TABLE);
+
+
+    /// Each entry's size in the dynamic table counts 32 bytes on top of its name and value.
+    static constexpr size_t ENTRY_OVERHEAD = 32;
+
+
+    /// Appends an integer with an N bit prefix, sharing its first byte with the given flags (RFC 7541 section 5.1).
+    static void EncodeInteger(std::vector<uint8_t>& output, uint8_t flags, unsigned int prefixBits, size_t value)
+    {
+        const size_t prefixMax = (size_t(1) << prefixBits) - 1;
+        if (value < prefixMax)
+        {
+            output.push_back(static_cast<uint8_t>(flags | value));
+            return;
+        }
+
+        output.push_back(static_cast<uint8_t>(flags | prefixMax));
+        value -= prefixMax;
+        while (value >= 0x80)
+        {
+            output.push_back(static_cast<uint8_t>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<uint8_t>(value));
+    }
+
+
+    /// Reads an integer with an N bit prefix from the front of input, and removes it.
+    static Core::Result<size_t, Error> DecodeInteger(std::span<const uint8_t>& input, unsigned int prefixBits)
+    {
+        if (input.empty()) return Error(ErrorProtocolError {});
+
+        const size_t prefixMax = (size_t(1) << prefixBits) - 1;
+        size_t       value     = input[0] & prefixMax;
+        input                  = input.subspan(1);
+        if (value < prefixMax) return value;
+
+        // Nothing legitimate needs more than a few continuation bytes, so longer integers are rejected before they overflow.
+        for (unsigned int shift = 0; shift <= 28; shift += 7)
+        {
+            if (input.empty()) return Error(ErrorProtocolError {});
+
+            const uint8_t byte = input[0];
+            input              = input.subspan(1);
+            value             += size_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+
+        return Error(ErrorProtocolError {});
+    }
+
+
+    /// Returns whether a field holds credentials, and so should never be indexed (RFC 7541 section 7.1.3).
+    static bool IsSensitive(std::string_view name)
+    {
+        return name == "authorization" || name == "proxy-authorization" || name == "cookie" || name == "set-cookie";
+    }
+
+
+    DynamicTable::DynamicTable(size_t maxSize)
+        : mMaxSize(maxSize) {}
+
+
+    void DynamicTable::Add(std::string name, std::string value)
+    {
+        const size_t size = name.size() + value.size() + ENTRY_OVERHEAD;
+
+        // An entry larger than the whole table just empties it (RFC 7541 section 4.4).
+        if (size > mMaxSize)
+        {
+            mEntries.clear();
+            mSize = 0;
+            return;
+        }
+
+        mEntries.push_front(HeaderField {std::move(name), std::move(value)});
+        mSize += size;
+        Evict();
+    }
+
+
+    void DynamicTable::SetMaxSize(size_t maxSize)
+    {
+        mMaxSize = maxSize;
+        Evict();
+    }
+
+
+    size_t DynamicTable::GetMaxSize() const
+    {
+        return mMaxSize;
+    }
+
+
+    size_t DynamicTable::GetCount() const
+    {
+        return mEntries.size();
+    }
+
+
+    const HeaderField& DynamicTable::Get(size_t position) const
+    {
+        Core::Assert(position < mEntries.size());
+        return mEntries[position];
+    }
+
+
+    Core::Optional<size_t> DynamicTable::Find(std::string_view name, std::string_view value, bool& valueMatches) const
+    {
+        Core::Optional<size_t> nameMatch;
+        for (size_t i = 0; i < mEntries.size(); i++)
+        {
+            if (mEntries[i].name != name) continue;
+            if (mEntries[i].value == value)
+            {
+                valueMatches = true;
+                return i;
+            }
+            if (!nameMatch) nameMatch = i;
+        }
+
+        valueMatches = false;
+        return nameMatch;
+    }
+
+
+    void DynamicTable::Evict()
+    {
+        while (mSize > mMaxSize)
+        {
+            const auto& oldest = mEntries.back();
+            mSize -= oldest.name.size() + oldest.value.size() + ENTRY_OVERHEAD;
+            mEntries.pop_back();
+        }
+    }
+
+
+    Decoder::Decoder(size_t maxTableSize)
+        : mTable(maxTableSize)
+        , mMaxTableSize(maxTableSize) {}
+
+
+    Core::Result<std::vector<HeaderField>, Error> Decoder::Decode(std::span<const uint8_t> block)
+    {
+        std::vector<HeaderField> fields;
+
+        while (!block.empty())
+        {
+            const uint8_t first = block[0];
+
+            if (first & 0x80)
+            {
+                // Indexed field (RFC 7541 section 6.1).
+                auto index = DecodeInteger(block, 7);
+                if (!index) return index.Err();
+                auto field = Lookup(*index);
+                if (!field) return field.Err();
+                fields.push_back(field.Unwrap());
+                continue;
+            }
+
+            if ((first & 0xE0) == 0x20)
+            {
+                // Table size updates have to come before any fields (RFC 7541 section 4.2).
+                auto size = DecodeInteger(block, 5);
+                if (!size) return size.Err();
+                if (!fields.empty() || *size > mMaxTableSize) return Error(ErrorProtocolError {});
+                mTable.SetMaxSize(*size);
+                continue;
+            }
+
+            // Literal fields are added to the table, not added, or never added by anyone (RFC 7541 section 6.2).
+            const bool   indexed    = first & 0x40;
+            const auto   prefixBits = indexed ? 6u : 4u;
+            auto         nameIndex  = DecodeInteger(block, prefixBits);
+            if (!nameIndex) return nameIndex.Err();
+
+            HeaderField field;
+            if (*nameIndex > 0)
+            {
+                auto named = Lookup(*nameIndex);
+                if (!named) return named.Err();
+                field.name = std::move(named->name);
+            }
+            else
+            {
+                auto name = DecodeString(block);
+                if (!name) return name.Err();
+                field.name = name.Unwrap();
+            }
+
+            auto value = DecodeString(block);
+            if (!value) return value.Err();
+            field.value = value.Unwrap();
+
+            if (indexed) mTable.Add(field.name, field.value);
+            fields.push_back(std::move(field));
+        }
+
+        return fields;
+    }
+
+
+    Core::Result<std::string, Error> Decoder::DecodeString(std::span<const uint8_t>& block)
+    {
+        if (block.empty()) return Error(ErrorProtocolError {});
+
+        const bool huffman = block[0] & 0x80;
+        auto       length  = DecodeInteger(block, 7);
+        if (!length) return length.Err();
+        if (*length > block.size()) return Error(ErrorProtocolError {});
+
+        auto bytes = block.first(*length);
+        block      = block.subspan(*length);
+
+        if (huffman) return Huffman::Decode(bytes);
+        return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+
+    Core::Result<HeaderField, Error> Decoder::Lookup(size_t index) const
+    {
+        if (index == 0) return Error(ErrorProtocolError {});
+
+        if (index <= STATIC_TABLE_SIZE)
+        {
+            const auto& [name, value] = STATIC_TABLE[index - 1];
+            return HeaderField {std::string(name), std::string(value)};
+        }
+
+        if (index - STATIC_TABLE_SIZE - 1 >= mTable.GetCount()) return Error(ErrorProtocolError {});
+        return mTable.Get(index - STATIC_TABLE_SIZE - 1);
+    }
+
+
+    Encoder::Encoder(size_t maxTableSize)
+        : mTable(maxTableSize) {}
+
+
+    void Encoder::SetMaxTableSize(size_t maxSize)
+    {
+        mTable.SetMaxSize(maxSize);
+        mPendingTableSize = maxSize;
+    }
+
+
+    void Encoder::Encode(std::span<const HeaderField> fields, std::vector<uint8_t>& block)
+    {
+        if (mPendingTableSize)
+        {
+            EncodeInteger(block, 0x20, 5, *mPendingTableSize);
+            mPendingTableSize.Reset();
+        }
+
+        for (const auto& [name, value] : fields)
+        {
+            const bool sensitive = IsSensitive(name);
+
+            // Look for the whole field, or failing that its name, in the static table and then the dynamic table.
+            size_t nameIndex = 0;
+            size_t index     = 0;
+            for (size_t i = 0; i < STATIC_TABLE_SIZE && index == 0; i++)
+            {
+                if (STATIC_TABLE[i].first != name) continue;
+                if (nameIndex == 0) nameIndex = i + 1;
+                if (STATIC_TABLE[i].second == value) index = i + 1;
+            }
+
+            bool valueMatches = false;
+            if (auto position = mTable.Find(name, value, valueMatches); position && index == 0)
+            {
+                if (valueMatches) index = STATIC_TABLE_SIZE + 1 + *position;
+                if (nameIndex == 0) nameIndex = STATIC_TABLE_SIZE + 1 + *position;
+            }
+
+            if (index > 0 && !sensitive)
+            {
+                EncodeInteger(block, 0x80, 7, index);
+                continue;
+            }
+
+            if (sensitive)
+            {
+                EncodeInteger(block, 0x10, 4, nameIndex);
+            }
+            else
+            {
+                EncodeInteger(block, 0x40, 6, nameIndex);
+            }
+
+            if (nameIndex == 0) EncodeString(name, block);
+            EncodeString(value, block);
+
+            if (!sensitive) mTable.Add(name, value);
+        }
+    }
+
+
+    void Encoder::EncodeString(std::string_view string, std::vector<uint8_t>& block)
+    {
+        // Huffman coding is only used when it makes the string shorter.
+        if (auto huffmanLength = Huffman::EncodedLength(string); huffmanLength < string.size())
+        {
+            EncodeInteger(block, 0x80, 7, huffmanLength);
+            Huffman::Encode(string, block);
+        }
+        else
+        {
+            EncodeInteger(block, 0x00, 7, string.size());
+            block.insert(block.end(), string.begin(), string.end());
+        }
+    }
+
+
+    namespace Huffman
+    {
+        struct Code
+        {
+            uint32_t bits;
+            uint8_t  length;
+        };
+
+
+        /// The code for each byte, followed by the end of string symbol.
+        static constexpr Code CODES[257] = {
+        {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28},
+        {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+        {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+        {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+        {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+        {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+        {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28},
+        {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+        {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+        {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11},
+        {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11},
+        {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+        {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6},
+        {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6},
+        {0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8},
+        {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10},
+        {0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7},
+        {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+        {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7},
+        {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7},
+        {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7},
+        {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7},
+        {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13},
+        {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+        {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5},
+        {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6},
+        {0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7},
+        {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5},
+        {0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5},
+        {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+        {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15},
+        {0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28},
+        {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+        {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23},
+        {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23},
+        {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+        {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23},
+        {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23},
+        {0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23},
+        {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+        {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22},
+        {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+        {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24},
+        {0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23},
+        {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21},
+        {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23},
+        {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22},
+        {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+        {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19},
+        {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25},
+        {0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27},
+        {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+        {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27},
+        {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+        {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26},
+        {0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27},
+        {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21},
+        {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23},
+        {0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25},
+        {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+        {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26},
+        {0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+        {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+        {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26},
+        {0x3fffffff, 30},
+        };
+        static constexpr uint16_t END_OF_STRING = 256;
+
+
+        /// The code as a binary tree, for decoding a bit at a time.
+        struct Tree
+        {
+            struct Node
+            {
+                std::array<int16_t, 2> children {-1, -1};
+                int16_t                symbol = -1;
+            };
+
+
+            Tree()
+            {
+                nodes.emplace_back();
+                for (uint16_t symbol = 0; symbol <= END_OF_STRING; symbol++)
+                {
+                    size_t node = 0;
+                    for (int bit = CODES[symbol].length - 1; bit >= 0; bit--)
+                    {
+                        auto direction = (CODES[symbol].bits >> bit) & 1;
+                        if (nodes[node].children[direction] < 0)
+                        {
+                            nodes[node].children[direction] = static_cast<int16_t>(nodes.size());
+                            nodes.emplace_back();
+                        }
+                        node = nodes[node].children[direction];
+                    }
+                    nodes[node].symbol = static_cast<int16_t>(symbol);
+                }
+            }
+
+
+            std::vector<Node> nodes;
+        };
+
+
+        size_t EncodedLength(std::string_view string)
+        {
+            size_t bits = 0;
+            for (unsigned char c : string) bits += CODES[c].length;
+            return (bits + 7) / 8;
+        }
+
+
+        void Encode(std::string_view string, std::vector<uint8_t>& output)
+        {
+            uint64_t buffer = 0;
+            unsigned bits   = 0;
+
+            for (unsigned char c : string)
+            {
+                buffer = (buffer << CODES[c].length) | CODES[c].bits;
+                bits  += CODES[c].length;
+                while (bits >= 8)
+                {
+                    bits -= 8;
+                    output.push_back(static_cast<uint8_t>(buffer >> bits));
+                }
+                buffer &= (uint64_t(1) << bits) - 1;
+            }
+
+            // The last byte is padded with the most significant bits of the end of string symbol, which are all ones.
+            if (bits > 0)
+            {
+                output.push_back(static_cast<uint8_t>((buffer << (8 - bits)) | ((1u << (8 - bits)) - 1)));
+            }
+        }
+
+
+        Core::Result<std::string, Error> Decode(std::span<const uint8_t> input)
+        {
+            static const Tree tree;
+
+            std::string output;
+            output.reserve(input.size() * 8 / 5);
+
+            size_t   node          = 0;
+            // Bits read since the last symbol, and whether they were all ones, to check the padding at the end.
+            unsigned pendingBits   = 0;
+            bool     pendingOnes   = true;
+
+            for (uint8_t byte : input)
+            {
+                for (int bit = 7; bit >= 0; bit--)
+                {
+                    auto direction = (byte >> bit) & 1;
+                    auto next      = tree.nodes[node].children[direction];
+                    if (next < 0) return Error(ErrorProtocolError {});
+
+                    node = next;
+                    pendingBits++;
+                    pendingOnes &= direction == 1;
+
+                    if (auto symbol = tree.nodes[node].symbol; symbol >= 0)
+                    {
+                        // The end of string symbol must never be sent (RFC 7541 section 5.2).
+                        if (symbol == END_OF_STRING) return Error(ErrorProtocolError {});
+                        output.push_back(static_cast<char>(symbol));
+                        node        = 0;
+                        pendingBits = 0;
+                        pendingOnes = true;
+                    }
+                }
+            }
+
+            // Padding is shorter than a byte, and made of ones.
+            if (pendingBits > 7 || !pendingOnes) return Error(ErrorProtocolError {});
+            return output;
+        }
+    } // namespace Huffman
+} // namespace Strawberry::Net::HTTP::HPACK
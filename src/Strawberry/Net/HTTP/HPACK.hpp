@@ -0,0 +1,114 @@
+#pragma once
+
+
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// HPACK header compression for HTTP/2 (RFC 7541).
+namespace Strawberry::Net::HTTP::HPACK
+{
+    /// The table size which both ends start with, before SETTINGS_HEADER_TABLE_SIZE changes it.
+    static constexpr size_t DEFAULT_TABLE_SIZE = 4096;
+
+
+    /// A header field. Names are lowercase in HTTP/2.
+    struct HeaderField
+    {
+        std::string name;
+        std::string value;
+    };
+
+
+    /// The table of recently sent header fields, which each end keeps in step with the other (RFC 7541 section 2.3.2).
+    class DynamicTable
+    {
+        public:
+            explicit DynamicTable(size_t maxSize);
+
+
+            /// Adds a field as the newest entry, evicting the oldest ones to make room.
+            void                             Add(std::string name, std::string value);
+            /// Changes the maximum size, evicting entries which no longer fit.
+            void                             SetMaxSize(size_t maxSize);
+            [[nodiscard]] size_t             GetMaxSize() const;
+            [[nodiscard]] size_t             GetCount() const;
+            /// Returns an entry by its position, counting from the newest.
+            [[nodiscard]] const HeaderField& Get(size_t position) const;
+            /// Finds the position of an entry with the given name, preferring one with the given value too.
+            [[nodiscard]] Core::Optional<size_t> Find(std::string_view name, std::string_view value, bool& valueMatches) const;
+
+        private:
+            void Evict();
+
+
+            /// Entries, newest first.
+            std::deque<HeaderField> mEntries;
+            /// The size of all entries, counting 32 bytes of overhead for each (RFC 7541 section 4.1).
+            size_t                  mSize = 0;
+            size_t                  mMaxSize;
+    };
+
+
+    /// Decodes the header blocks received on one connection.
+    class Decoder
+    {
+        public:
+            /// maxTableSize is the limit advertised to the peer with SETTINGS_HEADER_TABLE_SIZE.
+            explicit Decoder(size_t maxTableSize = DEFAULT_TABLE_SIZE);
+
+
+            /// Decodes a complete header block. Blocks must be decoded in the order they were received,
+            /// and an error leaves the table out of step with the peer's, which is fatal to the connection.
+            Core::Result<std::vector<HeaderField>, Error> Decode(std::span<const uint8_t> block);
+
+        private:
+            Core::Result<std::string, Error> DecodeString(std::span<const uint8_t>& block);
+            /// Looks up a field by its index into the static table followed by the dynamic table.
+            Core::Result<HeaderField, Error> Lookup(size_t index) const;
+
+
+            DynamicTable mTable;
+            size_t       mMaxTableSize;
+    };
+
+
+    /// Encodes the header blocks sent on one connection.
+    class Encoder
+    {
+        public:
+            explicit Encoder(size_t maxTableSize = DEFAULT_TABLE_SIZE);
+
+
+            /// Changes the table size, when the peer's SETTINGS_HEADER_TABLE_SIZE changes.
+            /// The change is signalled at the start of the next header block.
+            void SetMaxTableSize(size_t maxSize);
+            /// Encodes a complete header block. Fields which hold credentials are never indexed,
+            /// so that intermediaries won't index them either.
+            void Encode(std::span<const HeaderField> fields, std::vector<uint8_t>& block);
+
+        private:
+            void EncodeString(std::string_view string, std::vector<uint8_t>& block);
+
+
+            DynamicTable           mTable;
+            Core::Optional<size_t> mPendingTableSize;
+    };
+
+
+    /// The static Huffman code for string literals (RFC 7541 appendix B).
+    namespace Huffman
+    {
+        [[nodiscard]] size_t             EncodedLength(std::string_view string);
+        void                             Encode(std::string_view string, std::vector<uint8_t>& output);
+        Core::Result<std::string, Error> Decode(std::span<const uint8_t> input);
+    } // namespace Huffman
+} // namespace Strawberry::Net::HTTP::HPACK
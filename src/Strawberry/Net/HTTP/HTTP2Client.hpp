@@ -0,0 +1,198 @@
+#pragma once
+
+
+#include "HPACK.hpp"
+#include "Request.hpp"
+#include "Response.hpp"
+#include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Net/Socket/BufferedSocket.hpp"
+#include "Strawberry/Net/Socket/TCPSocket.hpp"
+#include "Strawberry/Net/Socket/TLSSocket.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+// Standard Library
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+
+namespace Strawberry::Net::HTTP
+{
+	/// Settings which each end of an HTTP/2 connection declares to the other (RFC 9113 section 6.5.2).
+	struct HTTP2Settings
+	{
+		uint32_t headerTableSize      = HPACK::DEFAULT_TABLE_SIZE;
+		uint32_t maxConcurrentStreams = UINT32_MAX;
+		uint32_t initialWindowSize    = 65535;
+		uint32_t maxFrameSize         = 16384;
+	};
+
+
+	/// An HTTP/2 connection, over TLS when negotiated with ALPN, or over TCP with prior knowledge that the server speaks HTTP/2.
+	///
+	/// Requests are multiplexed as streams on the one connection: any number can be sent before their responses are received,
+	/// and the responses can be received in any order. The client isn't thread safe, so streams are driven from one thread.
+	/// Server push is disabled.
+	template<typename S>
+	class HTTP2ClientBase
+	{
+	public:
+		using StreamID = uint32_t;
+
+
+		static constexpr size_t   SOCKET_BUFFER_SIZE     = 1024 * 1024 * 1;
+		/// The flow control window for each response body, which is replenished as the body is received.
+		static constexpr uint32_t STREAM_WINDOW_SIZE     = 1024 * 1024 * 1;
+		/// The flow control window for all response bodies together.
+		static constexpr uint32_t CONNECTION_WINDOW_SIZE = 1024 * 1024 * 16;
+		/// The largest header block which is accepted, across a HEADERS frame and its CONTINUATION frames.
+		static constexpr size_t   MAX_HEADER_BLOCK_SIZE  = 256 * 1024;
+
+	public:
+		/// Connects to the endpoint, negotiating HTTP/2 with ALPN over TLS, or assuming it over TCP.
+		/// Returns ErrorNotSupported if a TLS server doesn't agree to HTTP/2.
+		static Core::Result<HTTP2ClientBase, Error> Connect(const Endpoint& endpoint);
+		/// Starts HTTP/2 over an already connected socket, whose TLS handshake has agreed to "h2" if it has one.
+		/// The authority is sent with requests which don't have a Host header.
+		static Core::Result<HTTP2ClientBase, Error> Start(Socket::BufferedSocket<S> socket, std::string authority);
+
+
+		/// Sends a request on a new stream, returning the stream to receive its response from.
+		/// Connection-specific header fields, such as Connection and Transfer-Encoding, are left out.
+		/// Waits while the server's limit on concurrent streams is reached, or while its flow control window is full.
+		Core::Result<StreamID, Error> SendRequest(const Request& request);
+		/// Waits for the whole response on a stream, handling frames for other streams as they arrive.
+		/// Each stream's response can only be received once.
+		Core::Result<Response, Error> Receive(StreamID stream);
+
+
+		/// Returns whether new requests can be sent, which they can't once the server has sent GOAWAY, or after a connection error.
+		[[nodiscard]] bool IsOpen() const
+		{
+			return !mGoAwayStream && !mConnectionError;
+		}
+
+	private:
+		enum class FrameType : uint8_t
+		{
+			DATA          = 0x0,
+			HEADERS       = 0x1,
+			PRIORITY      = 0x2,
+			RST_STREAM    = 0x3,
+			SETTINGS      = 0x4,
+			PUSH_PROMISE  = 0x5,
+			PING          = 0x6,
+			GOAWAY        = 0x7,
+			WINDOW_UPDATE = 0x8,
+			CONTINUATION  = 0x9,
+		};
+
+
+		/// Error codes sent in RST_STREAM and GOAWAY frames (RFC 9113 section 7).
+		enum class ErrorCode : uint32_t
+		{
+			NO_ERROR           = 0x0,
+			PROTOCOL_ERROR     = 0x1,
+			FLOW_CONTROL_ERROR = 0x3,
+			FRAME_SIZE_ERROR   = 0x6,
+			REFUSED_STREAM     = 0x7,
+			COMPRESSION_ERROR  = 0x9,
+		};
+
+
+		static constexpr size_t  FRAME_HEADER_SIZE = 9;
+		static constexpr uint8_t FLAG_ACK          = 0x01;
+		static constexpr uint8_t FLAG_END_STREAM   = 0x01;
+		static constexpr uint8_t FLAG_END_HEADERS  = 0x04;
+		static constexpr uint8_t FLAG_PADDED       = 0x08;
+		static constexpr uint8_t FLAG_PRIORITY     = 0x20;
+		/// The largest flow control window allowed.
+		static constexpr int64_t MAX_WINDOW_SIZE   = 0x7FFFFFFF;
+
+
+		struct Stream
+		{
+			/// The response, once its header block has been received.
+			Core::Optional<Response>    response;
+			Core::IO::DynamicByteBuffer body;
+			/// How much request body may be sent on the stream before the server grants more.
+			int64_t                     sendWindow     = 0;
+			/// Bytes of response body received since the stream's window was last replenished.
+			uint32_t                    unacknowledged = 0;
+			/// Whether the server has ended the stream.
+			bool                        complete       = false;
+			/// Why the stream failed, if it did.
+			Core::Optional<Error>       error;
+		};
+
+
+		HTTP2ClientBase(Socket::BufferedSocket<S> socket, std::string scheme, std::string authority);
+
+
+		/// Reads a 32 bit integer in network byte order.
+		static uint32_t ReadUInt32(const uint8_t* bytes);
+		/// Appends a 32 bit integer in network byte order.
+		static void     PushUInt32(std::vector<uint8_t>& bytes, uint32_t value);
+		/// Appends a frame header and its payload.
+		static void     AppendFrame(Core::IO::DynamicByteBuffer& bytes, FrameType type, uint8_t flags, StreamID stream, std::span<const uint8_t> payload);
+
+
+		/// Sends a frame with the given payload, in a single write.
+		Core::Result<void, Error> WriteFrame(FrameType type, uint8_t flags, StreamID stream, std::span<const uint8_t> payload);
+		/// Sends a request body as DATA frames, as the flow control windows allow.
+		Core::Result<void, Error> SendData(StreamID stream, std::span<const uint8_t> data);
+		/// Receives and handles the next frame.
+		Core::Result<void, Error> ReceiveFrame();
+		Core::Result<void, Error> HandleFrame(FrameType type, uint8_t flags, StreamID stream, std::span<const uint8_t> payload);
+		Core::Result<void, Error> HandleData(uint8_t flags, StreamID stream, std::span<const uint8_t> payload);
+		Core::Result<void, Error> HandleHeaderBlock(StreamID stream, std::span<const uint8_t> block, bool endStream);
+		Core::Result<void, Error> HandleSettings(uint8_t flags, std::span<const uint8_t> payload);
+		Core::Result<void, Error> HandleWindowUpdate(StreamID stream, std::span<const uint8_t> payload);
+		/// Sends a WINDOW_UPDATE once half of a window has been used.
+		Core::Result<void, Error> Replenish(StreamID stream, uint32_t& unacknowledged, uint32_t windowSize);
+		/// Fails one stream, telling the server why with RST_STREAM.
+		Core::Result<void, Error> ResetStream(StreamID id, Stream& stream, ErrorCode code);
+		/// Fails the whole connection, telling the server why with GOAWAY.
+		Error                     FailConnection(ErrorCode code);
+		/// Records an error which leaves the connection unusable, and fails every stream which hasn't ended.
+		Error                     Fail(Error error);
+
+
+		Socket::BufferedSocket<S>  mSocket;
+		std::string                mScheme;
+		std::string                mAuthority;
+		HPACK::Encoder             mEncoder;
+		HPACK::Decoder             mDecoder;
+		HTTP2Settings              mPeerSettings;
+		bool                       mReceivedSettings = false;
+
+		std::map<StreamID, Stream> mStreams;
+		/// Client streams have odd numbers, which only ever go up.
+		StreamID                   mNextStream = 1;
+		/// How much request body may be sent on the whole connection before the server grants more.
+		int64_t                    mSendWindow = 65535;
+		/// Bytes of response body received on the connection since its window was last replenished.
+		uint32_t                   mUnacknowledged = 0;
+
+		/// A header block which is still being received in CONTINUATION frames, and its stream.
+		std::vector<uint8_t>       mHeaderBlock;
+		StreamID                   mHeaderStream    = 0;
+		bool                       mHeaderEndStream = false;
+
+		/// The last stream which the server will process, once it has sent GOAWAY.
+		Core::Optional<StreamID>   mGoAwayStream;
+		Core::Optional<Error>      mConnectionError;
+	};
+
+
+	/// HTTP/2 over TLS.
+	using HTTP2Client          = HTTP2ClientBase<Socket::TLSSocket>;
+	/// HTTP/2 over TCP, for servers known to speak it without negotiation.
+	using HTTP2CleartextClient = HTTP2ClientBase<Socket::TCPSocket>;
+} // namespace Strawberry::Net::HTTP
+
+
+#include "HTTP2Client.inl"
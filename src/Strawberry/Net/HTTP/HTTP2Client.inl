@@ -0,0 +1,773 @@
+#pragma once
+
+#include "Strawberry/Net/HTTP/HTTP2Client.hpp"
+// Strawberry Core
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/Logging.hpp"
+// Standard Library
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <concepts>
+#include <string_view>
+#include <utility>
+
+
+namespace Strawberry::Net::HTTP
+{
+	template<typename S>
+	Core::Result<HTTP2ClientBase<S>, Error> HTTP2ClientBase<S>::Connect(const Endpoint& endpoint)
+	{
+		if constexpr (std::same_as<S, Socket::TLSSocket>)
+		{
+			static const auto context = []
+			{
+				Socket::TLSContextOptions options;
+				options.alpnProtocols = {"h2"};
+				return Socket::TLSContext::Create(options);
+			}();
+			if (!context)
+			{
+				return context.Err();
+			}
+
+			auto socket = Socket::TLSSocket::Connect(endpoint, *context);
+			if (!socket)
+			{
+				return socket.Err();
+			}
+
+			// Servers which don't speak HTTP/2 pick another protocol, or none at all.
+			if (auto protocol = socket->GetALPNProtocol(); !protocol || *protocol != "h2")
+			{
+				Core::Logging::Error("{} did not agree to HTTP/2.", endpoint.ToString());
+				return Error(ErrorNotSupported {});
+			}
+
+			return Start(Socket::BufferedSocket(socket.Unwrap(), SOCKET_BUFFER_SIZE), endpoint.ToString());
+		}
+		else
+		{
+			auto socket = S::Connect(endpoint);
+			if (!socket)
+			{
+				return socket.Err();
+			}
+
+			return Start(Socket::BufferedSocket(socket.Unwrap(), SOCKET_BUFFER_SIZE), endpoint.ToString());
+		}
+	}
+
+
+	template<typename S>
+	Core::Result<HTTP2ClientBase<S>, Error> HTTP2ClientBase<S>::Start(Socket::BufferedSocket<S> socket, std::string authority)
+	{
+		static constexpr std::string_view PREFACE = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+		HTTP2ClientBase client(std::move(socket), std::same_as<S, Socket::TLSSocket> ? "https" : "http", std::move(authority));
+
+		// The preface is followed by our settings, and the connection window is opened up beyond its default.
+		Core::IO::DynamicByteBuffer bytes;
+		bytes.Push(reinterpret_cast<const uint8_t*>(PREFACE.data()), PREFACE.size());
+
+		std::vector<uint8_t> settings;
+		// SETTINGS_ENABLE_PUSH
+		settings.insert(settings.end(), {0x00, 0x02});
+		PushUInt32(settings, 0);
+		// SETTINGS_INITIAL_WINDOW_SIZE
+		settings.insert(settings.end(), {0x00, 0x04});
+		PushUInt32(settings, STREAM_WINDOW_SIZE);
+		AppendFrame(bytes, FrameType::SETTINGS, 0, 0, settings);
+
+		std::vector<uint8_t> increment;
+		PushUInt32(increment, CONNECTION_WINDOW_SIZE - HTTP2Settings {}.initialWindowSize);
+		AppendFrame(bytes, FrameType::WINDOW_UPDATE, 0, 0, increment);
+
+		if (auto writeResult = client.mSocket.Write(bytes); !writeResult)
+		{
+			return writeResult.Err();
+		}
+
+		return client;
+	}
+
+
+	template<typename S>
+	HTTP2ClientBase<S>::HTTP2ClientBase(Socket::BufferedSocket<S> socket, std::string scheme, std::string authority)
+		: mSocket(std::move(socket))
+		, mScheme(std::move(scheme))
+		, mAuthority(std::move(authority)) {}
+
+
+	template<typename S>
+	Core::Result<typename HTTP2ClientBase<S>::StreamID, Error> HTTP2ClientBase<S>::SendRequest(const Request& request)
+	{
+		if (mConnectionError)
+		{
+			return *mConnectionError;
+		}
+
+		if (mGoAwayStream)
+		{
+			return Error(ErrorConnectionReset {});
+		}
+
+		// Wait for streams to end while the server's limit on open streams is reached.
+		while (std::ranges::count_if(mStreams, [](const auto& entry) { return !entry.second.complete && !entry.second.error; })
+			>= static_cast<ptrdiff_t>(mPeerSettings.maxConcurrentStreams))
+		{
+			if (auto receiveResult = ReceiveFrame(); !receiveResult)
+			{
+				return receiveResult.Err();
+			}
+		}
+
+		const auto& header  = request.GetHeader();
+		const auto& payload = request.GetPayload();
+		const auto  host    = header.Find(HeaderName::HOST);
+
+		std::vector<HPACK::HeaderField> fields {
+			{":method", std::string(request.GetVerb().ToString())},
+			{":scheme", mScheme},
+			{":authority", host ? std::string(*host) : mAuthority},
+			{":path", std::string(request.GetURI())},
+		};
+
+		for (const auto& field : header)
+		{
+			// Fields which only describe an HTTP/1.1 connection are malformed in HTTP/2 (RFC 9113 section 8.2.2).
+			if (field.wellKnown)
+			{
+				switch (*field.wellKnown)
+				{
+					case HeaderName::CONNECTION:
+					case HeaderName::KEEP_ALIVE:
+					case HeaderName::PROXY_CONNECTION:
+					case HeaderName::TRANSFER_ENCODING:
+					case HeaderName::UPGRADE:
+					case HeaderName::HOST:
+						continue;
+					case HeaderName::TE:
+						if (field.value != "trailers") continue;
+						break;
+					default:
+						break;
+				}
+			}
+
+			std::string name(field.name);
+			std::ranges::transform(name, name.begin(), [](unsigned char c) { return std::tolower(c); });
+			fields.push_back({std::move(name), std::string(field.value)});
+		}
+
+		if (payload.Size() > 0 && !header.Contains(HeaderName::CONTENT_LENGTH))
+		{
+			fields.push_back({"content-length", std::to_string(payload.Size())});
+		}
+
+		std::vector<uint8_t> block;
+		mEncoder.Encode(fields, block);
+
+		const StreamID id = mNextStream;
+		mNextStream += 2;
+
+		Stream stream;
+		stream.sendWindow = mPeerSettings.initialWindowSize;
+		mStreams.emplace(id, std::move(stream));
+
+		// Blocks too big for one frame carry on in CONTINUATION frames, which have to follow straight after.
+		const bool                  hasBody = payload.Size() > 0;
+		Core::IO::DynamicByteBuffer frames  = Core::IO::DynamicByteBuffer::WithCapacity(block.size() + FRAME_HEADER_SIZE);
+		size_t                      offset  = 0;
+		do
+		{
+			const size_t  count = std::min<size_t>(block.size() - offset, mPeerSettings.maxFrameSize);
+			const bool    first = offset == 0;
+			const uint8_t flags = (offset + count == block.size() ? FLAG_END_HEADERS : 0) | (first && !hasBody ? FLAG_END_STREAM : 0);
+			AppendFrame(frames, first ? FrameType::HEADERS : FrameType::CONTINUATION, flags, id, std::span(block).subspan(offset, count));
+			offset += count;
+		}
+		while (offset < block.size());
+
+		if (auto writeResult = mSocket.Write(frames); !writeResult)
+		{
+			return Fail(writeResult.Err());
+		}
+
+		if (hasBody)
+		{
+			if (auto sendResult = SendData(id, {payload.Data(), payload.Size()}); !sendResult)
+			{
+				return sendResult.Err();
+			}
+		}
+
+		return id;
+	}
+
+
+	template<typename S>
+	Core::Result<Response, Error> HTTP2ClientBase<S>::Receive(StreamID id)
+	{
+		auto it = mStreams.find(id);
+		Core::Assert(it != mStreams.end());
+
+		while (!it->second.complete && !it->second.error)
+		{
+			if (auto receiveResult = ReceiveFrame(); !receiveResult)
+			{
+				mStreams.erase(it);
+				return receiveResult.Err();
+			}
+		}
+
+		auto stream = std::move(it->second);
+		mStreams.erase(it);
+
+		if (stream.error)
+		{
+			return *stream.error;
+		}
+
+		Response response = std::move(*stream.response);
+		response.SetPayload(std::move(stream.body));
+		return response;
+	}
+
+
+	template<typename S>
+	uint32_t HTTP2ClientBase<S>::ReadUInt32(const uint8_t* bytes)
+	{
+		return uint32_t(bytes[0]) << 24 | uint32_t(bytes[1]) << 16 | uint32_t(bytes[2]) << 8 | uint32_t(bytes[3]);
+	}
+
+
+	template<typename S>
+	void HTTP2ClientBase<S>::PushUInt32(std::vector<uint8_t>& bytes, uint32_t value)
+	{
+		bytes.insert(bytes.end(), {uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value)});
+	}
+
+
+	template<typename S>
+	void HTTP2ClientBase<S>::AppendFrame(Core::IO::DynamicByteBuffer& bytes, FrameType type, uint8_t flags, StreamID stream, std::span<const uint8_t> payload)
+	{
+		const uint8_t header[FRAME_HEADER_SIZE] = {
+			uint8_t(payload.size() >> 16), uint8_t(payload.size() >> 8), uint8_t(payload.size()),
+			uint8_t(type),
+			flags,
+			uint8_t(stream >> 24), uint8_t(stream >> 16), uint8_t(stream >> 8), uint8_t(stream)
+		};
+
+		bytes.Push(header, FRAME_HEADER_SIZE);
+		if (!payload.empty())
+		{
+			bytes.Push(payload.data(), payload.size());
+		}
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::WriteFrame(FrameType type, uint8_t flags, StreamID stream, std::span<const uint8_t> payload)
+	{
+		auto bytes = Core::IO::DynamicByteBuffer::WithCapacity(FRAME_HEADER_SIZE + payload.size());
+		AppendFrame(bytes, type, flags, stream, payload);
+
+		if (auto writeResult = mSocket.Write(bytes); !writeResult)
+		{
+			return Fail(writeResult.Err());
+		}
+
+		return Core::Success;
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::SendData(StreamID id, std::span<const uint8_t> data)
+	{
+		size_t offset = 0;
+		while (offset < data.size())
+		{
+			auto& stream = mStreams.at(id);
+			if (stream.error)
+			{
+				return *stream.error;
+			}
+
+			// Wait for the server to grant more room when either window is used up.
+			const int64_t window = std::min(mSendWindow, stream.sendWindow);
+			if (window <= 0)
+			{
+				if (auto receiveResult = ReceiveFrame(); !receiveResult)
+				{
+					return receiveResult.Err();
+				}
+				continue;
+			}
+
+			const size_t count = std::min<size_t>({data.size() - offset, static_cast<size_t>(window), mPeerSettings.maxFrameSize});
+			const bool   last  = offset + count == data.size();
+			if (auto writeResult = WriteFrame(FrameType::DATA, last ? FLAG_END_STREAM : 0, id, data.subspan(offset, count)); !writeResult)
+			{
+				return writeResult.Err();
+			}
+
+			mSendWindow       -= static_cast<int64_t>(count);
+			stream.sendWindow -= static_cast<int64_t>(count);
+			offset            += count;
+		}
+
+		return Core::Success;
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::ReceiveFrame()
+	{
+		if (mConnectionError)
+		{
+			return *mConnectionError;
+		}
+
+		while (mSocket.GetBufferedSize() < FRAME_HEADER_SIZE)
+		{
+			if (auto fillResult = mSocket.Fill(); !fillResult)
+			{
+				return Fail(fillResult.Err());
+			}
+		}
+
+		const auto     header = mSocket.Peek();
+		const uint32_t length = uint32_t(header[0]) << 16 | uint32_t(header[1]) << 8 | uint32_t(header[2]);
+		const auto     type   = static_cast<FrameType>(header[3]);
+		const uint8_t  flags  = header[4];
+		const StreamID stream = ReadUInt32(&header[5]) & 0x7FFFFFFF;
+
+		// We never raise SETTINGS_MAX_FRAME_SIZE, so every frame fits in the socket's buffer.
+		if (length > HTTP2Settings {}.maxFrameSize)
+		{
+			return FailConnection(ErrorCode::FRAME_SIZE_ERROR);
+		}
+
+		while (mSocket.GetBufferedSize() < FRAME_HEADER_SIZE + length)
+		{
+			if (auto fillResult = mSocket.Fill(); !fillResult)
+			{
+				return Fail(fillResult.Err());
+			}
+		}
+
+		// The payload is handled in place, and only consumed afterwards.
+		auto result = HandleFrame(type, flags, stream, mSocket.Peek().subspan(FRAME_HEADER_SIZE, length));
+		mSocket.Consume(FRAME_HEADER_SIZE + length);
+		return result;
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::HandleFrame(FrameType type, uint8_t flags, StreamID stream, std::span<const uint8_t> payload)
+	{
+		// A header block can't be interrupted by any other frame (RFC 9113 section 6.10),
+		// and the server's preface has to start with its settings (RFC 9113 section 3.4).
+		if ((mHeaderStream != 0 && (type != FrameType::CONTINUATION || stream != mHeaderStream))
+			|| (!mReceivedSettings && type != FrameType::SETTINGS))
+		{
+			return FailConnection(ErrorCode::PROTOCOL_ERROR);
+		}
+
+		switch (type)
+		{
+			case FrameType::DATA:
+			{
+				if (stream == 0) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+				return HandleData(flags, stream, payload);
+			}
+
+			case FrameType::HEADERS:
+			{
+				if (stream == 0) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+
+				size_t offset  = 0;
+				size_t padding = 0;
+				if (flags & FLAG_PADDED)
+				{
+					if (payload.empty()) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+					padding = payload[0];
+					offset  = 1;
+				}
+				if (flags & FLAG_PRIORITY)
+				{
+					offset += 5;
+				}
+				if (offset + padding > payload.size())
+				{
+					return FailConnection(ErrorCode::PROTOCOL_ERROR);
+				}
+
+				auto fragment = payload.subspan(offset, payload.size() - offset - padding);
+				if (flags & FLAG_END_HEADERS)
+				{
+					return HandleHeaderBlock(stream, fragment, flags & FLAG_END_STREAM);
+				}
+
+				mHeaderBlock.assign(fragment.begin(), fragment.end());
+				mHeaderStream    = stream;
+				mHeaderEndStream = flags & FLAG_END_STREAM;
+				return Core::Success;
+			}
+
+			case FrameType::CONTINUATION:
+			{
+				if (mHeaderStream == 0 || mHeaderBlock.size() + payload.size() > MAX_HEADER_BLOCK_SIZE)
+				{
+					return FailConnection(ErrorCode::PROTOCOL_ERROR);
+				}
+
+				mHeaderBlock.insert(mHeaderBlock.end(), payload.begin(), payload.end());
+				if (flags & FLAG_END_HEADERS)
+				{
+					auto block = std::move(mHeaderBlock);
+					mHeaderBlock.clear();
+					return HandleHeaderBlock(std::exchange(mHeaderStream, 0), block, mHeaderEndStream);
+				}
+				return Core::Success;
+			}
+
+			case FrameType::RST_STREAM:
+			{
+				if (stream == 0) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+				if (payload.size() != 4) return FailConnection(ErrorCode::FRAME_SIZE_ERROR);
+
+				if (auto it = mStreams.find(stream); it != mStreams.end() && !it->second.complete && !it->second.error)
+				{
+					// Refused streams weren't processed at all, so can safely be retried.
+					const bool refused = ReadUInt32(payload.data()) == static_cast<uint32_t>(ErrorCode::REFUSED_STREAM);
+					it->second.error   = refused ? Error(ErrorRefused {}) : Error(ErrorConnectionReset {});
+				}
+				return Core::Success;
+			}
+
+			case FrameType::SETTINGS:
+			{
+				if (stream != 0) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+				return HandleSettings(flags, payload);
+			}
+
+			case FrameType::PUSH_PROMISE:
+			{
+				// Push is disabled in our settings.
+				return FailConnection(ErrorCode::PROTOCOL_ERROR);
+			}
+
+			case FrameType::PING:
+			{
+				if (stream != 0) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+				if (payload.size() != 8) return FailConnection(ErrorCode::FRAME_SIZE_ERROR);
+				if (flags & FLAG_ACK) return Core::Success;
+				return WriteFrame(FrameType::PING, FLAG_ACK, 0, payload);
+			}
+
+			case FrameType::GOAWAY:
+			{
+				if (stream != 0) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+				if (payload.size() < 8) return FailConnection(ErrorCode::FRAME_SIZE_ERROR);
+
+				mGoAwayStream = ReadUInt32(payload.data()) & 0x7FFFFFFF;
+				if (auto code = ReadUInt32(payload.data() + 4); code != static_cast<uint32_t>(ErrorCode::NO_ERROR))
+				{
+					Core::Logging::Error("HTTP/2 server {} closed the connection with error {}.", mSocket.GetEndpoint().ToString(), code);
+				}
+
+				// Streams after the last one weren't processed, and will never get a response.
+				for (auto it = mStreams.upper_bound(*mGoAwayStream); it != mStreams.end(); ++it)
+				{
+					if (!it->second.complete && !it->second.error) it->second.error = Error(ErrorConnectionReset {});
+				}
+				return Core::Success;
+			}
+
+			case FrameType::WINDOW_UPDATE:
+			{
+				return HandleWindowUpdate(stream, payload);
+			}
+
+			default:
+			{
+				// PRIORITY frames are advisory, and unknown frame types must be ignored.
+				return Core::Success;
+			}
+		}
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::HandleData(uint8_t flags, StreamID id, std::span<const uint8_t> payload)
+	{
+		size_t offset  = 0;
+		size_t padding = 0;
+		if (flags & FLAG_PADDED)
+		{
+			if (payload.empty()) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+			padding = payload[0];
+			offset  = 1;
+		}
+		if (offset + padding > payload.size())
+		{
+			return FailConnection(ErrorCode::PROTOCOL_ERROR);
+		}
+
+		// Flow control counts the whole payload, padding included, even for streams which are no longer wanted.
+		mUnacknowledged += static_cast<uint32_t>(payload.size());
+		if (auto replenishResult = Replenish(0, mUnacknowledged, CONNECTION_WINDOW_SIZE); !replenishResult)
+		{
+			return replenishResult;
+		}
+
+		auto it = mStreams.find(id);
+		if (it == mStreams.end() || it->second.complete || it->second.error)
+		{
+			return Core::Success;
+		}
+
+		auto& stream = it->second;
+		if (!stream.response)
+		{
+			return ResetStream(id, stream, ErrorCode::PROTOCOL_ERROR);
+		}
+
+		auto data = payload.subspan(offset, payload.size() - offset - padding);
+		stream.body.Push(data.data(), data.size());
+
+		if (flags & FLAG_END_STREAM)
+		{
+			stream.complete = true;
+			return Core::Success;
+		}
+
+		stream.unacknowledged += static_cast<uint32_t>(payload.size());
+		return Replenish(id, stream.unacknowledged, STREAM_WINDOW_SIZE);
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::HandleHeaderBlock(StreamID id, std::span<const uint8_t> block, bool endStream)
+	{
+		// Every block is decoded, even for streams which are no longer wanted, to keep the table in step with the server's.
+		auto fields = mDecoder.Decode(block);
+		if (!fields)
+		{
+			return FailConnection(ErrorCode::COMPRESSION_ERROR);
+		}
+
+		auto it = mStreams.find(id);
+		if (it == mStreams.end() || it->second.complete || it->second.error)
+		{
+			return Core::Success;
+		}
+
+		auto& stream = it->second;
+		if (!stream.response)
+		{
+			Core::Optional<unsigned int> status;
+			for (const auto& field : *fields)
+			{
+				if (field.name != ":status") continue;
+
+				unsigned int value = 0;
+				auto [end, error] = std::from_chars(field.value.data(), field.value.data() + field.value.size(), value);
+				if (error == std::errc() && end == field.value.data() + field.value.size() && field.value.size() == 3)
+				{
+					status = value;
+				}
+			}
+
+			if (!status || *status < 100 || (*status < 200 && endStream))
+			{
+				return ResetStream(id, stream, ErrorCode::PROTOCOL_ERROR);
+			}
+
+			// Informational responses come before the final one, and are skipped.
+			if (*status < 200)
+			{
+				return Core::Success;
+			}
+
+			// HTTP/2 has no reason phrases.
+			stream.response.Emplace(Version::VERSION_2, *status, std::string_view());
+		}
+		else if (!endStream)
+		{
+			// Only trailers can follow the response's header block, and they end the stream.
+			return ResetStream(id, stream, ErrorCode::PROTOCOL_ERROR);
+		}
+
+		for (auto& field : *fields)
+		{
+			if (field.name.starts_with(':')) continue;
+			stream.response->GetHeader().Add(field.name, field.value);
+		}
+
+		stream.complete = endStream;
+		return Core::Success;
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::HandleSettings(uint8_t flags, std::span<const uint8_t> payload)
+	{
+		if (flags & FLAG_ACK)
+		{
+			if (!payload.empty()) return FailConnection(ErrorCode::FRAME_SIZE_ERROR);
+			return Core::Success;
+		}
+
+		if (payload.size() % 6 != 0)
+		{
+			return FailConnection(ErrorCode::FRAME_SIZE_ERROR);
+		}
+
+		for (size_t i = 0; i < payload.size(); i += 6)
+		{
+			const uint16_t identifier = uint16_t(payload[i]) << 8 | payload[i + 1];
+			const uint32_t value      = ReadUInt32(payload.data() + i + 2);
+
+			switch (identifier)
+			{
+				// SETTINGS_HEADER_TABLE_SIZE
+				case 0x1:
+				{
+					// The table is kept to the default size, even if the server would allow more.
+					const uint32_t size = std::min<uint32_t>(value, HPACK::DEFAULT_TABLE_SIZE);
+					if (size != mPeerSettings.headerTableSize)
+					{
+						mPeerSettings.headerTableSize = size;
+						mEncoder.SetMaxTableSize(size);
+					}
+					break;
+				}
+
+				// SETTINGS_MAX_CONCURRENT_STREAMS
+				case 0x3:
+					mPeerSettings.maxConcurrentStreams = value;
+					break;
+
+				// SETTINGS_INITIAL_WINDOW_SIZE
+				case 0x4:
+				{
+					if (value > MAX_WINDOW_SIZE) return FailConnection(ErrorCode::FLOW_CONTROL_ERROR);
+
+					// The change applies to streams which are already open too (RFC 9113 section 6.9.2).
+					const int64_t delta = static_cast<int64_t>(value) - mPeerSettings.initialWindowSize;
+					for (auto& [id, stream] : mStreams)
+					{
+						stream.sendWindow += delta;
+						if (stream.sendWindow > MAX_WINDOW_SIZE) return FailConnection(ErrorCode::FLOW_CONTROL_ERROR);
+					}
+					mPeerSettings.initialWindowSize = value;
+					break;
+				}
+
+				// SETTINGS_MAX_FRAME_SIZE
+				case 0x5:
+					if (value < 16384 || value > 16777215) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+					mPeerSettings.maxFrameSize = value;
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		mReceivedSettings = true;
+		return WriteFrame(FrameType::SETTINGS, FLAG_ACK, 0, {});
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::HandleWindowUpdate(StreamID id, std::span<const uint8_t> payload)
+	{
+		if (payload.size() != 4)
+		{
+			return FailConnection(ErrorCode::FRAME_SIZE_ERROR);
+		}
+
+		const uint32_t increment = ReadUInt32(payload.data()) & 0x7FFFFFFF;
+
+		if (id == 0)
+		{
+			mSendWindow += increment;
+			if (increment == 0) return FailConnection(ErrorCode::PROTOCOL_ERROR);
+			if (mSendWindow > MAX_WINDOW_SIZE) return FailConnection(ErrorCode::FLOW_CONTROL_ERROR);
+			return Core::Success;
+		}
+
+		auto it = mStreams.find(id);
+		if (it == mStreams.end() || it->second.error)
+		{
+			return Core::Success;
+		}
+
+		auto& stream = it->second;
+		stream.sendWindow += increment;
+		if (increment == 0) return ResetStream(id, stream, ErrorCode::PROTOCOL_ERROR);
+		if (stream.sendWindow > MAX_WINDOW_SIZE) return ResetStream(id, stream, ErrorCode::FLOW_CONTROL_ERROR);
+		return Core::Success;
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::Replenish(StreamID id, uint32_t& unacknowledged, uint32_t windowSize)
+	{
+		if (unacknowledged < windowSize / 2)
+		{
+			return Core::Success;
+		}
+
+		std::vector<uint8_t> increment;
+		PushUInt32(increment, std::exchange(unacknowledged, 0));
+		return WriteFrame(FrameType::WINDOW_UPDATE, 0, id, increment);
+	}
+
+
+	template<typename S>
+	Core::Result<void, Error> HTTP2ClientBase<S>::ResetStream(StreamID id, Stream& stream, ErrorCode code)
+	{
+		Core::Logging::Error("Resetting malformed HTTP/2 stream {} from {}.", id, mSocket.GetEndpoint().ToString());
+		stream.error = Error(ErrorProtocolError {});
+
+		std::vector<uint8_t> payload;
+		PushUInt32(payload, static_cast<uint32_t>(code));
+		return WriteFrame(FrameType::RST_STREAM, 0, id, payload);
+	}
+
+
+	template<typename S>
+	Error HTTP2ClientBase<S>::FailConnection(ErrorCode code)
+	{
+		Core::Logging::Error("Received malformed HTTP/2 frame from {}.", mSocket.GetEndpoint().ToString());
+
+		// We never accept streams from the server, so the last one processed is always 0.
+		std::vector<uint8_t> payload;
+		PushUInt32(payload, 0);
+		PushUInt32(payload, static_cast<uint32_t>(code));
+
+		// The connection is unusable either way, so failing to send GOAWAY changes nothing.
+		auto bytes = Core::IO::DynamicByteBuffer::WithCapacity(FRAME_HEADER_SIZE + payload.size());
+		AppendFrame(bytes, FrameType::GOAWAY, 0, 0, payload);
+		(void) mSocket.Write(bytes);
+
+		return Fail(ErrorProtocolError {});
+	}
+
+
+	template<typename S>
+	Error HTTP2ClientBase<S>::Fail(Error error)
+	{
+		mConnectionError = error;
+		for (auto& [id, stream] : mStreams)
+		{
+			if (!stream.complete && !stream.error) stream.error = error;
+		}
+		return error;
+	}
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,128 @@
+#include "Strawberry/Net/HTTP/HTTPAsyncClient.hpp"
+
+
+#include "Strawberry/Net/Socket/TCPSocket.hpp"
+#include "Strawberry/Net/Socket/TLSSocket.hpp"
+#include "Strawberry/Core/Assert.hpp"
+#include <iterator>
+#include <utility>
+
+
+namespace Strawberry::Net::HTTP
+{
+    HTTPAsyncClient::HTTPAsyncClient(HTTPAsyncClientOptions options)
+        : mOptions(std::move(options))
+        , mPool(mOptions.pool)
+    {
+        Core::Assert(mOptions.threads > 0);
+        Core::Assert(mOptions.pipelineDepth > 0);
+        Core::Assert(mOptions.pool.maxConnectionsPerHost > 0);
+
+        mThreads.reserve(mOptions.threads);
+        for (size_t i = 0; i < mOptions.threads; i++)
+        {
+            mThreads.emplace_back([this] { Run(); });
+        }
+    }
+
+
+    HTTPAsyncClient::~HTTPAsyncClient()
+    {
+        {
+            std::lock_guard lock(mMutex);
+            mStopping = true;
+        }
+        mWork.notify_all();
+
+        for (auto& thread : mThreads)
+        {
+            thread.join();
+        }
+    }
+
+
+    size_t HTTPAsyncClient::GetPendingCount() const
+    {
+        std::lock_guard lock(mMutex);
+        return mPending;
+    }
+
+
+    void HTTPAsyncClient::Wait()
+    {
+        std::unique_lock lock(mMutex);
+        mIdle.wait(lock, [this] { return mPending == 0; });
+    }
+
+
+    void HTTPAsyncClient::Run()
+    {
+        while (true)
+        {
+            std::vector<Job> batch;
+            {
+                std::unique_lock lock(mMutex);
+                while ((batch = TakeBatch()).empty())
+                {
+                    if (mStopping && mQueue.empty()) return;
+                    mWork.wait(lock);
+                }
+            }
+
+            const auto key = batch.front().key;
+            if (batch.front().secure)
+            {
+                Exchange<Socket::TLSSocket>(batch);
+            }
+            else
+            {
+                Exchange<Socket::TCPSocket>(batch);
+            }
+
+            bool idle;
+            {
+                std::lock_guard lock(mMutex);
+                if (--mActive[key] == 0) mActive.erase(key);
+                mPending -= batch.size();
+                idle = mPending == 0;
+            }
+
+            // Requests waiting for this host can go now, and everything may have stopped if this was the last.
+            mWork.notify_all();
+            if (idle) mIdle.notify_all();
+        }
+    }
+
+
+    std::vector<HTTPAsyncClient::Job> HTTPAsyncClient::TakeBatch()
+    {
+        std::vector<Job> batch;
+
+        auto first = mQueue.begin();
+        for (; first != mQueue.end(); ++first)
+        {
+            auto active = mActive.find(first->key);
+            if (active == mActive.end() || active->second < mOptions.pool.maxConnectionsPerHost) break;
+        }
+        if (first == mQueue.end()) return batch;
+
+        const auto key = first->key;
+        mActive[key]++;
+
+        // Gather the requests for the same host in the order they were queued, leaving the rest in place.
+        for (auto job = first; job != mQueue.end() && batch.size() < mOptions.pipelineDepth;)
+        {
+            if (job->key == key)
+            {
+                batch.push_back(std::move(*job));
+                job = mQueue.erase(job);
+            }
+            else
+            {
+                ++job;
+            }
+        }
+
+        return batch;
+    }
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,105 @@
+#pragma once
+
+
+#include "HTTPConnectionPool.hpp"
+#include "Request.hpp"
+#include "Response.hpp"
+#include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace Strawberry::Net::HTTP
+{
+    struct HTTPAsyncClientOptions
+    {
+        /// I/O threads to run. Each one carries one exchange at a time, so this is the most connections in use at once.
+        size_t                    threads       = 4;
+        /// The most requests sent back to back on one connection, when several are queued for the same host.
+        /// 1 sends them one at a time.
+        size_t                    pipelineDepth = 1;
+        /// How connections are kept, and the TLS context HTTPS ones are made with.
+        /// Its maxConnectionsPerHost is also the most exchanges with one host at once.
+        HTTPConnectionPoolOptions pool;
+    };
+
+
+    /// Sends HTTP/1.1 requests on a few I/O threads, returning futures for their responses.
+    ///
+    /// Requests are queued and answered in the order they were sent to each host. While a host has as many exchanges
+    /// in flight as it is allowed, requests to other hosts go ahead of its queued ones, so one slow host doesn't hold
+    /// up the rest. Connections come from an HTTPConnectionPool and are reused between requests.
+    ///
+    /// It may be used from several threads at once.
+    class HTTPAsyncClient
+    {
+        public:
+            using Future = std::future<Core::Result<Response, Error>>;
+
+
+            explicit HTTPAsyncClient(HTTPAsyncClientOptions options = {});
+            HTTPAsyncClient(const HTTPAsyncClient&)            = delete;
+            HTTPAsyncClient& operator=(const HTTPAsyncClient&) = delete;
+            /// Waits for every queued request to be answered.
+            ~HTTPAsyncClient();
+
+
+            /// Queues the request to the endpoint, over HTTP with a TCPSocket or HTTPS with a TLSSocket.
+            template<typename S>
+            Future Send(const Endpoint& endpoint, Request request);
+
+
+            /// Returns how many requests are queued or in flight.
+            [[nodiscard]] size_t GetPendingCount() const;
+            /// Waits until every request sent so far has been answered.
+            void                 Wait();
+
+        private:
+            struct Job
+            {
+                /// The scheme and endpoint, which requests are grouped and limited by.
+                std::string                                  key;
+                bool                                         secure;
+                Endpoint                                     endpoint;
+                Request                                      request;
+                std::promise<Core::Result<Response, Error>> promise;
+            };
+
+
+            /// Runs on each I/O thread, carrying out batches of requests until stopped with an empty queue.
+            void             Run();
+            /// Takes the oldest queued request whose host is below its limit, along with the requests queued behind
+            /// it for the same host, up to the pipeline depth. Must be called with the mutex held.
+            std::vector<Job> TakeBatch();
+            /// Sends a batch on one connection and fulfils its promises.
+            template<typename S>
+            void             Exchange(std::vector<Job>& batch);
+
+
+            const HTTPAsyncClientOptions mOptions;
+            HTTPConnectionPool           mPool;
+
+            mutable std::mutex              mMutex;
+            /// Notified when a request is queued, or a host has an exchange finish.
+            std::condition_variable         mWork;
+            /// Notified when the last pending request is answered.
+            std::condition_variable         mIdle;
+            std::deque<Job>                 mQueue;
+            /// Exchanges in flight for each host.
+            std::map<std::string, size_t>   mActive;
+            size_t                          mPending  = 0;
+            bool                            mStopping = false;
+            std::vector<std::thread>        mThreads;
+    };
+} // namespace Strawberry::Net::HTTP
+
+
+#include "HTTPAsyncClient.inl"
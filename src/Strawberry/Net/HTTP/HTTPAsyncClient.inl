@@ -0,0 +1,67 @@
+#pragma once
+
+
+#include "Strawberry/Net/HTTP/HTTPAsyncClient.hpp"
+#include "Strawberry/Net/Socket/TLSSocket.hpp"
+#include "Strawberry/Core/Assert.hpp"
+#include <concepts>
+#include <utility>
+
+
+namespace Strawberry::Net::HTTP
+{
+    template<typename S>
+    HTTPAsyncClient::Future HTTPAsyncClient::Send(const Endpoint& endpoint, Request request)
+    {
+        constexpr bool secure = std::same_as<S, Socket::TLSSocket>;
+
+        Job job {
+            .key      = (secure ? "https://" : "http://") + endpoint.ToString(),
+            .secure   = secure,
+            .endpoint = endpoint,
+            .request  = std::move(request),
+            .promise  = {},
+        };
+        auto future = job.promise.get_future();
+
+        {
+            std::lock_guard lock(mMutex);
+            Core::Assert(!mStopping);
+            mQueue.push_back(std::move(job));
+            mPending++;
+        }
+
+        mWork.notify_one();
+        return future;
+    }
+
+
+    template<typename S>
+    void HTTPAsyncClient::Exchange(std::vector<Job>& batch)
+    {
+        auto connection = mPool.Acquire<S>(batch.front().endpoint);
+        if (!connection)
+        {
+            for (auto& job : batch)
+            {
+                job.promise.set_value(connection.Err());
+            }
+            return;
+        }
+
+        std::vector<Request> requests;
+        requests.reserve(batch.size());
+        for (auto& job : batch)
+        {
+            requests.push_back(std::move(job.request));
+        }
+
+        // Pipeline() reconnects if the server closes a reused connection, and sends requests which aren't
+        // idempotent on their own, so it serves for single requests too.
+        auto responses = (*connection)->Pipeline(requests, mOptions.pipelineDepth);
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            batch[i].promise.set_value(std::move(responses[i]));
+        }
+    }
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,787 @@
+#include "Strawberry/Net/HTTP/HTTPCache.hpp"
+
+
+#include "Strawberry/Core/IO/Logging.hpp"
+#include "fmt/format.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <random>
+#include <string_view>
+#include <system_error>
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+namespace Strawberry::Net::HTTP
+{
+    namespace
+    {
+        using Clock = std::chrono::system_clock;
+
+
+        class MemoryBody final
+            : public CachedResponse::Body
+        {
+            public:
+                explicit MemoryBody(Core::IO::DynamicByteBuffer bytes)
+                    : mBytes(std::move(bytes)) {}
+
+
+                [[nodiscard]] std::span<const uint8_t> Bytes() const override
+                {
+                    return {mBytes.Data(), mBytes.Size()};
+                }
+
+            private:
+                Core::IO::DynamicByteBuffer mBytes;
+        };
+
+
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+        /// A body which was written to a file and mapped back in, so it only takes memory while it's being read.
+        class MappedBody final
+            : public CachedResponse::Body
+        {
+            public:
+                /// Writes the bytes to a new file and maps it. Returns null if that fails.
+                static std::shared_ptr<const MappedBody> Create(const std::filesystem::path& path, std::span<const uint8_t> bytes)
+                {
+                    int file = open(path.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+                    if (file < 0)
+                    {
+                        Core::Logging::Error("Could not create cache file {}: {}.", path.string(), std::strerror(errno));
+                        return nullptr;
+                    }
+
+                    size_t written = 0;
+                    while (written < bytes.size())
+                    {
+                        auto result = write(file, bytes.data() + written, bytes.size() - written);
+                        if (result < 0 && errno == EINTR) continue;
+                        if (result <= 0)
+                        {
+                            Core::Logging::Error("Could not write cache file {}: {}.", path.string(), std::strerror(errno));
+                            close(file);
+                            unlink(path.c_str());
+                            return nullptr;
+                        }
+                        written += static_cast<size_t>(result);
+                    }
+
+                    // The mapping keeps the file open, so the descriptor isn't needed any more.
+                    void* address = mmap(nullptr, bytes.size(), PROT_READ, MAP_SHARED, file, 0);
+                    close(file);
+                    if (address == MAP_FAILED)
+                    {
+                        Core::Logging::Error("Could not map cache file {}: {}.", path.string(), std::strerror(errno));
+                        unlink(path.c_str());
+                        return nullptr;
+                    }
+
+                    return std::make_shared<MappedBody>(static_cast<const uint8_t*>(address), bytes.size());
+                }
+
+
+                MappedBody(const uint8_t* address, size_t size)
+                    : mAddress(address)
+                    , mSize(size) {}
+
+
+                MappedBody(const MappedBody&)            = delete;
+                MappedBody& operator=(const MappedBody&) = delete;
+
+
+                ~MappedBody() override
+                {
+                    munmap(const_cast<uint8_t*>(mAddress), mSize);
+                }
+
+
+                [[nodiscard]] std::span<const uint8_t> Bytes() const override
+                {
+                    return {mAddress, mSize};
+                }
+
+            private:
+                const uint8_t* mAddress;
+                size_t         mSize;
+        };
+#endif
+
+
+        /// The Cache-Control directives which the cache obeys (RFC 9111 section 5.2).
+        struct CacheControl
+        {
+            Core::Optional<std::chrono::seconds> maxAge;
+            Core::Optional<std::chrono::seconds> sMaxAge;
+            Core::Optional<std::chrono::seconds> minFresh;
+            /// max-stale without a value accepts responses however stale they are.
+            bool                                 maxStale = false;
+            Core::Optional<std::chrono::seconds> maxStaleLimit;
+            bool                                 noStore         = false;
+            bool                                 noCache         = false;
+            bool                                 mustRevalidate  = false;
+            bool                                 proxyRevalidate = false;
+            bool                                 isPrivate       = false;
+            bool                                 isPublic        = false;
+            bool                                 onlyIfCached    = false;
+        };
+
+
+        std::string_view TrimWhitespace(std::string_view text)
+        {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+            return text;
+        }
+
+
+        std::string ToLower(std::string_view text)
+        {
+            std::string lower(text);
+            std::ranges::transform(lower, lower.begin(), [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; });
+            return lower;
+        }
+
+
+        /// Parses delta-seconds (RFC 9111 section 1.2.2), which saturate at 2^31.
+        Core::Optional<std::chrono::seconds> ParseDeltaSeconds(std::string_view text)
+        {
+            static constexpr uint64_t LIMIT = uint64_t(1) << 31;
+
+            if (text.empty() || !std::ranges::all_of(text, [](char c) { return c >= '0' && c <= '9'; })) return {};
+
+            uint64_t value  = 0;
+            auto     result = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (result.ec == std::errc::result_out_of_range || value > LIMIT) value = LIMIT;
+            return std::chrono::seconds(value);
+        }
+
+
+        void ParseCacheControl(std::string_view text, CacheControl& directives)
+        {
+            while (!text.empty())
+            {
+                // Each directive is a token, optionally followed by = and a token or quoted string.
+                const size_t nameEnd = text.find_first_of("=,");
+                const auto   name    = ToLower(TrimWhitespace(text.substr(0, nameEnd)));
+                text.remove_prefix(std::min(nameEnd, text.size()));
+
+                std::string argument;
+                bool        hasArgument = false;
+                if (!text.empty() && text.front() == '=')
+                {
+                    hasArgument = true;
+                    text        = TrimWhitespace(text.substr(1));
+                    if (!text.empty() && text.front() == '"')
+                    {
+                        size_t i = 1;
+                        for (; i < text.size() && text[i] != '"'; i++)
+                        {
+                            if (text[i] == '\\' && i + 1 < text.size()) i++;
+                            argument += text[i];
+                        }
+                        text.remove_prefix(std::min(i + 1, text.size()));
+                    }
+                    else
+                    {
+                        const size_t argumentEnd = text.find(',');
+                        argument                 = TrimWhitespace(text.substr(0, argumentEnd));
+                        text.remove_prefix(std::min(argumentEnd, text.size()));
+                    }
+                }
+
+                const size_t next = text.find(',');
+                text.remove_prefix(next == std::string_view::npos ? text.size() : next + 1);
+
+                // Invalid ages are treated as 0, so that the response is stale rather than fresh for too long.
+                auto seconds = [&]
+                {
+                    auto value = ParseDeltaSeconds(argument);
+                    return value ? *value : std::chrono::seconds(0);
+                };
+                if (name == "max-age") directives.maxAge = seconds();
+                else if (name == "s-maxage") directives.sMaxAge = seconds();
+                else if (name == "min-fresh") directives.minFresh = seconds();
+                else if (name == "max-stale")
+                {
+                    directives.maxStale = true;
+                    if (hasArgument) directives.maxStaleLimit = seconds();
+                }
+                else if (name == "no-store") directives.noStore = true;
+                else if (name == "no-cache") directives.noCache = true;
+                else if (name == "must-revalidate") directives.mustRevalidate = true;
+                else if (name == "proxy-revalidate") directives.proxyRevalidate = true;
+                else if (name == "private") directives.isPrivate = true;
+                else if (name == "public") directives.isPublic = true;
+                else if (name == "only-if-cached") directives.onlyIfCached = true;
+            }
+        }
+
+
+        CacheControl ParseCacheControl(const Header& header)
+        {
+            CacheControl directives;
+            for (auto value : header.GetAll(HeaderName::CACHE_CONTROL))
+            {
+                ParseCacheControl(value, directives);
+            }
+            return directives;
+        }
+
+
+        bool ParseNumber(std::string_view text, int& value)
+        {
+            auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            return result.ec == std::errc() && result.ptr == text.data() + text.size();
+        }
+
+
+        /// Parses an HTTP-date in any of the three formats which recipients must accept (RFC 9110 section 5.6.7).
+        Core::Optional<Clock::time_point> ParseHTTPDate(std::string_view text)
+        {
+            static constexpr std::array<std::string_view, 12> MONTHS = {
+                "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+            std::vector<std::string_view> tokens;
+            for (text = TrimWhitespace(text); !text.empty(); text = TrimWhitespace(text))
+            {
+                const size_t end = text.find(' ');
+                tokens.push_back(text.substr(0, end));
+                text.remove_prefix(std::min(end, text.size()));
+            }
+
+            std::string_view day, month, year, time;
+            if (tokens.size() == 6 && tokens[5] == "GMT")
+            {
+                // Sun, 06 Nov 1994 08:49:37 GMT
+                day = tokens[1], month = tokens[2], year = tokens[3], time = tokens[4];
+            }
+            else if (tokens.size() == 4 && tokens[3] == "GMT")
+            {
+                // Sunday, 06-Nov-94 08:49:37 GMT
+                const auto date = tokens[1];
+                if (date.size() != 9 || date[2] != '-' || date[6] != '-') return {};
+                day = date.substr(0, 2), month = date.substr(3, 3), year = date.substr(7), time = tokens[2];
+            }
+            else if (tokens.size() == 5)
+            {
+                // Sun Nov  6 08:49:37 1994
+                month = tokens[1], day = tokens[2], year = tokens[4], time = tokens[3];
+            }
+            else
+            {
+                return {};
+            }
+
+            int dayNumber = 0, yearNumber = 0, hours = 0, minutes = 0, seconds = 0;
+            auto monthIndex = std::ranges::find(MONTHS, month) - MONTHS.begin();
+            if (monthIndex == 12 || !ParseNumber(day, dayNumber) || !ParseNumber(year, yearNumber)) return {};
+            if (time.size() != 8 || time[2] != ':' || time[5] != ':'
+                || !ParseNumber(time.substr(0, 2), hours) || !ParseNumber(time.substr(3, 2), minutes) || !ParseNumber(time.substr(6, 2), seconds))
+            {
+                return {};
+            }
+            if (hours > 23 || minutes > 59 || seconds > 60) return {};
+
+            // Two digit years are in the 20th century from 70 onwards, as Unix time starts in 1970.
+            if (year.size() == 2) yearNumber += yearNumber < 70 ? 2000 : 1900;
+
+            const std::chrono::year_month_day date(std::chrono::year(yearNumber),
+                                                   std::chrono::month(static_cast<unsigned>(monthIndex + 1)),
+                                                   std::chrono::day(static_cast<unsigned>(dayNumber)));
+            if (!date.ok()) return {};
+
+            return Clock::time_point(std::chrono::sys_days(date)
+                                     + std::chrono::hours(hours) + std::chrono::minutes(minutes) + std::chrono::seconds(seconds));
+        }
+
+
+        Core::Optional<Clock::time_point> FindDate(const Header& header, HeaderName name)
+        {
+            auto value = header.Find(name);
+            if (!value) return {};
+            return ParseHTTPDate(*value);
+        }
+
+
+        /// Statuses which may be stored with a heuristic lifetime (RFC 9110 section 15.1).
+        bool IsHeuristicallyCacheable(unsigned int status)
+        {
+            switch (status)
+            {
+                case 200: case 203: case 204: case 300: case 301: case 308:
+                case 404: case 405: case 410: case 414: case 501:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+
+        /// Returns the lowercase names of the request fields which the response varies on,
+        /// or nothing if it varies on something other than request fields.
+        Core::Optional<std::vector<std::string>> GetVaryNames(const Response& response)
+        {
+            std::vector<std::string> names;
+            for (auto value : response.GetHeader().GetAll(HeaderName::VARY))
+            {
+                while (!value.empty())
+                {
+                    const size_t end  = value.find(',');
+                    const auto   name = TrimWhitespace(value.substr(0, end));
+                    value.remove_prefix(end == std::string_view::npos ? value.size() : end + 1);
+
+                    if (name == "*") return {};
+                    if (!name.empty()) names.push_back(ToLower(name));
+                }
+            }
+            return names;
+        }
+
+
+        /// Returns all the values of a request field as one.
+        std::string GetCombinedValue(const Request& request, std::string_view name)
+        {
+            std::string combined;
+            for (auto value : request.GetHeader().GetAll(name))
+            {
+                if (!combined.empty()) combined += ", ";
+                combined += TrimWhitespace(value);
+            }
+            return combined;
+        }
+
+
+        size_t GetHeaderSize(const Header& header)
+        {
+            size_t size = 0;
+            for (auto field : header)
+            {
+                size += field.name.size() + field.value.size();
+            }
+            return size;
+        }
+    } // namespace
+
+
+    CachedResponse::CachedResponse(Response response, std::shared_ptr<const Body> body, bool fromCache)
+        : mResponse(std::move(response))
+        , mBody(std::move(body))
+        , mFromCache(fromCache) {}
+
+
+    Response CachedResponse::IntoResponse() &&
+    {
+        auto bytes = GetBody();
+        mResponse.SetPayload(Core::IO::DynamicByteBuffer(bytes.data(), bytes.size()));
+        return std::move(mResponse);
+    }
+
+
+    HTTPCache::HTTPCache(HTTPCacheOptions options)
+        : mOptions(std::move(options))
+    {
+        std::random_device random;
+        mFilePrefix = fmt::format("{:08x}{:08x}", random(), random());
+
+        if (mOptions.diskDirectory.empty()) return;
+
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+        std::error_code error;
+        std::filesystem::create_directories(mOptions.diskDirectory, error);
+        if (error)
+        {
+            Core::Logging::Error("Could not create cache directory {}: {}.", mOptions.diskDirectory.string(), error.message());
+        }
+#else
+        Core::Logging::Info("Bodies can only be cached on disk on Mac and Linux. Keeping them in memory.");
+#endif
+    }
+
+
+    HTTPCache::~HTTPCache()
+    {
+        Clear();
+    }
+
+
+    size_t HTTPCache::GetEntryCount() const
+    {
+        std::lock_guard lock(mMutex);
+        return mEntries.size();
+    }
+
+
+    size_t HTTPCache::GetMemoryUsage() const
+    {
+        std::lock_guard lock(mMutex);
+        return mMemoryUsage;
+    }
+
+
+    void HTTPCache::Clear()
+    {
+        std::lock_guard lock(mMutex);
+        while (!mEntries.empty())
+        {
+            Remove(mEntries.begin());
+        }
+    }
+
+
+    CachedResponse HTTPCache::PassThrough(Response response)
+    {
+        std::shared_ptr<const CachedResponse::Body> body;
+        if (response.GetPayload().Size() > 0)
+        {
+            body = std::make_shared<MemoryBody>(std::move(response.GetPayload()));
+            response.SetPayload({});
+        }
+        return CachedResponse(std::move(response), std::move(body), false);
+    }
+
+
+    HTTPCache::Lookup HTTPCache::Find(const std::string& key, const Request& request)
+    {
+        auto directives = ParseCacheControl(request.GetHeader());
+        // Pragma: no-cache is only honoured when there is no Cache-Control (RFC 9111 section 5.4).
+        if (!request.GetHeader().Contains(HeaderName::CACHE_CONTROL) && request.GetHeader().ContainsToken(HeaderName::PRAGMA, "no-cache"))
+        {
+            directives.noCache = true;
+        }
+
+        Lookup          lookup;
+        std::lock_guard lock(mMutex);
+
+        auto entry = FindEntry(key, request);
+        if (entry == mEntries.end())
+        {
+            lookup.onlyIfCached = directives.onlyIfCached;
+            return lookup;
+        }
+        mEntries.splice(mEntries.begin(), mEntries, entry);
+
+        const auto now      = Clock::now();
+        const auto age      = entry->initialAge + (now - entry->responseTime);
+        const auto lifetime = entry->freshnessLifetime;
+
+        const auto minFresh = directives.minFresh ? *directives.minFresh : std::chrono::seconds(0);
+        bool       usable   = age + minFresh < lifetime;
+        if (!usable && directives.maxStale && !entry->mustRevalidate)
+        {
+            usable = !directives.maxStaleLimit || age - lifetime <= *directives.maxStaleLimit;
+        }
+        if (directives.maxAge && age > *directives.maxAge) usable = false;
+        if (entry->noCache || directives.noCache) usable = false;
+
+        if (usable)
+        {
+            lookup.fresh.Emplace(Serve(*entry, now, true));
+            return lookup;
+        }
+
+        if (directives.onlyIfCached)
+        {
+            lookup.onlyIfCached = true;
+            return lookup;
+        }
+
+        // Requests which are already conditional are the caller's own, and are sent unchanged.
+        const auto& header = request.GetHeader();
+        if (header.Contains(HeaderName::IF_NONE_MATCH) || header.Contains(HeaderName::IF_MODIFIED_SINCE)) return lookup;
+
+        const auto& stored       = entry->response.GetHeader();
+        auto        etag         = stored.Find(HeaderName::ETAG);
+        auto        lastModified = stored.Find(HeaderName::LAST_MODIFIED);
+        if (etag || lastModified)
+        {
+            auto& conditional = lookup.conditional.Emplace(request);
+            if (etag) conditional.GetHeader().Set(HeaderName::IF_NONE_MATCH, *etag);
+            if (lastModified) conditional.GetHeader().Set(HeaderName::IF_MODIFIED_SINCE, *lastModified);
+        }
+
+        return lookup;
+    }
+
+
+    CachedResponse HTTPCache::Update(const std::string& key, const Request& request, Response response, Clock::time_point requestTime)
+    {
+        const auto responseTime = Clock::now();
+        const auto& header      = response.GetHeader();
+
+        if (response.GetStatus() == 304)
+        {
+            std::lock_guard lock(mMutex);
+
+            auto entry = FindEntry(key, request);
+            if (entry == mEntries.end()) return PassThrough(std::move(response));
+
+            // A 304 with a different entity tag is about some other response (RFC 9111 section 4.3.4).
+            auto etag       = header.Find(HeaderName::ETAG);
+            auto storedEtag = entry->response.GetHeader().Find(HeaderName::ETAG);
+            if (etag && storedEtag && *etag != *storedEtag) return PassThrough(std::move(response));
+
+            // Freshen the stored header fields with the new ones, keeping the framing of the stored body.
+            const auto& stored = entry->response;
+            Response    updated(stored.GetVersion(), stored.GetStatus(), stored.GetStatusText());
+            auto isContentLength = [](const Header::Field& field) { return field.wellKnown && *field.wellKnown == HeaderName::CONTENT_LENGTH; };
+            for (auto field : stored.GetHeader())
+            {
+                if (!isContentLength(field) && header.Contains(field.name)) continue;
+                updated.GetHeader().Add(field.name, field.value);
+            }
+            for (auto field : header)
+            {
+                if (isContentLength(field)) continue;
+                updated.GetHeader().Add(field.name, field.value);
+            }
+
+            mMemoryUsage -= entry->memorySize;
+            entry->memorySize = entry->memorySize - GetHeaderSize(stored.GetHeader()) + GetHeaderSize(updated.GetHeader());
+            mMemoryUsage += entry->memorySize;
+            entry->response = std::move(updated);
+            SetTimes(*entry, requestTime, responseTime);
+            mEntries.splice(mEntries.begin(), mEntries, entry);
+
+            // Callers who made their own request conditional get their 304.
+            const bool conditional = request.GetHeader().Contains(HeaderName::IF_NONE_MATCH)
+                                     || request.GetHeader().Contains(HeaderName::IF_MODIFIED_SINCE);
+            auto result = conditional ? PassThrough(std::move(response)) : Serve(*entry, responseTime, true);
+            Trim();
+            return result;
+        }
+
+        const auto requestDirectives  = ParseCacheControl(request.GetHeader());
+        const auto responseDirectives = ParseCacheControl(header);
+        const auto varyNames          = GetVaryNames(response);
+        const auto status             = response.GetStatus();
+
+        // Whether the response may be stored (RFC 9111 section 3).
+        bool storable = status >= 200 && status != 206 && varyNames
+                        && !requestDirectives.noStore && !responseDirectives.noStore
+                        && !(mOptions.shared && responseDirectives.isPrivate);
+        if (mOptions.shared && request.GetHeader().Contains(HeaderName::AUTHORIZATION))
+        {
+            storable = storable && (responseDirectives.isPublic || responseDirectives.sMaxAge || responseDirectives.mustRevalidate);
+        }
+        storable = storable && (header.Contains(HeaderName::EXPIRES) || responseDirectives.maxAge
+                                || (mOptions.shared && responseDirectives.sMaxAge) || responseDirectives.isPublic
+                                || (!mOptions.shared && responseDirectives.isPrivate) || IsHeuristicallyCacheable(status));
+
+        if (!storable)
+        {
+            // The new response supersedes whatever was stored for the request.
+            std::lock_guard lock(mMutex);
+            if (auto entry = FindEntry(key, request); entry != mEntries.end()) Remove(entry);
+            return PassThrough(std::move(response));
+        }
+
+        // Build the entry, and write its body, before taking the lock. The status text and header fields are
+        // copied, since the client may have allocated them from a memory resource which won't outlive the entry.
+        Response stored(response.GetVersion(), response.GetStatus(), response.GetStatusText());
+        for (auto field : header)
+        {
+            stored.GetHeader().Add(field.name, field.value);
+        }
+
+        Entry entry {
+            .key               = key,
+            .selecting         = {},
+            .response          = std::move(stored),
+            .body              = nullptr,
+            .file              = {},
+            .responseTime      = {},
+            .initialAge        = {},
+            .freshnessLifetime = {},
+            .noCache           = false,
+            .mustRevalidate    = false,
+            .memorySize        = 0,
+            .diskSize          = 0,
+        };
+        for (const auto& name : *varyNames)
+        {
+            entry.selecting.emplace_back(name, GetCombinedValue(request, name));
+        }
+        SetTimes(entry, requestTime, responseTime);
+        StoreBody(entry, std::move(response.GetPayload()));
+        entry.memorySize += sizeof(Entry) + key.size() + GetHeaderSize(entry.response.GetHeader());
+
+        auto result = Serve(entry, responseTime, false);
+        if (entry.memorySize > mOptions.memoryBudget || entry.diskSize > mOptions.diskBudget)
+        {
+            if (!entry.file.empty())
+            {
+                std::error_code error;
+                std::filesystem::remove(entry.file, error);
+            }
+            return result;
+        }
+
+        std::lock_guard lock(mMutex);
+        if (auto existing = FindEntry(key, request); existing != mEntries.end()) Remove(existing);
+
+        mMemoryUsage += entry.memorySize;
+        mDiskUsage += entry.diskSize;
+        mEntries.push_front(std::move(entry));
+        mIndex[key].push_back(mEntries.begin());
+        Trim();
+
+        return result;
+    }
+
+
+    void HTTPCache::Invalidate(const std::string& key)
+    {
+        std::lock_guard lock(mMutex);
+
+        auto variants = mIndex.find(key);
+        if (variants == mIndex.end()) return;
+
+        // Removing the last variant erases the index entry, so take a copy of the list first.
+        auto entries = variants->second;
+        for (auto entry : entries)
+        {
+            Remove(entry);
+        }
+    }
+
+
+    std::list<HTTPCache::Entry>::iterator HTTPCache::FindEntry(const std::string& key, const Request& request)
+    {
+        auto variants = mIndex.find(key);
+        if (variants == mIndex.end()) return mEntries.end();
+
+        for (auto entry : variants->second)
+        {
+            if (std::ranges::all_of(entry->selecting, [&](const auto& field)
+            {
+                return GetCombinedValue(request, field.first) == field.second;
+            }))
+            {
+                return entry;
+            }
+        }
+
+        return mEntries.end();
+    }
+
+
+    void HTTPCache::SetTimes(Entry& entry, Clock::time_point requestTime, Clock::time_point responseTime) const
+    {
+        using std::chrono::seconds;
+
+        const auto& header     = entry.response.GetHeader();
+        const auto  directives = ParseCacheControl(header);
+        const auto  dateValue  = FindDate(header, HeaderName::DATE);
+        const auto  date       = dateValue ? *dateValue : responseTime;
+
+        // The age when the response arrived (RFC 9111 section 4.2.3).
+        auto       ageValue    = seconds(0);
+        const auto apparentAge = std::max(Clock::duration::zero(), responseTime - date);
+        if (auto age = header.Find(HeaderName::AGE))
+        {
+            auto parsed = ParseDeltaSeconds(*age);
+            if (parsed) ageValue = *parsed;
+        }
+        entry.responseTime     = responseTime;
+        entry.initialAge       = std::max<Clock::duration>(apparentAge, ageValue + (responseTime - requestTime));
+
+        // How long it stays fresh (RFC 9111 section 4.2.1), or 10% of the time since it was last modified (section 4.2.2).
+        if (mOptions.shared && directives.sMaxAge)
+        {
+            entry.freshnessLifetime = *directives.sMaxAge;
+        }
+        else if (directives.maxAge)
+        {
+            entry.freshnessLifetime = *directives.maxAge;
+        }
+        else if (header.Contains(HeaderName::EXPIRES))
+        {
+            auto expires            = FindDate(header, HeaderName::EXPIRES);
+            entry.freshnessLifetime = expires ? std::max(Clock::duration::zero(), *expires - date) : Clock::duration::zero();
+        }
+        else if (auto lastModified = FindDate(header, HeaderName::LAST_MODIFIED);
+                 lastModified && (directives.isPublic || IsHeuristicallyCacheable(entry.response.GetStatus())))
+        {
+            entry.freshnessLifetime = std::min<Clock::duration>(std::max(Clock::duration::zero(), date - *lastModified) / 10, std::chrono::hours(24));
+        }
+        else
+        {
+            entry.freshnessLifetime = Clock::duration::zero();
+        }
+
+        entry.noCache        = directives.noCache;
+        entry.mustRevalidate = directives.mustRevalidate || (mOptions.shared && (directives.proxyRevalidate || directives.sMaxAge));
+    }
+
+
+    void HTTPCache::StoreBody(Entry& entry, Core::IO::DynamicByteBuffer payload)
+    {
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+        if (!mOptions.diskDirectory.empty() && payload.Size() > 0 && payload.Size() >= mOptions.diskThreshold)
+        {
+            auto path = mOptions.diskDirectory / fmt::format("{}-{}.body", mFilePrefix, mNextFile++);
+            if (auto body = MappedBody::Create(path, {payload.Data(), payload.Size()}))
+            {
+                entry.body     = std::move(body);
+                entry.file     = std::move(path);
+                entry.diskSize = payload.Size();
+                return;
+            }
+        }
+#endif
+
+        if (payload.Size() > 0)
+        {
+            entry.memorySize = payload.Size();
+            entry.body       = std::make_shared<MemoryBody>(std::move(payload));
+        }
+    }
+
+
+    CachedResponse HTTPCache::Serve(const Entry& entry, Clock::time_point now, bool fromCache) const
+    {
+        Response response = entry.response;
+        if (fromCache)
+        {
+            const auto age = std::chrono::duration_cast<std::chrono::seconds>(entry.initialAge + (now - entry.responseTime));
+            response.GetHeader().Set(HeaderName::AGE, std::to_string(age.count()));
+        }
+        return CachedResponse(std::move(response), entry.body, fromCache);
+    }
+
+
+    void HTTPCache::Remove(std::list<Entry>::iterator entry)
+    {
+        auto variants = mIndex.find(entry->key);
+        std::erase(variants->second, entry);
+        if (variants->second.empty()) mIndex.erase(variants);
+
+        mMemoryUsage -= entry->memorySize;
+        mDiskUsage -= entry->diskSize;
+
+        // Bodies which are still being read stay mapped after their file is removed.
+        if (!entry->file.empty())
+        {
+            std::error_code error;
+            std::filesystem::remove(entry->file, error);
+        }
+
+        mEntries.erase(entry);
+    }
+
+
+    void HTTPCache::Trim()
+    {
+        while (!mEntries.empty() && (mMemoryUsage > mOptions.memoryBudget || mDiskUsage > mOptions.diskBudget))
+        {
+            Remove(std::prev(mEntries.end()));
+        }
+    }
+} // namespace Strawberry::Net::HTTP
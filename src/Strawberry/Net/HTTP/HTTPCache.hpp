@@ -0,0 +1,203 @@
+#pragma once
+
+
+#include "HTTPClient.hpp"
+#include "Request.hpp"
+#include "Response.hpp"
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace Strawberry::Net::HTTP
+{
+    struct HTTPCacheOptions
+    {
+        /// The most memory which stored responses may use, counting their header fields and in-memory bodies.
+        size_t                memoryBudget  = 64 * 1024 * 1024;
+        /// Where large bodies are kept, as files which are mapped into memory. Empty keeps everything in memory.
+        /// The files are removed when their responses are evicted, and when the cache is destroyed.
+        std::filesystem::path diskDirectory;
+        /// The most space which bodies on disk may use.
+        size_t                diskBudget    = 1024 * 1024 * 1024;
+        /// Bodies at least this large go to disk, when there is a disk directory.
+        size_t                diskThreshold = 1024 * 1024;
+        /// Whether the cache is shared between users, so must not store private responses, and obeys s-maxage.
+        bool                  shared        = false;
+    };
+
+
+    /// A response from an HTTPCache, whose body may be shared with the cache rather than copied.
+    class CachedResponse
+    {
+        public:
+            /// The body of a stored response, held in memory or mapped from a file.
+            class Body
+            {
+                public:
+                    virtual ~Body() = default;
+
+
+                    [[nodiscard]] virtual std::span<const uint8_t> Bytes() const = 0;
+            };
+
+
+            CachedResponse(Response response, std::shared_ptr<const Body> body, bool fromCache);
+
+
+            /// Returns the status line and header fields. The payload is left empty, since the body is shared.
+            [[nodiscard]] const Response& GetResponse() const
+            {
+                return mResponse;
+            }
+
+
+            /// Returns the body, which stays valid as long as this response, even if the cache evicts it.
+            [[nodiscard]] std::span<const uint8_t> GetBody() const
+            {
+                return mBody ? mBody->Bytes() : std::span<const uint8_t>();
+            }
+
+
+            /// Returns whether the body came from the cache, either fresh or after revalidating it with the server.
+            [[nodiscard]] bool IsFromCache() const
+            {
+                return mFromCache;
+            }
+
+
+            /// Copies the body into the payload of a standalone Response.
+            [[nodiscard]] Response IntoResponse() &&;
+
+        private:
+            Response                    mResponse;
+            std::shared_ptr<const Body> mBody;
+            bool                        mFromCache;
+    };
+
+
+    /// A private or shared HTTP cache (RFC 9111) in front of HTTP/1.1 clients.
+    ///
+    /// GET responses are stored when their Cache-Control, Expires or Last-Modified fields allow it, keyed by the
+    /// scheme, endpoint and target, and by the request fields named in Vary. Fresh responses are served without
+    /// contacting the server. Stale ones are revalidated with If-None-Match or If-Modified-Since, and served again
+    /// if the server answers 304 Not Modified. Successful unsafe requests invalidate what is stored for their target.
+    /// When the budgets are exceeded, the least recently used responses are evicted.
+    ///
+    /// It may be used from several threads at once. Requests go out on whichever client they are sent with.
+    class HTTPCache
+    {
+        public:
+            explicit HTTPCache(HTTPCacheOptions options = {});
+            HTTPCache(const HTTPCache&)            = delete;
+            HTTPCache& operator=(const HTTPCache&) = delete;
+            /// Evicts everything, removing any files on disk.
+            ~HTTPCache();
+
+
+            /// Sends the request through the cache, using the client if it can't be answered from storage.
+            template<typename S>
+            Core::Result<CachedResponse, Error> Send(HTTPClientBase<S>& client, const Request& request);
+
+
+            /// Returns how many responses are stored.
+            [[nodiscard]] size_t GetEntryCount() const;
+            /// Returns how much of the memory budget is in use.
+            [[nodiscard]] size_t GetMemoryUsage() const;
+            /// Evicts everything.
+            void                 Clear();
+
+        private:
+            using Clock = std::chrono::system_clock;
+
+
+            struct Entry
+            {
+                std::string                                      key;
+                /// The lowercase names in Vary, with the values they had in the request which was stored.
+                std::vector<std::pair<std::string, std::string>> selecting;
+                /// The status line and header fields, without the payload.
+                Response                                         response;
+                std::shared_ptr<const CachedResponse::Body>      body;
+                /// The path of the body's file, if it is on disk.
+                std::filesystem::path                            file;
+                /// When the response arrived, and how old it was then (RFC 9111 section 4.2.3).
+                Clock::time_point                                responseTime;
+                Clock::duration                                  initialAge {};
+                Clock::duration                                  freshnessLifetime {};
+                /// Whether the response has to be revalidated every time, or can never be served stale.
+                bool                                             noCache        = false;
+                bool                                             mustRevalidate = false;
+                size_t                                           memorySize     = 0;
+                size_t                                           diskSize       = 0;
+            };
+
+
+            /// What to do with a GET request, decided while holding the lock.
+            struct Lookup
+            {
+                /// A fresh response, ready to serve.
+                Core::Optional<CachedResponse> fresh;
+                /// The request to send instead, made conditional so a stale response can be revalidated.
+                Core::Optional<Request>        conditional;
+                /// Whether only a stored response may be used, so a miss gets 504 Gateway Timeout.
+                bool                           onlyIfCached = false;
+            };
+
+
+            template<typename S>
+            static std::string                   MakeKey(const HTTPClientBase<S>& client, const Request& request);
+            template<typename S>
+            static Core::Result<Response, Error> Fetch(HTTPClientBase<S>& client, const Request& request);
+            /// Wraps a response which isn't stored.
+            static CachedResponse                PassThrough(Response response);
+
+
+            Lookup         Find(const std::string& key, const Request& request);
+            /// Handles the response to a GET request which went to the server, storing it or refreshing what's stored.
+            CachedResponse Update(const std::string& key, const Request& request, Response response, Clock::time_point requestTime);
+            void           Invalidate(const std::string& key);
+
+
+            /// Returns the entry which was stored for this request, going by Vary, or mEntries.end().
+            std::list<Entry>::iterator FindEntry(const std::string& key, const Request& request);
+            /// Works out the age and freshness of a response which has just been received or revalidated.
+            void                       SetTimes(Entry& entry, Clock::time_point requestTime, Clock::time_point responseTime) const;
+            /// Keeps the body in memory, or in a file on disk if it's large.
+            void                       StoreBody(Entry& entry, Core::IO::DynamicByteBuffer payload);
+            [[nodiscard]] CachedResponse Serve(const Entry& entry, Clock::time_point now, bool fromCache) const;
+            void                       Remove(std::list<Entry>::iterator entry);
+            /// Evicts least recently used entries until the budgets are met.
+            void                       Trim();
+
+
+            const HTTPCacheOptions mOptions;
+            /// Starts the names of body files, so that caches sharing a directory don't clash.
+            std::string            mFilePrefix;
+            std::atomic<uint64_t>  mNextFile = 0;
+
+            mutable std::mutex                                             mMutex;
+            /// Entries, most recently used first.
+            std::list<Entry>                                               mEntries;
+            /// Entries by key. A key has several when its responses vary.
+            std::map<std::string, std::vector<std::list<Entry>::iterator>> mIndex;
+            size_t                                                         mMemoryUsage = 0;
+            size_t                                                         mDiskUsage   = 0;
+    };
+} // namespace Strawberry::Net::HTTP
+
+
+#include "HTTPCache.inl"
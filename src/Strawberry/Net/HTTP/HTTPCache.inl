@@ -0,0 +1,98 @@
+#pragma once
+
+
+#include "Strawberry/Net/HTTP/HTTPCache.hpp"
+#include "Strawberry/Net/Socket/TLSSocket.hpp"
+#include <concepts>
+#include <utility>
+
+
+namespace Strawberry::Net::HTTP
+{
+    template<typename S>
+    Core::Result<CachedResponse, Error> HTTPCache::Send(HTTPClientBase<S>& client, const Request& request)
+    {
+        const auto key = MakeKey(client, request);
+
+        if (request.GetVerb() != Verb::GET)
+        {
+            auto response = Fetch(client, request);
+            if (!response)
+            {
+                return response.Err();
+            }
+
+            // Unsafe methods change the resource, so what is stored for it is out of date (RFC 9111 section 4.4).
+            if (response->GetStatus() >= 200 && response->GetStatus() < 400)
+            {
+                Invalidate(key);
+            }
+
+            return PassThrough(response.Unwrap());
+        }
+
+        auto lookup = Find(key, request);
+        if (lookup.fresh)
+        {
+            return std::move(*lookup.fresh);
+        }
+        if (lookup.onlyIfCached)
+        {
+            return PassThrough(Response(request.GetVersion(), 504, "Gateway Timeout"));
+        }
+
+        const auto requestTime = Clock::now();
+        auto       response    = Fetch(client, lookup.conditional ? *lookup.conditional : request);
+        if (!response)
+        {
+            return response.Err();
+        }
+
+        return Update(key, request, response.Unwrap(), requestTime);
+    }
+
+
+    template<typename S>
+    std::string HTTPCache::MakeKey(const HTTPClientBase<S>& client, const Request& request)
+    {
+        std::string key = std::same_as<S, Socket::TLSSocket> ? "https://" : "http://";
+        key += client.GetEndpoint().ToString();
+
+        // Servers may host several sites on one endpoint.
+        if (auto host = request.GetHeader().Find(HeaderName::HOST))
+        {
+            key += '/';
+            key += *host;
+        }
+
+        key += ' ';
+        key += request.GetURI();
+        return key;
+    }
+
+
+    template<typename S>
+    Core::Result<Response, Error> HTTPCache::Fetch(HTTPClientBase<S>& client, const Request& request)
+    {
+        client.SendRequest(request);
+
+        auto response = client.ReceiveHeaders();
+        if (!response)
+        {
+            return response.Err();
+        }
+
+        Core::IO::DynamicByteBuffer payload;
+        auto bodyResult = client.ReceiveBody([&](std::span<const uint8_t> data)
+        {
+            payload.Push(data.data(), data.size());
+        });
+        if (!bodyResult)
+        {
+            return bodyResult.Err();
+        }
+
+        response->SetPayload(std::move(payload));
+        return response;
+    }
+} // namespace Strawberry::Net::HTTP
@@ -9,4 +9,8 @@ namespace Strawberry::Net::HTTP
 
     HTTPSClient::HTTPSClient(const Endpoint& endpoint)
         : HTTPClientBase<Socket::TLSSocket>(endpoint) {}
+
+
+    HTTPSClient::HTTPSClient(const Endpoint& endpoint, const Socket::TLSContext& context)
+        : HTTPClientBase<Socket::TLSSocket>(Socket::BufferedSocket(Socket::TLSSocket::Connect(endpoint, context).Unwrap(), SOCKET_BUFFER_SIZE)) {}
 } // namespace Strawberry::Net::HTTP
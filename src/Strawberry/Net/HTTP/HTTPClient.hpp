@@ -1,12 +1,26 @@
 #pragma once
 
 
+#include "BodySource.hpp"
+#include "ContentDecoder.hpp"
 #include "Request.hpp"
 #include "Response.hpp"
+#include "ResponseParser.hpp"
 #include "Strawberry/Net/Socket/TCPSocket.hpp"
 #include "Strawberry/Net/Socket/TLSSocket.hpp"
 #include "Strawberry/Net/Socket/BufferedSocket.hpp"
 #include "Strawberry/Core/Util/Strings.hpp"
+// Standard Library
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 
 namespace Strawberry::Net::HTTP
@@ -15,18 +29,108 @@ namespace Strawberry::Net::HTTP
 	class HTTPClientBase
 	{
 	public:
-		static constexpr size_t SOCKET_BUFFER_SIZE = 1024 * 1024 * 1;
+		static constexpr size_t SOCKET_BUFFER_SIZE      = 1024 * 1024 * 1;
+		/// How many pipelined requests may be awaiting responses at once, by default.
+		static constexpr size_t DEFAULT_PIPELINE_WINDOW = 16;
+		/// How many times Pipeline() reconnects without receiving a response before giving up.
+		static constexpr size_t MAX_PIPELINE_RECONNECTS = 3;
+		/// How much of a streamed request body is read and sent at a time.
+		static constexpr size_t UPLOAD_CHUNK_SIZE       = 64 * 1024;
+		/// The most decoded body data which ReadBody() returns at once.
+		static constexpr size_t DECODE_BUFFER_SIZE      = 64 * 1024;
 
 	public:
+		/// Takes over an already connected socket.
+		explicit HTTPClientBase(Socket::BufferedSocket<S> socket);
+
+
 		/// Sends an HTTP Request
 		void SendRequest(const Request& request);
-		/// Waits for an HTTP Response
+		/// Sends an HTTP Request with a body read from the source as it is sent, instead of the request's payload.
+		/// Only UPLOAD_CHUNK_SIZE bytes of the body are held in memory at once.
+		/// Content-Length or Transfer-Encoding is added to the header, depending on whether the length is known.
+		Core::Result<void, Error> SendRequest(const Request& request, BodySource body);
+		/// Waits for an HTTP Response, including its whole body.
 		Response Receive();
+		/// Waits for the status line and headers of the next response, and leaves its body to be read with
+		/// ReadBody() or ReceiveBody(). The body has to be read to the end before the next response.
+		Core::Result<Response, Error> ReceiveHeaders();
+		/// Returns the next part of the body as a view into the receive buffer, which is valid until the next call.
+		/// Returns an empty view once the body has ended.
+		Core::Result<std::span<const uint8_t>, Error> ReadBody();
+		/// Passes each part of the body to callback as it arrives, until the body ends.
+		template<std::invocable<std::span<const uint8_t>> F>
+		Core::Result<void, Error> ReceiveBody(F&& callback)
+		{
+			while (true)
+			{
+				auto data = ReadBody();
+				if (!data) return data.Err();
+				if (data->empty()) return Core::Success;
+				callback(*data);
+			}
+		}
+		/// Sends the requests back to back without waiting for responses, keeping at most window of them
+		/// in flight at once, and returns their responses in the same order.
+		///
+		/// If the server closes the connection part way through, it reconnects and resends the requests which
+		/// went unanswered. Requests with methods which aren't idempotent are sent alone, and fail rather than
+		/// being resent. No other requests may be awaiting responses when this is called.
+		std::vector<Core::Result<Response, Error>> Pipeline(std::span<const Request> requests, size_t window = DEFAULT_PIPELINE_WINDOW);
+
+
+		/// Sets the content codings which are requested with Accept-Encoding, and removed from response bodies.
+		/// Header fields are left as they were received, so Content-Encoding still names the coding which was removed.
+		void SetContentDecoders(ContentDecoderRegistry decoders)
+		{
+			mContentDecoders = std::move(decoders);
+			mDecodeContent   = !mContentDecoders.GetAcceptEncoding().empty();
+		}
+
+
+		/// Sets where the status text and header fields of received responses are allocated, such as a
+		/// std::pmr::monotonic_buffer_resource which is released once each response has been dealt with.
+		/// The resource has to outlive the responses.
+		void SetMemoryResource(std::pmr::memory_resource* resource)
+		{
+			mMemoryResource = resource;
+		}
+
+
+		/// Returns the endpoint which the client is connected to.
+		[[nodiscard]] Endpoint GetEndpoint() const
+		{
+			return mSocket.GetEndpoint();
+		}
+
+
+		/// Returns whether the connection can be used for another request,
+		/// going by the last request and response exchanged on it.
+		[[nodiscard]] bool IsReusable() const
+		{
+			return mReusable && mInFlight.empty();
+		}
+
+
+		/// Returns how long the server said it will keep the connection open while idle, if it did.
+		[[nodiscard]] Core::Optional<std::chrono::seconds> GetKeepAliveTimeout() const
+		{
+			return mKeepAliveTimeout;
+		}
+
+
+		/// Returns whether an idle connection has been closed by the server, or has received data nobody asked for.
+		/// Either way it can't be used for another request.
+		[[nodiscard]] bool IsStale() const
+		{
+			return mSocket.Poll();
+		}
 
 
 		/// Removes and returns the socket of an rvalue HTTP client.
 		Socket::BufferedSocket<S> IntoSocket() &&
 		{
+			mSocket.Consume(std::exchange(mPendingConsume, 0));
 			return std::move(mSocket);
 		}
 
@@ -35,13 +139,55 @@ namespace Strawberry::Net::HTTP
 		HTTPClientBase(const Endpoint& endpoint);
 
 	private:
-		/// Reads a line of input until a newline character from the socket.
-		std::string ReadLine();
-		/// Reads a chunked HTTP payload from the socket.
-		Core::IO::DynamicByteBuffer ReadChunkedPayload();
-
-	private:
-		Socket::BufferedSocket<S> mSocket;
+		/// Hex digits in the size line of each chunk of a streamed body.
+		static constexpr size_t CHUNK_SIZE_DIGITS = 8;
+
+
+		static void Append(Core::IO::DynamicByteBuffer& bytes, std::string_view string);
+		/// Serializes the request line and header fields, without the blank line which ends them.
+		void        SerializeHead(const Request& request, Core::IO::DynamicByteBuffer& bytes) const;
+		void        SerializeRequest(const Request& request, Core::IO::DynamicByteBuffer& bytes) const;
+		/// Returns whether the request asks for the connection to be closed after its response.
+		static bool RequestsClose(const Request& request);
+
+
+		Core::Result<Response, Error>              ReceiveResponse();
+		/// Parses the next element of the response, receiving more data as needed.
+		/// Views in the event stay valid until the next call.
+		Core::Result<ResponseParser::Event, Error> NextEvent();
+		/// Creates a decoder for the response body, if it has a content coding which can be removed.
+		void                                       StartDecoding(const Header& header);
+		/// Records what the finished response says about reusing the connection.
+		void                                       EndResponse();
+		/// Replaces the connection with a new one to the same endpoint.
+		Core::Result<void, Error>                  Reconnect();
+
+
+		Socket::BufferedSocket<S>            mSocket;
+		/// Requests are serialized here. It is cleared rather than freed, so once it has grown to fit,
+		/// sending a request doesn't allocate.
+		Core::IO::DynamicByteBuffer          mOutput;
+		ResponseParser                       mParser;
+		bool                                 mReadingBody    = false;
+		/// Bytes of the buffer used by the last event, which are consumed once its views are finished with.
+		size_t                               mPendingConsume = 0;
+		/// For each request awaiting a response, oldest first, whether it asked to close the connection.
+		std::deque<bool>                     mInFlight;
+		bool                                 mReusable = false;
+		Core::Optional<std::chrono::seconds> mKeepAliveTimeout;
+		std::pmr::memory_resource*           mMemoryResource = std::pmr::get_default_resource();
+
+		ContentDecoderRegistry          mContentDecoders = ContentDecoderRegistry::Default();
+		bool                            mDecodeContent   = true;
+		/// Decodes the body of the current response, if it has a content coding.
+		std::unique_ptr<ContentDecoder> mDecoder;
+		/// Encoded body data in the receive buffer, which has yet to be decoded.
+		std::span<const uint8_t>        mEncoded;
+		std::vector<uint8_t>            mDecoded;
+		/// Whether the last decode filled mDecoded, so might have more output waiting.
+		bool                            mDecoderFull = false;
+		/// Whether the decoder has been given any of the body.
+		bool                            mDecoderFed  = false;
 	};
 
 
@@ -56,6 +202,8 @@ namespace Strawberry::Net::HTTP
 	{
 	public:
 		explicit HTTPSClient(const Net::Endpoint& endpoint);
+		/// Connects with the given context, which is also used whenever the client reconnects.
+		HTTPSClient(const Net::Endpoint& endpoint, const Socket::TLSContext& context);
 	};
 } // namespace Strawberry::Net::HTTP
 
@@ -7,7 +7,11 @@
 // Libfmt
 #include "fmt/core.h"
 // Standard Library
-#include <regex>
+#include <charconv>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <utility>
 
 
 namespace Strawberry::Net::HTTP
@@ -18,160 +22,506 @@ namespace Strawberry::Net::HTTP
 
 
 	template<typename S>
-	void HTTPClientBase<S>::SendRequest(const Request& request)
+	HTTPClientBase<S>::HTTPClientBase(Socket::BufferedSocket<S> socket)
+		: mSocket(std::move(socket)) {}
+
+
+	template<typename S>
+	void HTTPClientBase<S>::Append(Core::IO::DynamicByteBuffer& bytes, std::string_view string)
 	{
-		Core::IO::DynamicByteBuffer bytes;
+		bytes.Write({string.data(), string.size()}).Unwrap();
+	}
 
-		std::string headerLine = fmt::format(
-											 "{} {} HTTP/{}\r\n",
-											 request.GetVerb().ToString(),
-											 request.GetURI(),
-											 request.GetVersion().ToString());
-		bytes.Write({headerLine.data(), headerLine.length()}).Unwrap();
-		for (const auto& [key, values]: *request.GetHeader())
+
+	template<typename S>
+	void HTTPClientBase<S>::SerializeHead(const Request& request, Core::IO::DynamicByteBuffer& bytes) const
+	{
+		// Every piece is appended as it is, so nothing is formatted into temporary strings.
+		Append(bytes, request.GetVerb().ToString());
+		Append(bytes, " ");
+		Append(bytes, request.GetURI());
+		Append(bytes, " HTTP/");
+		Append(bytes, request.GetVersion().ToString());
+		Append(bytes, "\r\n");
+		for (const auto& field: request.GetHeader())
 		{
-			for (const auto& value: values)
-			{
-				std::string formatted = fmt::format("{}: {}\r\n", key, value);
-				bytes.Write({formatted.data(), formatted.length()}).Unwrap();
-			}
+			Append(bytes, field.name);
+			Append(bytes, ": ");
+			Append(bytes, field.value);
+			Append(bytes, "\r\n");
 		}
 
-		std::vector<char> blankLine = {'\r', '\n'};
-		bytes.Write({blankLine.data(), blankLine.size()}).Unwrap();
+		// Ask for compressed responses, unless the request has its own preferences.
+		if (mDecodeContent && !request.GetHeader().Contains(HeaderName::ACCEPT_ENCODING))
+		{
+			Append(bytes, "Accept-Encoding: ");
+			Append(bytes, mContentDecoders.GetAcceptEncoding());
+			Append(bytes, "\r\n");
+		}
+	}
+
+
+	template<typename S>
+	void HTTPClientBase<S>::SerializeRequest(const Request& request, Core::IO::DynamicByteBuffer& bytes) const
+	{
+		SerializeHead(request, bytes);
+		Append(bytes, "\r\n");
 
 		if (request.GetPayload().Size() > 0)
 		{
 			bytes.Write({request.GetPayload().Data(), request.GetPayload().Size()}).Unwrap();
 		}
-
-		mSocket.Write(bytes).Unwrap();
 	}
 
 
 	template<typename S>
-	Response HTTPClientBase<S>::Receive()
+	bool HTTPClientBase<S>::RequestsClose(const Request& request)
 	{
-		static const auto statusLinePattern = std::regex(R"(HTTP\/([^\s]+)\s+(\d{3})\s+([^\r]*)\r\n)");
-		static const auto headerLinePattern = std::regex(R"(([^:]+)\s*:\s*([^\r]+)\r\n)");
+		// HTTP/1.0 requests have to opt in to persistent connections.
+		return request.GetHeader().ContainsToken(HeaderName::CONNECTION, "close")
+			|| (request.GetVersion() == Version::VERSION_1_0 && !request.GetHeader().ContainsToken(HeaderName::CONNECTION, "keep-alive"));
+	}
 
-		std::string currentLine;
-		bool		matched;
-		std::smatch matchResults;
 
-		do
+	template<typename S>
+	void HTTPClientBase<S>::SendRequest(const Request& request)
+	{
+		mOutput.Clear();
+		if (request.GetPayload().Size() <= UPLOAD_CHUNK_SIZE)
+		{
+			// Small payloads go out in the same write as the head.
+			SerializeRequest(request, mOutput);
+			mSocket.Write(mOutput).Unwrap();
+		}
+		else
 		{
-			currentLine = ReadLine();
-			matched		= std::regex_match(currentLine, matchResults, statusLinePattern);
+			// Large ones are written straight from the request, rather than copied in after the head.
+			SerializeHead(request, mOutput);
+			Append(mOutput, "\r\n");
+			mSocket.Write(mOutput).Unwrap();
+			mSocket.Write(request.GetPayload()).Unwrap();
 		}
-		while (!matched);
 
+		mInFlight.push_back(RequestsClose(request));
+	}
 
-		std::string version	   = matchResults[1],
-			status	   = matchResults[2],
-			statusText = matchResults[3];
 
-		Response response(*Version::Parse(version), std::stoi(status), statusText);
+	template<typename S>
+	Core::Result<void, Error> HTTPClientBase<S>::SendRequest(const Request& request, BodySource body)
+	{
+		// Until the whole body is sent, the connection can't be reused.
+		mInFlight.push_back(RequestsClose(request));
+
+		const auto length = body.GetLength();
+
+		mOutput.Clear();
+		SerializeHead(request, mOutput);
+		if (length)
+		{
+			char digits[std::numeric_limits<size_t>::digits10 + 1];
+			auto end = std::to_chars(std::begin(digits), std::end(digits), *length).ptr;
+			Append(mOutput, "Content-Length: ");
+			Append(mOutput, {digits, end});
+			Append(mOutput, "\r\n\r\n");
+		}
+		else
+		{
+			Append(mOutput, "Transfer-Encoding: chunked\r\n\r\n");
+		}
+		if (auto writeResult = mSocket.Write(mOutput); !writeResult)
+		{
+			return writeResult.Err();
+		}
+
+		// Chunks are framed in place, with a fixed width size before the data and a line ending after it,
+		// so that each is sent in a single write. Leading zeroes in chunk sizes are allowed (RFC 9112 section 7.1).
+		const size_t prefix = length ? 0 : CHUNK_SIZE_DIGITS + 2;
+		const size_t suffix = length ? 0 : 2;
+		auto         buffer = Core::IO::DynamicByteBuffer::Zeroes(prefix + UPLOAD_CHUNK_SIZE + suffix);
+		size_t       sent   = 0;
 
 		while (true)
 		{
-			currentLine = ReadLine();
+			auto readResult = body.Read({buffer.Data() + prefix, UPLOAD_CHUNK_SIZE});
+			if (!readResult)
+			{
+				return readResult.Err();
+			}
 
-			if (currentLine == "\r\n")
+			const size_t count = readResult.Unwrap();
+			if (count == 0)
 			{
 				break;
 			}
-			else if (std::regex_match(currentLine, matchResults, headerLinePattern))
+
+			sent += count;
+			if (length && sent > *length)
 			{
-				response.GetHeader().Add(matchResults[1], matchResults[2]);
+				Core::Logging::Error("HTTP request body is longer than its Content-Length of {}.", *length);
+				return Error(ErrorProtocolError {});
 			}
-		}
 
-		Core::IO::DynamicByteBuffer payload;
-		if (response.GetHeader().Contains("Transfer-Encoding"))
-		{
-			auto transferEncoding = response.GetHeader().Get("Transfer-Encoding");
+			if (!length)
+			{
+				fmt::format_to(reinterpret_cast<char*>(buffer.Data()), "{:0{}x}\r\n", count, CHUNK_SIZE_DIGITS);
+				buffer.Data()[prefix + count]     = '\r';
+				buffer.Data()[prefix + count + 1] = '\n';
+			}
 
-			if (transferEncoding == "chunked")
+			// Blocking writes wait for the socket to accept more, so the source is only read as fast as the connection sends.
+			if (auto writeResult = mSocket.Write(std::span<const uint8_t>(buffer.Data(), prefix + count + suffix)); !writeResult)
 			{
-				payload = ReadChunkedPayload();
+				return writeResult.Err();
 			}
-			else
+		}
+
+		if (length && sent != *length)
+		{
+			Core::Logging::Error("HTTP request body ended after {} of its {} bytes.", sent, *length);
+			return Error(ErrorProtocolError {});
+		}
+
+		if (!length)
+		{
+			static constexpr char LAST_CHUNK[] = "0\r\n\r\n";
+			if (auto writeResult = mSocket.Write(std::span(reinterpret_cast<const uint8_t*>(LAST_CHUNK), sizeof(LAST_CHUNK) - 1)); !writeResult)
 			{
-				Core::Logging::Error("Unsupported value for Transfer-Encoding: {}", transferEncoding);
-				Core::Unreachable();
+				return writeResult.Err();
 			}
 		}
-		else if (response.GetHeader().Contains("Content-Length"))
+
+		return Core::Success;
+	}
+
+
+	template<typename S>
+	Response HTTPClientBase<S>::Receive()
+	{
+		return ReceiveResponse().Unwrap();
+	}
+
+
+	template<typename S>
+	std::vector<Core::Result<Response, Error>> HTTPClientBase<S>::Pipeline(std::span<const Request> requests, size_t window)
+	{
+		Core::Assert(window > 0);
+		// Responses still owed to earlier requests would be mistaken for these ones.
+		Core::Assert(mInFlight.empty());
+
+		std::vector<Core::Result<Response, Error>> responses;
+		responses.reserve(requests.size());
+
+		size_t sent       = 0;
+		// Reconnections since the last response, so that a server which never answers is eventually given up on.
+		size_t reconnects = 0;
+
+		auto failRemaining = [&](const Error& error)
+		{
+			while (responses.size() < requests.size()) responses.emplace_back(error);
+		};
+
+		while (responses.size() < requests.size())
 		{
-			unsigned long contentLength = std::stoul(response.GetHeader().Get("Content-Length"));
-			if (contentLength > 0)
+			// Top up the window, coalescing the new requests into a single write. Requests which aren't idempotent
+			// are sent on their own, since they can't be resent if the connection closes before they're answered.
+			mOutput.Clear();
+			while (sent < requests.size() && sent - responses.size() < window
+				   && (sent == responses.size() || (requests[sent].GetVerb().IsIdempotent() && requests[sent - 1].GetVerb().IsIdempotent())))
+			{
+				SerializeRequest(requests[sent], mOutput);
+				mInFlight.push_back(RequestsClose(requests[sent]));
+				sent++;
+			}
+
+			auto writeResult = mOutput.Size() > 0 ? mSocket.Write(mOutput) : Socket::StreamWriteResult(Core::Success);
+			auto response    = writeResult ? ReceiveResponse() : Core::Result<Response, Error>(writeResult.Err());
+
+			const auto& request = requests[responses.size()];
+			if (response)
+			{
+				responses.emplace_back(std::move(response));
+				reconnects = 0;
+				// The server may close after any response, such as when it reaches its Keep-Alive max,
+				// leaving the rest of the window unanswered.
+				if (mReusable || responses.size() == requests.size()) continue;
+			}
+			else if (response.Err().template IsType<ErrorProtocolError>() || !request.GetVerb().IsIdempotent())
+			{
+				// Malformed responses aren't retried, and nor are requests which the server may have acted on.
+				responses.emplace_back(response.Err());
+				if (responses.size() == requests.size()) break;
+			}
+			else if (reconnects >= MAX_PIPELINE_RECONNECTS)
+			{
+				Core::Logging::Error("Giving up on pipelined HTTP requests to {}.", mSocket.GetEndpoint().ToString());
+				failRemaining(response.Err());
+				break;
+			}
+
+			// Start again on a new connection, resending everything which went unanswered.
+			reconnects++;
+			if (auto reconnectResult = Reconnect(); !reconnectResult)
 			{
-				auto data = mSocket.Read(contentLength).Unwrap();
-				Core::Assert(data.Size() == contentLength);
-				payload.Push(data.Data(), data.Size());
+				failRemaining(reconnectResult.Err());
+				break;
 			}
+			sent = responses.size();
 		}
-		response.SetPayload(payload);
 
-		return response;
+		return responses;
 	}
 
 
 	template<typename S>
-	Core::IO::DynamicByteBuffer HTTPClientBase<S>::ReadChunkedPayload()
+	Core::Result<void, Error> HTTPClientBase<S>::Reconnect()
 	{
-		std::string		  line;
-		std::smatch		  matchResults;
-		static const auto chunkSizeLine		= std::regex(R"(([0123456789abcdefABCDEF]+)\r\n)");
-		size_t			  sumOfChunkLengths = 0;
+		auto socket = [this]
+		{
+			// Reconnect with the context the connection was made with, so that its verification and session cache still apply.
+			if constexpr (std::same_as<S, Socket::TLSSocket>)
+				return Socket::TLSSocket::Connect(mSocket.GetEndpoint(), mSocket.GetSocket().GetContext());
+			else
+				return S::Connect(mSocket.GetEndpoint());
+		}();
+		if (!socket)
+		{
+			return socket.Err();
+		}
 
-		Core::IO::DynamicByteBuffer payload;
+		mSocket = Socket::BufferedSocket(socket.Unwrap(), mSocket.GetBufferCapacity());
+		mInFlight.clear();
+		mReusable       = false;
+		mReadingBody    = false;
+		mPendingConsume = 0;
+		mDecoder.reset();
+		return Core::Success;
+	}
+
+
+	template<typename S>
+	Core::Result<Response, Error> HTTPClientBase<S>::ReceiveHeaders()
+	{
+		// The previous response's body has to be read first, since it comes before this one.
+		Core::Assert(!mReadingBody);
+		mReusable = false;
+		mParser.Reset();
+
+		Core::Optional<Response> response;
 		while (true)
 		{
-			line = this->ReadLine();
-			if (line == "\r\n")
+			auto event = NextEvent();
+			if (!event)
 			{
-				break;
+				return event.Err();
+			}
+
+			if (event->template IsType<ResponseParser::StatusLine>())
+			{
+				const auto& statusLine = event->template Ref<ResponseParser::StatusLine>();
+				response.Emplace(statusLine.version, statusLine.status, statusLine.reason, mMemoryResource);
 			}
-			else if (!std::regex_match(line, matchResults, chunkSizeLine))
+			else if (event->template IsType<ResponseParser::HeaderField>())
 			{
-				Core::Unreachable();
+				const auto& field = event->template Ref<ResponseParser::HeaderField>();
+				response->GetHeader().Add(field.name, field.value);
 			}
+			else if (event->template IsType<ResponseParser::HeadersComplete>())
+			{
+				// Interim responses are followed by the real one, except when switching protocols.
+				if (response->GetStatus() < 200 && response->GetStatus() != 101)
+				{
+					continue;
+				}
+
+				mReadingBody = true;
+				StartDecoding(response->GetHeader());
+				return response.Unwrap();
+			}
+			else if (event->template IsType<ResponseParser::MessageComplete>())
+			{
+				// The end of an interim response.
+				mParser.Reset();
+				response.Reset();
+			}
+		}
+	}
 
 
-			auto bytesToRead = std::stoul(matchResults[1], nullptr, 16);
-			if (bytesToRead > 0)
+	template<typename S>
+	Core::Result<std::span<const uint8_t>, Error> HTTPClientBase<S>::ReadBody()
+	{
+		while (mReadingBody)
+		{
+			// Decode what's left of the last part of the body first. A full output buffer may mean there's more to come.
+			if (mDecoder && (!mEncoded.empty() || mDecoderFull))
 			{
-				Core::IO::DynamicByteBuffer chunk;
-				chunk.Reserve(bytesToRead);
+				auto progress = mDecoder->Decode(mEncoded, mDecoded);
+				if (!progress)
+				{
+					mReadingBody = false;
+					return progress.Err();
+				}
+
+				mEncoded     = mEncoded.subspan(progress->consumed);
+				mDecoderFull = progress->produced == mDecoded.size();
+				if (progress->produced > 0)
+				{
+					return std::span<const uint8_t>(mDecoded.data(), progress->produced);
+				}
+
+				if (progress->consumed == 0 && !mEncoded.empty())
+				{
+					Core::Logging::Error("Failed to decode HTTP body from {}.", mSocket.GetEndpoint().ToString());
+					mReadingBody = false;
+					return Error(ErrorProtocolError {});
+				}
+				continue;
+			}
+
+			auto event = NextEvent();
+			if (!event)
+			{
+				mReadingBody = false;
+				return event.Err();
+			}
+
+			if (event->template IsType<ResponseParser::BodyData>())
+			{
+				const auto& data = event->template Ref<ResponseParser::BodyData>().data;
+				std::span   body(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+				if (!mDecoder)
+				{
+					return body;
+				}
+
+				// Decoded straight out of the receive buffer, which stays put until the next event.
+				mEncoded    = body;
+				mDecoderFed = true;
+			}
+			else if (event->template IsType<ResponseParser::MessageComplete>())
+			{
+				EndResponse();
+
+				// Bodiless responses can still name the coding their body would have had.
+				if (mDecoder && mDecoderFed && !mDecoder->IsFinished())
+				{
+					Core::Logging::Error("HTTP body from {} ended part way through its content coding.", mSocket.GetEndpoint().ToString());
+					return Error(ErrorProtocolError {});
+				}
+			}
+
+			// Trailer fields are skipped.
+		}
+
+		return std::span<const uint8_t>();
+	}
+
+
+	template<typename S>
+	Core::Result<Response, Error> HTTPClientBase<S>::ReceiveResponse()
+	{
+		auto response = ReceiveHeaders();
+		if (!response)
+		{
+			return response.Err();
+		}
+
+		Core::IO::DynamicByteBuffer payload;
+		auto bodyResult = ReceiveBody([&](std::span<const uint8_t> data)
+		{
+			payload.Push(data.data(), data.size());
+		});
+		if (!bodyResult)
+		{
+			return bodyResult.Err();
+		}
+
+		response->SetPayload(std::move(payload));
+		return response;
+	}
+
 
-				chunk.Push(this->mSocket.ReadAll(bytesToRead).Unwrap());
-				sumOfChunkLengths += chunk.Size();
-				Core::Assert(chunk.Size() == bytesToRead);
-				payload.Push(chunk);
+	template<typename S>
+	Core::Result<ResponseParser::Event, Error> HTTPClientBase<S>::NextEvent()
+	{
+		// The last event's views into the buffer are finished with now.
+		mSocket.Consume(std::exchange(mPendingConsume, 0));
+
+		while (true)
+		{
+			// Parse straight out of the socket's receive buffer.
+			auto             buffered = mSocket.Peek();
+			std::string_view input(reinterpret_cast<const char*>(buffered.data()), buffered.size());
+			size_t           consumed = 0;
+
+			auto event = mParser.Next(input, consumed);
+			if (event)
+			{
+				mPendingConsume = consumed;
+				return event;
 			}
 
-			auto CRLF = this->ReadLine();
-			Core::Assert(CRLF == "\r\n");
+			mSocket.Consume(consumed);
+			if (!event.Err().template IsType<ErrorNoData>())
+			{
+				Core::Logging::Error("Received malformed HTTP response from {}.", mSocket.GetEndpoint().ToString());
+				return event.Err();
+			}
 
-			if (bytesToRead == 0) break;
+			if (auto fillResult = mSocket.Fill(); !fillResult)
+			{
+				// Bodies without a length end when the connection closes.
+				if (fillResult.Err().template IsType<ErrorConnectionReset>())
+				{
+					if (auto finishResult = mParser.Finish())
+					{
+						return finishResult;
+					}
+				}
+
+				Core::Logging::Error("Failed to receive HTTP response from {}.", mSocket.GetEndpoint().ToString());
+				return fillResult.Err();
+			}
 		}
+	}
 
 
-		Core::Assert(sumOfChunkLengths == payload.Size());
-		return payload;
+	template<typename S>
+	void HTTPClientBase<S>::StartDecoding(const Header& header)
+	{
+		mEncoded     = {};
+		mDecoderFull = false;
+		mDecoderFed  = false;
+		const auto contentEncoding = header.Find(HeaderName::CONTENT_ENCODING);
+		mDecoder     = mDecodeContent && contentEncoding ? mContentDecoders.Create(*contentEncoding) : nullptr;
+
+		if (mDecoder && mDecoded.empty())
+		{
+			mDecoded.resize(DECODE_BUFFER_SIZE);
+		}
 	}
 
 
 	template<typename S>
-	std::string HTTPClientBase<S>::ReadLine()
+	void HTTPClientBase<S>::EndResponse()
 	{
-		std::string line;
-		while (!line.ends_with("\r\n"))
+		// Leave nothing of this response in the buffer, where it would look like the start of another.
+		mSocket.Consume(std::exchange(mPendingConsume, 0));
+		mReadingBody = false;
+
+		// Whether the request being answered asked to close the connection afterwards.
+		bool closeRequested = false;
+		if (!mInFlight.empty())
+		{
+			closeRequested = mInFlight.front();
+			mInFlight.pop_front();
+		}
+
+		mReusable = !closeRequested && mParser.IsKeepAlive();
+		mKeepAliveTimeout.Reset();
+		if (auto timeout = mParser.GetKeepAliveTimeout())
 		{
-			line += mSocket.ReadAll(1).Unwrap().template Into<char>();
+			mKeepAliveTimeout = std::chrono::seconds(*timeout);
 		}
-		return line;
 	}
 } // namespace Strawberry::Net::HTTP
@@ -0,0 +1,60 @@
+#include "Strawberry/Net/HTTP/HTTPConnectionPool.hpp"
+
+
+namespace Strawberry::Net::HTTP
+{
+    HTTPConnectionPool::HTTPConnectionPool(HTTPConnectionPoolOptions options)
+        : mOptions(options)
+        , mEvictor([this] { RunEvictor(); })
+    {}
+
+
+    HTTPConnectionPool::~HTTPConnectionPool()
+    {
+        {
+            std::lock_guard lock(mMutex);
+            mStopping = true;
+        }
+        mStopCondition.notify_all();
+        mEvictor.join();
+
+        Clear();
+    }
+
+
+    size_t HTTPConnectionPool::GetIdleCount() const
+    {
+        std::lock_guard lock(mMutex);
+
+        size_t count = 0;
+        for (const auto& [key, host] : mHTTPHosts) count += host.idle.size();
+        for (const auto& [key, host] : mHTTPSHosts) count += host.idle.size();
+        return count;
+    }
+
+
+    void HTTPConnectionPool::Clear()
+    {
+        {
+            std::lock_guard lock(mMutex);
+            Evict<Socket::TCPSocket>(Clock::now(), true);
+            Evict<Socket::TLSSocket>(Clock::now(), true);
+        }
+        mConnectionClosed.notify_all();
+    }
+
+
+    void HTTPConnectionPool::RunEvictor()
+    {
+        std::unique_lock lock(mMutex);
+        while (!mStopCondition.wait_for(lock, mOptions.evictionInterval, [this] { return mStopping; }))
+        {
+            auto now = Clock::now();
+            Evict<Socket::TCPSocket>(now, false);
+            Evict<Socket::TLSSocket>(now, false);
+
+            // Waiters may be able to open a connection in place of the evicted ones.
+            mConnectionClosed.notify_all();
+        }
+    }
+} // namespace Strawberry::Net::HTTP
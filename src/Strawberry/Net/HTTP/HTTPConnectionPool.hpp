@@ -0,0 +1,155 @@
+#pragma once
+
+
+#include "HTTPClient.hpp"
+#include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Net/Socket/TCPSocket.hpp"
+#include "Strawberry/Net/Socket/TLSSocket.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace Strawberry::Net::HTTP
+{
+    struct HTTPConnectionPoolOptions
+    {
+        /// The most connections, idle or borrowed, which are open to one host at a time.
+        size_t                    maxConnectionsPerHost = 6;
+        /// How long idle connections are kept, unless the server's Keep-Alive timeout is shorter.
+        std::chrono::milliseconds idleTimeout           = std::chrono::seconds(60);
+        /// How often idle connections are checked for expiry, or for having been closed by the server.
+        std::chrono::milliseconds evictionInterval      = std::chrono::seconds(5);
+        /// The context HTTPS connections are made with. Defaults to TLSContext::Default().
+        Core::Optional<Socket::TLSContext> tlsContext;
+    };
+
+
+    class HTTPConnectionPool;
+
+
+    /// A connection borrowed from an HTTPConnectionPool. When destroyed, it goes back to the pool
+    /// if it can carry another request, and is closed otherwise.
+    template<typename S>
+    class PooledConnection
+    {
+        public:
+            PooledConnection(const PooledConnection&)            = delete;
+            PooledConnection& operator=(const PooledConnection&) = delete;
+            PooledConnection(PooledConnection&& other) noexcept;
+            PooledConnection& operator=(PooledConnection&& other) noexcept;
+            ~PooledConnection();
+
+
+            HTTPClientBase<S>& operator*();
+            HTTPClientBase<S>* operator->();
+
+
+            /// Closes the connection now, rather than returning it to the pool.
+            void Discard();
+
+        private:
+            friend class HTTPConnectionPool;
+
+
+            PooledConnection(HTTPConnectionPool& pool, std::string key, HTTPClientBase<S> client);
+
+
+            HTTPConnectionPool*               mPool;
+            std::string                       mKey;
+            Core::Optional<HTTPClientBase<S>> mClient;
+    };
+
+
+    /// Keeps idle HTTP/1.1 connections open for reuse, keyed by host, port and scheme.
+    ///
+    /// The pool must outlive the connections borrowed from it. It may be used from several threads at once.
+    class HTTPConnectionPool
+    {
+        public:
+            explicit HTTPConnectionPool(HTTPConnectionPoolOptions options = {});
+            HTTPConnectionPool(const HTTPConnectionPool&)            = delete;
+            HTTPConnectionPool& operator=(const HTTPConnectionPool&) = delete;
+            /// Closes all idle connections.
+            ~HTTPConnectionPool();
+
+
+            /// Borrows a connection to the endpoint, over HTTP with a TCPSocket or HTTPS with a TLSSocket.
+            /// Idle connections are reused when they are still open, otherwise a new one is made.
+            /// Waits while the host already has the maximum number of connections open.
+            template<typename S>
+            Core::Result<PooledConnection<S>, Error> Acquire(const Endpoint& endpoint);
+
+
+            /// Returns how many idle connections are being kept.
+            [[nodiscard]] size_t GetIdleCount() const;
+            /// Closes all idle connections.
+            void                 Clear();
+
+        private:
+            template<typename S>
+            friend class PooledConnection;
+
+            using Clock = std::chrono::steady_clock;
+
+
+            template<typename S>
+            struct IdleConnection
+            {
+                HTTPClientBase<S> client;
+                Clock::time_point expiry;
+            };
+
+
+            template<typename S>
+            struct Host
+            {
+                /// Open connections to the host, whether idle or borrowed.
+                size_t                         connections = 0;
+                /// Idle connections, most recently used last.
+                std::vector<IdleConnection<S>> idle;
+            };
+
+
+            template<typename S>
+            std::map<std::string, Host<S>>& GetHosts()
+            {
+                if constexpr (std::same_as<S, Socket::TCPSocket>) return mHTTPHosts;
+                else return mHTTPSHosts;
+            }
+
+
+            /// Takes back a borrowed connection, keeping it if it can be reused.
+            template<typename S>
+            void Release(const std::string& key, Core::Optional<HTTPClientBase<S>> client);
+            /// Closes idle connections which have expired, or all of them if everything is set.
+            /// Must be called with the mutex held.
+            template<typename S>
+            void Evict(Clock::time_point now, bool everything);
+            /// Runs on mEvictor, evicting expired connections every evictionInterval.
+            void RunEvictor();
+
+
+            const HTTPConnectionPoolOptions mOptions;
+
+            mutable std::mutex                               mMutex;
+            /// Notified whenever a host's connection count goes down.
+            std::condition_variable                          mConnectionClosed;
+            std::map<std::string, Host<Socket::TCPSocket>> mHTTPHosts;
+            std::map<std::string, Host<Socket::TLSSocket>> mHTTPSHosts;
+
+            bool                    mStopping = false;
+            std::condition_variable mStopCondition;
+            std::thread             mEvictor;
+    };
+} // namespace Strawberry::Net::HTTP
+
+
+#include "HTTPConnectionPool.inl"
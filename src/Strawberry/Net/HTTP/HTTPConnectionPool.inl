@@ -0,0 +1,186 @@
+#pragma once
+
+
+#include "Strawberry/Net/HTTP/HTTPConnectionPool.hpp"
+#include "Strawberry/Net/Socket/BufferedSocket.hpp"
+#include "Strawberry/Core/Assert.hpp"
+#include <algorithm>
+#include <concepts>
+#include <memory>
+#include <utility>
+
+
+namespace Strawberry::Net::HTTP
+{
+    template<typename S>
+    PooledConnection<S>::PooledConnection(HTTPConnectionPool& pool, std::string key, HTTPClientBase<S> client)
+        : mPool(&pool)
+        , mKey(std::move(key))
+        , mClient(std::move(client)) {}
+
+
+    template<typename S>
+    PooledConnection<S>::PooledConnection(PooledConnection&& other) noexcept
+        : mPool(std::exchange(other.mPool, nullptr))
+        , mKey(std::move(other.mKey))
+        , mClient(std::move(other.mClient)) {}
+
+
+    template<typename S>
+    PooledConnection<S>& PooledConnection<S>::operator=(PooledConnection&& other) noexcept
+    {
+        if (this != &other)
+        {
+            std::destroy_at(this);
+            std::construct_at(this, std::move(other));
+        }
+
+        return *this;
+    }
+
+
+    template<typename S>
+    PooledConnection<S>::~PooledConnection()
+    {
+        if (mPool)
+        {
+            mPool->Release<S>(mKey, std::move(mClient));
+        }
+    }
+
+
+    template<typename S>
+    HTTPClientBase<S>& PooledConnection<S>::operator*()
+    {
+        return *mClient;
+    }
+
+
+    template<typename S>
+    HTTPClientBase<S>* PooledConnection<S>::operator->()
+    {
+        return &*mClient;
+    }
+
+
+    template<typename S>
+    void PooledConnection<S>::Discard()
+    {
+        mClient.Reset();
+    }
+
+
+    template<typename S>
+    Core::Result<PooledConnection<S>, Error> HTTPConnectionPool::Acquire(const Endpoint& endpoint)
+    {
+        auto key = endpoint.ToString();
+
+        {
+            std::unique_lock lock(mMutex);
+            while (true)
+            {
+                // Looked up each time around, since the evictor removes hosts with no connections.
+                auto& host = GetHosts<S>()[key];
+
+                // Prefer the most recently used connection, which is the least likely to have timed out.
+                while (!host.idle.empty())
+                {
+                    auto idle = std::move(host.idle.back());
+                    host.idle.pop_back();
+
+                    if (idle.expiry > Clock::now() && !idle.client.IsStale())
+                    {
+                        return PooledConnection<S>(*this, key, std::move(idle.client));
+                    }
+
+                    host.connections--;
+                }
+
+                if (host.connections < mOptions.maxConnectionsPerHost)
+                {
+                    // Reserve a place, so that the connection can be made without holding the lock.
+                    host.connections++;
+                    break;
+                }
+
+                mConnectionClosed.wait(lock);
+            }
+        }
+
+        auto socket = [&]
+        {
+            if constexpr (std::same_as<S, Socket::TLSSocket>)
+                return mOptions.tlsContext ? S::Connect(endpoint, *mOptions.tlsContext) : S::Connect(endpoint);
+            else
+                return S::Connect(endpoint);
+        }();
+        if (!socket)
+        {
+            {
+                std::lock_guard lock(mMutex);
+                GetHosts<S>()[key].connections--;
+            }
+            mConnectionClosed.notify_one();
+            return socket.Err();
+        }
+
+        Socket::BufferedSocket<S> buffered(socket.Unwrap(), HTTPClientBase<S>::SOCKET_BUFFER_SIZE);
+        return PooledConnection<S>(*this, std::move(key), HTTPClientBase<S>(std::move(buffered)));
+    }
+
+
+    template<typename S>
+    void HTTPConnectionPool::Release(const std::string& key, Core::Optional<HTTPClientBase<S>> client)
+    {
+        {
+            std::lock_guard lock(mMutex);
+            auto& host = GetHosts<S>()[key];
+
+            if (client && client->IsReusable())
+            {
+                auto timeout = mOptions.idleTimeout;
+                if (auto serverTimeout = client->GetKeepAliveTimeout())
+                {
+                    // Give up a second early, rather than racing the server to close the connection.
+                    timeout = std::min<std::chrono::milliseconds>(timeout, *serverTimeout - std::chrono::seconds(1));
+                }
+
+                if (timeout > std::chrono::milliseconds::zero())
+                {
+                    host.idle.push_back(IdleConnection<S>{std::move(*client), Clock::now() + timeout});
+                    return;
+                }
+            }
+
+            Core::Assert(host.connections > 0);
+            host.connections--;
+        }
+
+        mConnectionClosed.notify_one();
+    }
+
+
+    template<typename S>
+    void HTTPConnectionPool::Evict(Clock::time_point now, bool everything)
+    {
+        auto& hosts = GetHosts<S>();
+        for (auto it = hosts.begin(); it != hosts.end();)
+        {
+            auto& host    = it->second;
+            auto  evicted = std::erase_if(host.idle, [&](const IdleConnection<S>& idle)
+            {
+                return everything || idle.expiry <= now || idle.client.IsStale();
+            });
+            host.connections -= evicted;
+
+            if (host.connections == 0)
+            {
+                it = hosts.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,479 @@
+#include "Strawberry/Net/HTTP/HTTPServer.hpp"
+
+
+#include "Strawberry/Net/Socket/API.hpp"
+#include "Strawberry/Net/Socket/Platform.hpp"
+#include "Strawberry/Net/Socket/TCPListener.hpp"
+#include "Strawberry/Net/Socket/TCPSocket.hpp"
+#include "Strawberry/Core/IO/Logging.hpp"
+#include "fmt/format.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#if STRAWBERRY_TARGET_WINDOWS
+#include <winsock2.h>
+#elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+#include <poll.h>
+#endif
+
+
+namespace Strawberry::Net::HTTP
+{
+    /// Reason phrases for the errors which the server responds with itself.
+    static std::string_view GetErrorReason(unsigned int status)
+    {
+        switch (status)
+        {
+            case 413: return "Content Too Large";
+            case 431: return "Request Header Fields Too Large";
+            case 501: return "Not Implemented";
+            case 505: return "HTTP Version Not Supported";
+            default: return "Bad Request";
+        }
+    }
+
+
+    /// Responses with these statuses never have a body (RFC 9110 section 6.4.1).
+    static bool IsBodyless(unsigned int status)
+    {
+        return status < 200 || status == 204 || status == 304;
+    }
+
+
+    class HTTPServer::EventLoop
+    {
+        public:
+            EventLoop(Shared& shared, Socket::TCPListener listener)
+                : mShared(shared)
+                , mListener(std::move(listener)) {}
+
+
+            void Run();
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+
+            /// How long poll waits at a time, which bounds how long Stop() takes.
+            static constexpr std::chrono::milliseconds POLL_INTERVAL{100};
+            /// How much free space a connection's buffer has for each read.
+            static constexpr size_t                    READ_SIZE = 16 * 1024;
+
+
+            struct Connection
+            {
+                Connection(Socket::TCPSocket socket, const RequestLimits& limits, Clock::time_point now)
+                    : socket(std::move(socket))
+                    , parser(limits)
+                    , lastActive(now) {}
+
+
+                Socket::TCPSocket    socket;
+                RequestParser        parser;
+                /// Received bytes. Those between inputStart and inputEnd have yet to be handled.
+                std::vector<uint8_t> input;
+                size_t               inputStart = 0;
+                size_t               inputEnd   = 0;
+                /// Response bytes which the socket hasn't accepted yet, from outputStart on.
+                std::vector<uint8_t> output;
+                size_t               outputStart = 0;
+                Clock::time_point    lastActive;
+                /// Whether no more requests will be handled, and the connection closes once its output is sent.
+                bool                 closing = false;
+                bool                 closed  = false;
+            };
+
+
+            void Accept(Clock::time_point now);
+            void Receive(Connection& connection, Clock::time_point now);
+            /// Handles the complete requests in the connection's buffer, and sends their responses.
+            void Process(Connection& connection, Clock::time_point now);
+            /// Adds a response to the batch being sent.
+            void AddResponse(Response response, bool close, bool headRequest);
+            /// Sends the batch of responses, keeping whatever the socket won't take yet.
+            void SendBatch(Connection& connection, Clock::time_point now);
+            /// Sends output which was left over from an earlier batch.
+            void Flush(Connection& connection, Clock::time_point now);
+            void UpdateDate();
+
+
+            Shared&                                  mShared;
+            Socket::TCPListener                      mListener;
+            std::vector<std::unique_ptr<Connection>> mConnections;
+            std::vector<SOCKET_POLL_FD_TYPE>         mPollFDs;
+
+            /// The batch of responses being sent on a connection, with their heads serialized back to back.
+            std::vector<Response>                 mResponses;
+            std::vector<bool>                     mSendBodies;
+            std::string                           mHeads;
+            std::vector<size_t>                   mHeadEnds;
+            std::vector<std::span<const uint8_t>> mBuffers;
+
+            /// The Date header field value, which only changes once a second.
+            std::string mDate;
+            std::time_t mDateTime = 0;
+    };
+
+
+    void HTTPServer::EventLoop::Run()
+    {
+        while (!mShared.stopping.load(std::memory_order_relaxed))
+        {
+            const size_t maxPendingOutput = mShared.options.maxPendingOutput;
+
+            mPollFDs.clear();
+            mPollFDs.push_back({mListener.GetHandle(), POLLIN, 0});
+            for (const auto& connection : mConnections)
+            {
+                const size_t pending = connection->output.size() - connection->outputStart;
+
+                // Stop reading when responses are piling up, so a client which doesn't read can't use up memory.
+                short events = 0;
+                if (!connection->closing && pending < maxPendingOutput) events |= POLLIN;
+                if (pending > 0) events |= POLLOUT;
+                mPollFDs.push_back({connection->socket.GetHandle(), events, 0});
+            }
+
+            const int ready = SOCKET_POLL_FUNCTION(mPollFDs.data(), static_cast<unsigned int>(mPollFDs.size()), static_cast<int>(POLL_INTERVAL.count()));
+            if (ready < 0)
+            {
+                if (Socket::API::GetError() == SOCKET_ERROR_TYPE_CODE(EINTR)) continue;
+                Core::Logging::Error("Error when polling HTTP server connections! Error code: {}", Socket::API::GetError());
+                break;
+            }
+
+            const auto now = Clock::now();
+            for (size_t i = 0; i < mConnections.size(); i++)
+            {
+                auto&       connection = *mConnections[i];
+                const short events     = mPollFDs[i + 1].revents;
+
+                if (events & POLLOUT) Flush(connection, now);
+                if (!connection.closed && (events & POLLIN)) Receive(connection, now);
+                if (events & (POLLERR | POLLHUP | POLLNVAL) && !(events & POLLIN)) connection.closed = true;
+
+                const bool idle = connection.output.empty() && connection.inputStart == connection.inputEnd;
+                if (idle && now - connection.lastActive > mShared.options.idleTimeout) connection.closed = true;
+            }
+
+            std::erase_if(mConnections, [](const auto& connection) { return connection->closed; });
+
+            if (mPollFDs[0].revents & POLLIN) Accept(now);
+        }
+    }
+
+
+    void HTTPServer::EventLoop::Accept(Clock::time_point now)
+    {
+        while (auto socket = mListener.Accept())
+        {
+            if (!socket->SetBlocking(false)) continue;
+            // Responses are written whole, so there's nothing to gain from holding them back.
+            (void) socket->SetNoDelay(true);
+
+            mConnections.push_back(std::make_unique<Connection>(std::move(*socket), mShared.options.limits, now));
+        }
+    }
+
+
+    void HTTPServer::EventLoop::Receive(Connection& connection, Clock::time_point now)
+    {
+        // Make room by moving unhandled bytes to the front, or failing that by growing the buffer.
+        // Partial requests keep their position relative to inputStart, which is all the parser depends on.
+        if (connection.input.size() - connection.inputEnd < READ_SIZE)
+        {
+            if (connection.inputStart > 0)
+            {
+                std::memmove(connection.input.data(), connection.input.data() + connection.inputStart, connection.inputEnd - connection.inputStart);
+                connection.inputEnd  -= connection.inputStart;
+                connection.inputStart = 0;
+            }
+
+            // The parser rejects requests over its limits, but a chunked body's framing isn't counted, so cap it here too.
+            const auto& limits = mShared.options.limits;
+            if (connection.inputEnd > 2 * limits.maxHeadSize + 2 * limits.maxBodySize)
+            {
+                connection.closed = true;
+                return;
+            }
+
+            if (connection.input.size() - connection.inputEnd < READ_SIZE)
+            {
+                connection.input.resize(connection.inputEnd + READ_SIZE);
+            }
+        }
+
+        auto read = connection.socket.ReadInto({connection.input.data() + connection.inputEnd, connection.input.size() - connection.inputEnd});
+        if (!read)
+        {
+            if (!read.Err().IsType<ErrorNoData>()) connection.closed = true;
+            return;
+        }
+
+        connection.inputEnd   += *read;
+        connection.lastActive  = now;
+        Process(connection, now);
+    }
+
+
+    void HTTPServer::EventLoop::Process(Connection& connection, Clock::time_point now)
+    {
+        const size_t maxPendingOutput = mShared.options.maxPendingOutput;
+
+        bool more = true;
+        while (more && !connection.closing && connection.output.empty())
+        {
+            mResponses.clear();
+            mSendBodies.clear();
+            mHeads.clear();
+            mHeadEnds.clear();
+
+            // Pipelined requests are handled in order, and their responses sent together.
+            size_t batchSize = 0;
+            more             = false;
+            while (!connection.closing && connection.inputStart < connection.inputEnd)
+            {
+                if (batchSize >= maxPendingOutput)
+                {
+                    more = true;
+                    break;
+                }
+
+                size_t consumed = 0;
+                auto   request  = connection.parser.Parse({connection.input.data() + connection.inputStart, connection.inputEnd - connection.inputStart}, consumed);
+                if (!request)
+                {
+                    if (request.Err().IsType<ErrorNoData>()) break;
+
+                    const unsigned int status = connection.parser.GetErrorStatus();
+                    AddResponse(Response(Version::VERSION_1_1, status, std::string(GetErrorReason(status))), true, false);
+                    connection.closing = true;
+                    break;
+                }
+
+                const bool headRequest = request->method == "HEAD";
+                Response   response    = mShared.handler(*request);
+                // Handlers may close the connection too, after which no more requests are answered on it.
+                const bool close       = !request->IsKeepAlive() || response.GetHeader().ContainsToken(HeaderName::CONNECTION, "close");
+                connection.inputStart += consumed;
+
+                batchSize += response.GetPayload().Size();
+                AddResponse(std::move(response), close, headRequest);
+                batchSize          += mHeads.size() - (mHeadEnds.size() > 1 ? mHeadEnds[mHeadEnds.size() - 2] : 0);
+                connection.closing  = close;
+            }
+
+            if (connection.inputStart == connection.inputEnd)
+            {
+                connection.inputStart = 0;
+                connection.inputEnd   = 0;
+            }
+
+            SendBatch(connection, now);
+        }
+    }
+
+
+    void HTTPServer::EventLoop::AddResponse(Response response, bool close, bool headRequest)
+    {
+        UpdateDate();
+
+        const unsigned int status  = response.GetStatus();
+        const auto&        header  = response.GetHeader();
+        auto               heads   = std::back_inserter(mHeads);
+
+        fmt::format_to(heads, "HTTP/1.1 {} {}\r\n", status, response.GetStatusText());
+        for (const auto& field : header)
+        {
+            // Framing is worked out here, from the payload.
+            if (field.wellKnown && (*field.wellKnown == HeaderName::CONTENT_LENGTH || *field.wellKnown == HeaderName::TRANSFER_ENCODING)) continue;
+            fmt::format_to(heads, "{}: {}\r\n", field.name, field.value);
+        }
+
+        if (!header.Contains(HeaderName::DATE)) fmt::format_to(heads, "Date: {}\r\n", mDate);
+        if (close && !header.ContainsToken(HeaderName::CONNECTION, "close")) mHeads.append("Connection: close\r\n");
+        if (!IsBodyless(status)) fmt::format_to(heads, "Content-Length: {}\r\n", response.GetPayload().Size());
+        mHeads.append("\r\n");
+
+        mHeadEnds.push_back(mHeads.size());
+        mSendBodies.push_back(!headRequest && !IsBodyless(status));
+        mResponses.push_back(std::move(response));
+    }
+
+
+    void HTTPServer::EventLoop::SendBatch(Connection& connection, Clock::time_point now)
+    {
+        if (mResponses.empty()) return;
+
+        // Heads and payloads are written together, without copying the payloads.
+        mBuffers.clear();
+        size_t headStart = 0;
+        for (size_t i = 0; i < mResponses.size(); i++)
+        {
+            mBuffers.emplace_back(reinterpret_cast<const uint8_t*>(mHeads.data()) + headStart, mHeadEnds[i] - headStart);
+            headStart = mHeadEnds[i];
+
+            const auto& payload = mResponses[i].GetPayload();
+            if (mSendBodies[i] && payload.Size() > 0) mBuffers.emplace_back(payload.Data(), payload.Size());
+        }
+
+        std::span<std::span<const uint8_t>> remaining(mBuffers);
+        while (!remaining.empty())
+        {
+            auto written = connection.socket.WriteVectored(remaining);
+            if (!written)
+            {
+                if (written.Err().IsType<ErrorWantWrite>()) break;
+                connection.closed = true;
+                return;
+            }
+
+            for (size_t count = *written; count > 0;)
+            {
+                if (count >= remaining.front().size())
+                {
+                    count    -= remaining.front().size();
+                    remaining = remaining.subspan(1);
+                }
+                else
+                {
+                    remaining.front() = remaining.front().subspan(count);
+                    count             = 0;
+                }
+            }
+        }
+
+        // Whatever the socket wouldn't take is copied, and sent once it's writable.
+        for (const auto& buffer : remaining)
+        {
+            connection.output.insert(connection.output.end(), buffer.begin(), buffer.end());
+        }
+
+        connection.lastActive = now;
+        if (connection.closing && connection.output.empty()) connection.closed = true;
+    }
+
+
+    void HTTPServer::EventLoop::Flush(Connection& connection, Clock::time_point now)
+    {
+        std::span<const uint8_t> pending(connection.output.data() + connection.outputStart, connection.output.size() - connection.outputStart);
+        auto                     written = connection.socket.WriteVectored({&pending, 1});
+        if (!written)
+        {
+            if (!written.Err().IsType<ErrorWantWrite>()) connection.closed = true;
+            return;
+        }
+
+        connection.outputStart += *written;
+        connection.lastActive   = now;
+        if (connection.outputStart < connection.output.size()) return;
+
+        connection.output.clear();
+        connection.outputStart = 0;
+
+        if (connection.closing)
+        {
+            connection.closed = true;
+            return;
+        }
+
+        // Requests which were held back while the output was full can go ahead now.
+        Process(connection, now);
+    }
+
+
+    void HTTPServer::EventLoop::UpdateDate()
+    {
+        const std::time_t time = std::time(nullptr);
+        if (time == mDateTime) return;
+        mDateTime = time;
+
+        std::tm calendar {};
+#if STRAWBERRY_TARGET_WINDOWS
+        gmtime_s(&calendar, &time);
+#elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+        gmtime_r(&time, &calendar);
+#endif
+
+        // IMF-fixdate (RFC 9110 section 5.6.7).
+        char buffer[64];
+        mDate.assign(buffer, std::strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &calendar));
+    }
+
+
+    Core::Result<HTTPServer, Error> HTTPServer::Start(const Endpoint& endpoint, Handler handler, HTTPServerOptions options)
+    {
+        size_t threads = options.threads > 0 ? options.threads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+#if STRAWBERRY_TARGET_WINDOWS
+        // Windows can't share a port between listeners, so one event loop accepts everything.
+        threads = 1;
+#endif
+
+        std::vector<Socket::TCPListener> listeners;
+        for (size_t i = 0; i < threads; i++)
+        {
+            auto listener = Socket::TCPListener::Bind(endpoint, Socket::TCPListenerOptions {.reusePort = threads > 1, .blocking = false});
+            if (!listener)
+            {
+                return listener.Err();
+            }
+            listeners.push_back(listener.Unwrap());
+        }
+
+        auto shared     = std::make_unique<Shared>();
+        shared->handler = std::move(handler);
+        shared->options = options;
+
+        std::vector<std::thread> eventLoops;
+        for (auto& listener : listeners)
+        {
+            eventLoops.emplace_back([shared = shared.get(), listener = std::move(listener)]() mutable
+            {
+                EventLoop(*shared, std::move(listener)).Run();
+            });
+        }
+
+        Core::Logging::Info("Serving HTTP on {} with {} threads.", endpoint.ToString(), threads);
+        return HTTPServer(std::move(shared), std::move(eventLoops));
+    }
+
+
+    HTTPServer::HTTPServer(std::unique_ptr<Shared> shared, std::vector<std::thread> threads)
+        : mShared(std::move(shared))
+        , mThreads(std::move(threads)) {}
+
+
+    HTTPServer& HTTPServer::operator=(HTTPServer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            std::destroy_at(this);
+            std::construct_at(this, std::move(other));
+        }
+
+        return *this;
+    }
+
+
+    HTTPServer::~HTTPServer()
+    {
+        Stop();
+    }
+
+
+    void HTTPServer::Stop()
+    {
+        if (!mShared) return;
+
+        mShared->stopping = true;
+        for (auto& thread : mThreads)
+        {
+            thread.join();
+        }
+        mThreads.clear();
+    }
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,79 @@
+#pragma once
+
+
+#include "RequestParser.hpp"
+#include "Response.hpp"
+#include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+namespace Strawberry::Net::HTTP
+{
+    struct HTTPServerOptions
+    {
+        /// Event loops to run, each on its own thread with its own listener. Zero runs one per hardware thread.
+        size_t                    threads          = 0;
+        RequestLimits             limits;
+        /// How long a connection may sit idle between requests before it is closed.
+        std::chrono::milliseconds idleTimeout      = std::chrono::seconds(60);
+        /// Response bytes waiting to be sent on a connection, beyond which no more pipelined requests are handled.
+        size_t                    maxPendingOutput = 1024 * 1024;
+    };
+
+
+    /// An HTTP/1.1 server.
+    ///
+    /// Each thread runs an event loop over the connections it accepted on its own listener. The listeners share the port,
+    /// and the kernel spreads new connections between them. Requests are parsed in place in each connection's buffer,
+    /// and pipelined requests which arrive together are handled in order, with their responses sent in one vectored write.
+    ///
+    /// Handlers are called on the event loop threads, so must be thread safe. The views in a request are only valid
+    /// during the call, and a slow handler holds up the other connections on its thread.
+    class HTTPServer
+    {
+        public:
+            using Handler = std::function<Response(const RequestView& request)>;
+
+
+            /// Binds to the endpoint, which must have a fixed port, and starts serving requests with the handler.
+            static Core::Result<HTTPServer, Error> Start(const Endpoint& endpoint, Handler handler, HTTPServerOptions options = {});
+
+
+            HTTPServer(const HTTPServer&)            = delete;
+            HTTPServer& operator=(const HTTPServer&) = delete;
+            HTTPServer(HTTPServer&& other) noexcept  = default;
+            HTTPServer& operator=(HTTPServer&& other) noexcept;
+            /// Stops the server.
+            ~HTTPServer();
+
+
+            /// Stops accepting connections, closes the open ones, and waits for the event loops to finish.
+            void Stop();
+
+        private:
+            /// State shared by the event loops.
+            struct Shared
+            {
+                Handler           handler;
+                HTTPServerOptions options;
+                std::atomic<bool> stopping = false;
+            };
+
+
+            class EventLoop;
+
+
+            HTTPServer(std::unique_ptr<Shared> shared, std::vector<std::thread> threads);
+
+
+            std::unique_ptr<Shared>  mShared;
+            std::vector<std::thread> mThreads;
+    };
+} // namespace Strawberry::Net::HTTP
@@ -2,46 +2,274 @@
 
 
 #include "Strawberry/Core/Assert.hpp"
-#include "Strawberry/Core/Util/Strings.hpp"
+#include <algorithm>
 
 
 namespace Strawberry::Net::HTTP
 {
-    void Header::Add(const Header::Key& key, const Header::Value& value)
+    static bool EqualsIgnoreCase(std::string_view a, std::string_view b)
     {
-        if (mEntries.contains(key))
+        auto lowercase = [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; };
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [&](char x, char y)
         {
-            mEntries.at(key).push_back(value);
+            return lowercase(x) == lowercase(y);
+        });
+    }
+
+
+    static bool ContainsTokenIn(std::string_view list, std::string_view token)
+    {
+        while (!list.empty())
+        {
+            auto element = list.substr(0, list.find(','));
+            list.remove_prefix(std::min(element.size() + 1, list.size()));
+            while (!element.empty() && (element.front() == ' ' || element.front() == '\t')) element.remove_prefix(1);
+            while (!element.empty() && (element.back() == ' ' || element.back() == '\t')) element.remove_suffix(1);
+            if (EqualsIgnoreCase(element, token)) return true;
+        }
+
+        return false;
+    }
+
+
+    Header::Header(std::pmr::memory_resource* resource)
+        : mStrings(resource)
+        , mEntries(resource) {}
+
+
+    void Header::Add(HeaderName name, std::string_view value)
+    {
+        Append(static_cast<uint8_t>(name), {}, value);
+    }
+
+
+    void Header::Add(std::string_view name, std::string_view value)
+    {
+        if (auto wellKnown = HeaderName::Parse(name))
+        {
+            Add(*wellKnown, value);
         }
         else
         {
-            mEntries.insert({key, {value}});
+            Append(UNKNOWN, name, value);
         }
     }
 
 
-    void Header::Set(const Header::Key& key, const Header::Value& value)
+    void Header::Set(HeaderName name, std::string_view value)
     {
-        mEntries.insert_or_assign(key, std::vector<Value>{value});
+        Remove(name);
+        Add(name, value);
     }
 
 
-    Header::Value Header::Get(const Header::Key& key) const
+    void Header::Set(std::string_view name, std::string_view value)
     {
-        Core::Assert(mEntries.contains(key));
-        return mEntries.at(key)[0];
+        Remove(name);
+        Add(name, value);
     }
 
 
-    std::vector<Header::Value> Header::GetAll(const Header::Key& key) const
+    void Header::Remove(HeaderName name)
     {
-        Core::Assert(mEntries.contains(key));
-        return mEntries.at(key);
+        if (mIndex[name] == NOT_PRESENT) return;
+        RemoveIf([&](const Entry& entry) { return entry.wellKnown == name; });
     }
 
 
-    bool Header::Contains(const Header::Key& key) const
+    void Header::Remove(std::string_view name)
     {
-        return mEntries.contains(key);
+        if (auto wellKnown = HeaderName::Parse(name))
+        {
+            Remove(*wellKnown);
+            return;
+        }
+
+        RemoveIf([&](const Entry& entry) { return Matches(entry, name); });
+    }
+
+
+    void Header::Clear()
+    {
+        mStrings.clear();
+        mEntries.clear();
+        mIndex = MakeEmptyIndex();
+    }
+
+
+    std::string_view Header::Get(HeaderName name) const
+    {
+        auto value = Find(name);
+        Core::Assert(value.HasValue());
+        return *value;
+    }
+
+
+    std::string_view Header::Get(std::string_view name) const
+    {
+        auto value = Find(name);
+        Core::Assert(value.HasValue());
+        return *value;
+    }
+
+
+    std::vector<std::string_view> Header::GetAll(HeaderName name) const
+    {
+        std::vector<std::string_view> values;
+        for (size_t i = FindIndex(name); i < mEntries.size(); i++)
+        {
+            if (mEntries[i].wellKnown == name) values.push_back(GetField(i).value);
+        }
+
+        return values;
+    }
+
+
+    std::vector<std::string_view> Header::GetAll(std::string_view name) const
+    {
+        if (auto wellKnown = HeaderName::Parse(name)) return GetAll(*wellKnown);
+
+        std::vector<std::string_view> values;
+        for (size_t i = FindIndex(name); i < mEntries.size(); i++)
+        {
+            if (Matches(mEntries[i], name)) values.push_back(GetField(i).value);
+        }
+
+        return values;
+    }
+
+
+    bool Header::Contains(HeaderName name) const
+    {
+        return mIndex[name] != NOT_PRESENT;
+    }
+
+
+    bool Header::Contains(std::string_view name) const
+    {
+        return FindIndex(name) < mEntries.size();
+    }
+
+
+    Core::Optional<std::string_view> Header::Find(HeaderName name) const
+    {
+        const size_t index = FindIndex(name);
+        if (index == mEntries.size()) return {};
+        return GetField(index).value;
+    }
+
+
+    Core::Optional<std::string_view> Header::Find(std::string_view name) const
+    {
+        const size_t index = FindIndex(name);
+        if (index == mEntries.size()) return {};
+        return GetField(index).value;
+    }
+
+
+    bool Header::ContainsToken(HeaderName name, std::string_view token) const
+    {
+        for (size_t i = FindIndex(name); i < mEntries.size(); i++)
+        {
+            if (mEntries[i].wellKnown == name && ContainsTokenIn(GetField(i).value, token)) return true;
+        }
+
+        return false;
+    }
+
+
+    bool Header::ContainsToken(std::string_view name, std::string_view token) const
+    {
+        if (auto wellKnown = HeaderName::Parse(name)) return ContainsToken(*wellKnown, token);
+
+        for (size_t i = FindIndex(name); i < mEntries.size(); i++)
+        {
+            if (Matches(mEntries[i], name) && ContainsTokenIn(GetField(i).value, token)) return true;
+        }
+
+        return false;
+    }
+
+
+    Header::Field Header::GetField(size_t index) const
+    {
+        const auto&      entry = mEntries[index];
+        std::string_view strings(mStrings);
+
+        Field field;
+        field.value = strings.substr(entry.valueOffset, entry.valueLength);
+        if (entry.wellKnown == UNKNOWN)
+        {
+            field.name = strings.substr(entry.nameOffset, entry.nameLength);
+        }
+        else
+        {
+            field.wellKnown = static_cast<HeaderName::_Enum>(entry.wellKnown);
+            field.name      = field.wellKnown->ToString();
+        }
+
+        return field;
+    }
+
+
+    void Header::Append(uint8_t wellKnown, std::string_view name, std::string_view value)
+    {
+        Core::Assert(mEntries.size() < NOT_PRESENT);
+        Core::Assert(name.size() <= UINT16_MAX);
+
+        if (wellKnown != UNKNOWN && mIndex[wellKnown] == NOT_PRESENT)
+        {
+            mIndex[wellKnown] = static_cast<uint16_t>(mEntries.size());
+        }
+
+        Entry entry {};
+        entry.wellKnown  = wellKnown;
+        entry.nameOffset = static_cast<uint32_t>(mStrings.size());
+        entry.nameLength = static_cast<uint16_t>(name.size());
+        mStrings.append(name);
+        entry.valueOffset = static_cast<uint32_t>(mStrings.size());
+        entry.valueLength = static_cast<uint32_t>(value.size());
+        mStrings.append(value);
+        mEntries.push_back(entry);
+    }
+
+
+    size_t Header::FindIndex(HeaderName name) const
+    {
+        return mIndex[name] == NOT_PRESENT ? mEntries.size() : mIndex[name];
+    }
+
+
+    size_t Header::FindIndex(std::string_view name) const
+    {
+        if (auto wellKnown = HeaderName::Parse(name)) return FindIndex(*wellKnown);
+
+        for (size_t i = 0; i < mEntries.size(); i++)
+        {
+            if (Matches(mEntries[i], name)) return i;
+        }
+
+        return mEntries.size();
+    }
+
+
+    bool Header::Matches(const Entry& entry, std::string_view name) const
+    {
+        return entry.wellKnown == UNKNOWN && EqualsIgnoreCase(std::string_view(mStrings).substr(entry.nameOffset, entry.nameLength), name);
+    }
+
+
+    template<typename F>
+    void Header::RemoveIf(F predicate)
+    {
+        // The strings of removed fields are left in place, and freed by Clear() or when the header is destroyed.
+        std::erase_if(mEntries, predicate);
+
+        mIndex = MakeEmptyIndex();
+        for (size_t i = 0; i < mEntries.size(); i++)
+        {
+            const uint8_t wellKnown = mEntries[i].wellKnown;
+            if (wellKnown != UNKNOWN && mIndex[wellKnown] == NOT_PRESENT) mIndex[wellKnown] = static_cast<uint16_t>(i);
+        }
     }
 } // namespace Strawberry::Net::HTTP
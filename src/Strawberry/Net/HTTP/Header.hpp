@@ -1,61 +1,172 @@
 #pragma once
 
 
-#include <map>
+#include "Constants.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
 #include <string>
-#include <utility>
+#include <string_view>
 #include <vector>
 
 
 namespace Strawberry::Net::HTTP
 {
+    /// The header fields of a request or response, in the order they were added.
+    ///
+    /// Names and values are stored back to back in one string, with a small entry for each field, so adding a field
+    /// rarely allocates. Names are compared case-insensitively. Well-known names are recognised with a perfect hash,
+    /// and the first field with each of them is indexed, so looking them up doesn't search or compare strings.
+    ///
+    /// Memory comes from the given resource, such as an arena shared by a whole exchange. Copies use the default resource.
     class Header
     {
         public:
-            using Key           = std::string;
-            using Value         = std::string;
-            using Entries       = std::map<Key, std::vector<Value> >;
-            using Iterator      = Entries::iterator;
-            using ConstIterator = Entries::const_iterator;
-
-        public:
-            void                             Add(const Key& key, const Value& value);
-            void                             Set(const Key& key, const Value& value);
-            [[nodiscard]] Value              Get(const Key& key) const;
-            [[nodiscard]] std::vector<Value> GetAll(const Key& key) const;
-            [[nodiscard]] bool               Contains(const Key& key) const;
+            struct Field
+            {
+                std::string_view           name;
+                std::string_view           value;
+                /// Which well-known name this field has, if any.
+                Core::Optional<HeaderName> wellKnown;
+            };
 
 
-            [[nodiscard]] inline ConstIterator Begin() const
+            class Iterator
             {
-                return mEntries.cbegin();
-            }
+                public:
+                    using value_type      = Field;
+                    using difference_type = std::ptrdiff_t;
+
+
+                    Iterator() = default;
+
+
+                    Iterator(const Header* header, size_t index)
+                        : mHeader(header)
+                        , mIndex(index) {}
+
+
+                    Field operator*() const
+                    {
+                        return mHeader->GetField(mIndex);
+                    }
+
+
+                    Iterator& operator++()
+                    {
+                        mIndex++;
+                        return *this;
+                    }
+
+
+                    Iterator operator++(int)
+                    {
+                        return Iterator(mHeader, mIndex++);
+                    }
+
 
+                    bool operator==(const Iterator& other) const = default;
 
-            [[nodiscard]] inline ConstIterator End() const
+                private:
+                    const Header* mHeader = nullptr;
+                    size_t        mIndex  = 0;
+            };
+
+        public:
+            explicit Header(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+
+            void                                          Add(HeaderName name, std::string_view value);
+            void                                          Add(std::string_view name, std::string_view value);
+            /// Replaces any fields with the name with a single one.
+            void                                          Set(HeaderName name, std::string_view value);
+            void                                          Set(std::string_view name, std::string_view value);
+            /// Removes every field with the name.
+            void                                          Remove(HeaderName name);
+            void                                          Remove(std::string_view name);
+            void                                          Clear();
+
+            /// Returns the first value of the field, which must be present.
+            [[nodiscard]] std::string_view                Get(HeaderName name) const;
+            [[nodiscard]] std::string_view                Get(std::string_view name) const;
+            [[nodiscard]] std::vector<std::string_view>   GetAll(HeaderName name) const;
+            [[nodiscard]] std::vector<std::string_view>   GetAll(std::string_view name) const;
+            [[nodiscard]] bool                            Contains(HeaderName name) const;
+            [[nodiscard]] bool                            Contains(std::string_view name) const;
+            /// Returns the first value of the field, if it is present.
+            [[nodiscard]] Core::Optional<std::string_view> Find(HeaderName name) const;
+            [[nodiscard]] Core::Optional<std::string_view> Find(std::string_view name) const;
+            /// Returns whether any comma separated value of the field contains the given token,
+            /// such as "close" in "Connection: Upgrade, close". Tokens are compared case-insensitively.
+            [[nodiscard]] bool                            ContainsToken(HeaderName name, std::string_view token) const;
+            [[nodiscard]] bool                            ContainsToken(std::string_view name, std::string_view token) const;
+
+
+            [[nodiscard]] size_t Size() const
             {
-                return mEntries.cend();
+                return mEntries.size();
             }
 
 
-            inline Iterator begin()
+            [[nodiscard]] bool Empty() const
             {
-                return mEntries.begin();
+                return mEntries.empty();
             }
 
 
-            inline Iterator end()
+            [[nodiscard]] Field GetField(size_t index) const;
+
+
+            [[nodiscard]] Iterator begin() const
             {
-                return mEntries.end();
+                return {this, 0};
             }
 
 
-            inline const Entries& operator*() const
+            [[nodiscard]] Iterator end() const
             {
-                return mEntries;
+                return {this, mEntries.size()};
             }
 
         private:
-            Entries mEntries;
+            /// Marks fields without a well-known name, and well-known names with no field in the index.
+            static constexpr uint8_t  UNKNOWN     = 0xFF;
+            static constexpr uint16_t NOT_PRESENT = 0xFFFF;
+
+
+            /// Where a field's name and value are in mStrings. Well-known names aren't stored.
+            struct Entry
+            {
+                uint32_t nameOffset;
+                uint32_t valueOffset;
+                uint32_t valueLength;
+                uint16_t nameLength;
+                uint8_t  wellKnown;
+            };
+
+
+            void                        Append(uint8_t wellKnown, std::string_view name, std::string_view value);
+            /// Returns the index of the first field with the name, or Size() if there isn't one.
+            [[nodiscard]] size_t        FindIndex(HeaderName name) const;
+            [[nodiscard]] size_t        FindIndex(std::string_view name) const;
+            [[nodiscard]] bool          Matches(const Entry& entry, std::string_view name) const;
+            /// Removes the fields for which the predicate is true, and rebuilds the index.
+            template<typename F>
+            void                        RemoveIf(F predicate);
+
+
+            std::pmr::string                            mStrings;
+            std::pmr::vector<Entry>                     mEntries;
+            std::array<uint16_t, HeaderName::COUNT>     mIndex = MakeEmptyIndex();
+
+
+            static constexpr std::array<uint16_t, HeaderName::COUNT> MakeEmptyIndex()
+            {
+                std::array<uint16_t, HeaderName::COUNT> index {};
+                index.fill(NOT_PRESENT);
+                return index;
+            }
     };
 } // namespace Strawberry::Net::HTTP
@@ -5,8 +5,9 @@
 
 namespace Strawberry::Net::HTTP
 {
-    Request::Request(Verb verb, std::string uri, Version version)
+    Request::Request(Verb verb, std::string_view uri, Version version, std::pmr::memory_resource* resource)
         : mVerb(verb)
-        , mURI(std::move(uri))
-        , mVersion(version) {}
+        , mURI(uri, resource)
+        , mVersion(version)
+        , mHeader(resource) {}
 } // namespace Strawberry::Net::HTTP
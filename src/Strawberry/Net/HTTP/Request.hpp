@@ -4,7 +4,10 @@
 #include "Constants.hpp"
 #include "Header.hpp"
 #include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <utility>
 
 
 namespace Strawberry::Net::HTTP
@@ -12,7 +15,9 @@ namespace Strawberry::Net::HTTP
     class Request
     {
         public:
-            Request(Verb verb, std::string uri, Version version = Version::VERSION_1_1);
+            /// The URI and header fields are allocated from the resource, which has to outlive the request.
+            Request(Verb verb, std::string_view uri, Version version = Version::VERSION_1_1,
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 
             [[nodiscard]] inline const Verb& GetVerb() const
@@ -21,7 +26,7 @@ namespace Strawberry::Net::HTTP
             }
 
 
-            [[nodiscard]] inline const std::string& GetURI() const
+            [[nodiscard]] inline std::string_view GetURI() const
             {
                 return mURI;
             }
@@ -51,14 +56,14 @@ namespace Strawberry::Net::HTTP
             }
 
 
-            inline void SetPayload(const Core::IO::DynamicByteBuffer& payload)
+            inline void SetPayload(Core::IO::DynamicByteBuffer payload)
             {
-                mPayload = payload;
+                mPayload = std::move(payload);
             }
 
         private:
             Verb                        mVerb;
-            std::string                 mURI;
+            std::pmr::string            mURI;
             Version                     mVersion;
             Header                      mHeader;
             Core::IO::DynamicByteBuffer mPayload;
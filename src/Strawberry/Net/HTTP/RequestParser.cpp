@@ -0,0 +1,356 @@
+#include "Strawberry/Net/HTTP/RequestParser.hpp"
+
+
+#include "Strawberry/Net/HTTP/Scanner.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+
+namespace Strawberry::Net::HTTP
+{
+    static bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+    {
+        auto lowercase = [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; };
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [&](char x, char y)
+        {
+            return lowercase(x) == lowercase(y);
+        });
+    }
+
+
+    static std::string_view TrimWhitespace(std::string_view string)
+    {
+        while (!string.empty() && (string.front() == ' ' || string.front() == '\t')) string.remove_prefix(1);
+        while (!string.empty() && (string.back() == ' ' || string.back() == '\t')) string.remove_suffix(1);
+        return string;
+    }
+
+
+    /// Removes the carriage return from the end of a line, if it has one.
+    static std::string_view TrimCarriageReturn(std::string_view line)
+    {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        return line;
+    }
+
+
+    Core::Optional<std::string_view> RequestView::Find(std::string_view name) const
+    {
+        for (const auto& field : headers)
+        {
+            if (EqualsIgnoreCase(field.name, name)) return field.value;
+        }
+
+        return {};
+    }
+
+
+    bool RequestView::ContainsToken(std::string_view name, std::string_view token) const
+    {
+        for (const auto& field : headers)
+        {
+            if (!EqualsIgnoreCase(field.name, name)) continue;
+
+            std::string_view list = field.value;
+            while (!list.empty())
+            {
+                auto comma = list.find(',');
+                if (EqualsIgnoreCase(TrimWhitespace(list.substr(0, comma)), token)) return true;
+                if (comma == std::string_view::npos) break;
+                list.remove_prefix(comma + 1);
+            }
+        }
+
+        return false;
+    }
+
+
+    bool RequestView::IsKeepAlive() const
+    {
+        // HTTP/1.0 clients have to opt in to persistent connections.
+        if (ContainsToken("Connection", "close")) return false;
+        return version != Version::VERSION_1_0 || ContainsToken("Connection", "keep-alive");
+    }
+
+
+    RequestParser::RequestParser(RequestLimits limits)
+        : mLimits(limits) {}
+
+
+    Core::Result<RequestView, Error> RequestParser::Parse(std::span<uint8_t> input, size_t& consumed)
+    {
+        consumed = 0;
+        std::string_view text(reinterpret_cast<const char*>(input.data()), input.size());
+
+        if (mHeadEnd == 0)
+        {
+            // Empty lines before the request line are ignored (RFC 9112 section 2.2).
+            if (mHeadScanned <= mHeadStart)
+            {
+                while (mHeadStart < text.size() && (text[mHeadStart] == '\r' || text[mHeadStart] == '\n')) mHeadStart++;
+                mHeadScanned = mHeadStart;
+            }
+
+            auto headEnd = FindHeadEnd(text);
+            if (!headEnd)
+            {
+                if (text.size() - mHeadStart > mLimits.maxHeadSize) return Fail(431);
+                return Error(ErrorNoData {});
+            }
+            if (*headEnd - mHeadStart > mLimits.maxHeadSize)
+            {
+                return Fail(431);
+            }
+            mHeadEnd = *headEnd;
+        }
+
+        // The head is parsed again each time the body is still incomplete, since the buffer may have moved.
+        RequestView request;
+        if (auto headResult = ParseHead(text.substr(mHeadStart, mHeadEnd - mHeadStart), request); !headResult)
+        {
+            return headResult.Err();
+        }
+        request.headers = mFields;
+
+        Core::Optional<size_t> contentLength;
+        size_t                 transferEncodings = 0;
+        for (const auto& [name, value] : mFields)
+        {
+            if (EqualsIgnoreCase(name, "Transfer-Encoding"))
+            {
+                transferEncodings++;
+            }
+            else if (EqualsIgnoreCase(name, "Content-Length"))
+            {
+                size_t length = 0;
+                auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), length);
+                if (error == std::errc::result_out_of_range) return Fail(413);
+                if (error != std::errc() || end != value.data() + value.size()) return Fail(400);
+                if (contentLength && *contentLength != length) return Fail(400);
+                contentLength = length;
+            }
+        }
+
+        if (transferEncodings > 0)
+        {
+            // Messages with both are a request smuggling attempt (RFC 9112 section 6.3).
+            if (contentLength) return Fail(400);
+            // Chunked is the only transfer coding supported, and has to be the only one applied.
+            if (transferEncodings > 1 || !EqualsIgnoreCase(TrimWhitespace(*request.Find("Transfer-Encoding")), "chunked"))
+            {
+                return Fail(501);
+            }
+
+            if (mChunkPosition == 0)
+            {
+                mBodyEnd       = mHeadEnd;
+                mChunkPosition = mHeadEnd;
+            }
+
+            auto end = DecodeChunks(input);
+            if (!end)
+            {
+                return end.Err();
+            }
+
+            request.body = input.subspan(mHeadEnd, mBodyEnd - mHeadEnd);
+            consumed     = *end;
+        }
+        else
+        {
+            const size_t length = contentLength ? *contentLength : 0;
+            if (length > mLimits.maxBodySize) return Fail(413);
+            if (input.size() - mHeadEnd < length) return Error(ErrorNoData {});
+
+            request.body = input.subspan(mHeadEnd, length);
+            consumed     = mHeadEnd + length;
+        }
+
+        Reset();
+        return request;
+    }
+
+
+    Core::Optional<size_t> RequestParser::FindHeadEnd(std::string_view input)
+    {
+        size_t position = mHeadScanned;
+        while (true)
+        {
+            const size_t lineFeed = position + Scanner::LINE_FEED.Find(input.substr(position));
+            if (lineFeed >= input.size())
+            {
+                mHeadScanned = input.size();
+                return {};
+            }
+
+            // The head ends with an empty line, so look for a line feed followed by another, perhaps after a carriage return.
+            const auto after = input.substr(lineFeed + 1);
+            if (after.starts_with('\n')) return lineFeed + 2;
+            if (after.starts_with("\r\n")) return lineFeed + 3;
+            if (after.empty() || after == "\r")
+            {
+                // Come back to this line feed once there's enough input to tell.
+                mHeadScanned = lineFeed;
+                return {};
+            }
+
+            position = lineFeed + 1;
+        }
+    }
+
+
+    Core::Result<void, Error> RequestParser::ParseHead(std::string_view head, RequestView& request)
+    {
+        mFields.clear();
+
+        // The request line is method, target and version, separated by single spaces.
+        const size_t     lineEnd     = head.find('\n');
+        std::string_view requestLine = TrimCarriageReturn(head.substr(0, lineEnd));
+
+        const size_t methodEnd = requestLine.find(' ');
+        if (methodEnd == 0 || methodEnd == std::string_view::npos) return Fail(400);
+        request.method = requestLine.substr(0, methodEnd);
+        if (Scanner::NAME_DELIMITERS.Find(request.method) != request.method.size()) return Fail(400);
+
+        const size_t targetEnd = requestLine.find(' ', methodEnd + 1);
+        if (targetEnd == std::string_view::npos || targetEnd == methodEnd + 1) return Fail(400);
+        request.target = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+
+        const auto version = requestLine.substr(targetEnd + 1);
+        if (version == "HTTP/1.1") request.version = Version::VERSION_1_1;
+        else if (version == "HTTP/1.0") request.version = Version::VERSION_1_0;
+        else if (version.starts_with("HTTP/")) return Fail(505);
+        else return Fail(400);
+
+        size_t position = lineEnd + 1;
+        while (true)
+        {
+            const auto rest = head.substr(position);
+            if (rest.starts_with('\n') || rest.starts_with("\r\n")) break;
+
+            // Names run up to the colon. Anything else, including the whitespace of obsolete line folding, is malformed.
+            const size_t nameLength = Scanner::NAME_DELIMITERS.Find(rest);
+            if (nameLength == 0 || nameLength >= rest.size() || rest[nameLength] != ':') return Fail(400);
+
+            const size_t valueStart = nameLength + 1;
+            const size_t valueEnd   = valueStart + Scanner::VALUE_DELIMITERS.Find(rest.substr(valueStart));
+
+            size_t lineLength;
+            if (valueEnd < rest.size() && rest[valueEnd] == '\n') lineLength = valueEnd + 1;
+            else if (rest.substr(valueEnd).starts_with("\r\n")) lineLength = valueEnd + 2;
+            else return Fail(400);
+
+            if (mFields.size() == mLimits.maxHeaderCount) return Fail(431);
+            mFields.push_back({rest.substr(0, nameLength), TrimWhitespace(rest.substr(valueStart, valueEnd - valueStart))});
+            position += lineLength;
+        }
+
+        return Core::Success;
+    }
+
+
+    Core::Result<size_t, Error> RequestParser::DecodeChunks(std::span<uint8_t> input)
+    {
+        std::string_view text(reinterpret_cast<const char*>(input.data()), input.size());
+
+        while (true)
+        {
+            switch (mChunkState)
+            {
+                case ChunkState::Size:
+                case ChunkState::Trailers:
+                {
+                    const auto   remaining = text.substr(mChunkPosition);
+                    const size_t lineEnd   = Scanner::LINE_FEED.Find(remaining);
+                    if (lineEnd == remaining.size())
+                    {
+                        if (remaining.size() > mLimits.maxHeadSize) return Fail(400);
+                        return Error(ErrorNoData {});
+                    }
+
+                    const auto line = TrimCarriageReturn(remaining.substr(0, lineEnd));
+                    mChunkPosition += lineEnd + 1;
+
+                    if (mChunkState == ChunkState::Trailers)
+                    {
+                        // Trailer fields are discarded, up to the empty line which ends the body.
+                        if (line.empty()) return mChunkPosition;
+                        break;
+                    }
+
+                    // Chunk extensions after the size are ignored.
+                    size_t size = 0;
+                    auto [end, error] = std::from_chars(line.data(), line.data() + line.size(), size, 16);
+                    if (error == std::errc::result_out_of_range) return Fail(413);
+                    if (error != std::errc() || (end != line.data() + line.size() && *end != ';' && *end != ' ' && *end != '\t'))
+                    {
+                        return Fail(400);
+                    }
+                    if (size > mLimits.maxBodySize - (mBodyEnd - mHeadEnd)) return Fail(413);
+
+                    mChunkRemaining = size;
+                    mChunkState     = size == 0 ? ChunkState::Trailers : ChunkState::Data;
+                    break;
+                }
+
+                case ChunkState::Data:
+                {
+                    // Data is moved down over the framing before it, so the body ends up contiguous.
+                    const size_t count = std::min(mChunkRemaining, input.size() - mChunkPosition);
+                    if (mBodyEnd != mChunkPosition) std::memmove(input.data() + mBodyEnd, input.data() + mChunkPosition, count);
+                    mBodyEnd        += count;
+                    mChunkPosition  += count;
+                    mChunkRemaining -= count;
+
+                    if (mChunkRemaining > 0) return Error(ErrorNoData {});
+                    mChunkState = ChunkState::DataEnd;
+                    break;
+                }
+
+                case ChunkState::DataEnd:
+                {
+                    const auto remaining = text.substr(mChunkPosition);
+                    if (remaining.starts_with('\n')) mChunkPosition += 1;
+                    else if (remaining.starts_with("\r\n")) mChunkPosition += 2;
+                    else if (remaining.empty() || remaining == "\r") return Error(ErrorNoData {});
+                    else return Fail(400);
+
+                    mChunkState = ChunkState::Size;
+                    break;
+                }
+            }
+        }
+    }
+
+
+    Error RequestParser::Fail(unsigned int status)
+    {
+        mErrorStatus = status;
+        Reset();
+
+        switch (status)
+        {
+            case 413:
+            case 431:
+                return ErrorMessageSize {};
+            case 501:
+            case 505:
+                return ErrorNotSupported {};
+            default:
+                return ErrorProtocolError {};
+        }
+    }
+
+
+    void RequestParser::Reset()
+    {
+        mHeadScanned    = 0;
+        mHeadStart      = 0;
+        mHeadEnd        = 0;
+        mBodyEnd        = 0;
+        mChunkPosition  = 0;
+        mChunkRemaining = 0;
+        mChunkState     = ChunkState::Size;
+    }
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,115 @@
+#pragma once
+
+
+#include "Constants.hpp"
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+
+namespace Strawberry::Net::HTTP
+{
+    /// A request parsed in place, whose views point into the buffer it was parsed from.
+    struct RequestView
+    {
+        struct Field
+        {
+            std::string_view name;
+            std::string_view value;
+        };
+
+
+        std::string_view         method;
+        std::string_view         target;
+        Version                  version = Version::VERSION_1_1;
+        std::span<const Field>   headers;
+        /// The body, with any chunked encoding removed.
+        std::span<const uint8_t> body;
+
+
+        /// Returns the first value of the field, comparing names case-insensitively.
+        [[nodiscard]] Core::Optional<std::string_view> Find(std::string_view name) const;
+        /// Returns whether any comma separated value of the field contains the given token, case-insensitively.
+        [[nodiscard]] bool                             ContainsToken(std::string_view name, std::string_view token) const;
+        /// Returns whether the client will send another request on the connection after this one.
+        [[nodiscard]] bool                             IsKeepAlive() const;
+    };
+
+
+    /// Limits on the size of requests, beyond which they are rejected.
+    struct RequestLimits
+    {
+        /// The longest request line and header fields, together.
+        size_t maxHeadSize    = 64 * 1024;
+        size_t maxHeaderCount = 100;
+        size_t maxBodySize    = 16 * 1024 * 1024;
+    };
+
+
+    /// Parses HTTP/1.1 requests in place, without copying them.
+    ///
+    /// Requests are parsed from the start of a connection's receive buffer once they have fully arrived.
+    /// Partial requests are scanned incrementally, so the buffer should only grow between calls until a request
+    /// has been parsed. Chunked bodies are decoded within the buffer, by moving their data over the chunk framing.
+    class RequestParser
+    {
+        public:
+            explicit RequestParser(RequestLimits limits = {});
+
+
+            /// Parses the request at the start of input, and sets consumed to the number of bytes it used.
+            /// Views in the request point into input, and are valid until the next call.
+            ///
+            /// Returns ErrorNoData if the whole request hasn't arrived yet. Other errors leave the connection
+            /// unusable, and GetErrorStatus() gives the status to respond with.
+            Core::Result<RequestView, Error> Parse(std::span<uint8_t> input, size_t& consumed);
+
+
+            /// Returns the HTTP status which describes the last error: 400, 413, 431, 501 or 505.
+            [[nodiscard]] unsigned int GetErrorStatus() const
+            {
+                return mErrorStatus;
+            }
+
+        private:
+            /// Finds the end of the request line and header fields, resuming where the last search stopped.
+            [[nodiscard]] Core::Optional<size_t> FindHeadEnd(std::string_view input);
+            Core::Result<void, Error>            ParseHead(std::string_view head, RequestView& request);
+            /// Decodes as much of a chunked body as has arrived. Returns the end of the body once it is complete.
+            Core::Result<size_t, Error>          DecodeChunks(std::span<uint8_t> input);
+            Error                                Fail(unsigned int status);
+            /// Forgets the state of a partially received request.
+            void                                 Reset();
+
+
+            enum class ChunkState
+            {
+                Size,
+                Data,
+                DataEnd,
+                Trailers,
+            };
+
+
+            RequestLimits                   mLimits;
+            std::vector<RequestView::Field> mFields;
+            unsigned int                    mErrorStatus = 0;
+
+            /// Bytes which were searched for the end of the head without finding it.
+            size_t                          mHeadScanned = 0;
+            /// Bytes before the request line, which are empty lines left over from an earlier request.
+            size_t                          mHeadStart   = 0;
+            size_t                          mHeadEnd     = 0;
+
+            /// Position of the end of the decoded chunked body, and of the next chunk framing to decode.
+            size_t                          mBodyEnd        = 0;
+            size_t                          mChunkPosition  = 0;
+            size_t                          mChunkRemaining = 0;
+            ChunkState                      mChunkState     = ChunkState::Size;
+    };
+} // namespace Strawberry::Net::HTTP
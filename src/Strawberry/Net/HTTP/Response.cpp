@@ -5,8 +5,9 @@
 
 namespace Strawberry::Net::HTTP
 {
-    Response::Response(Version mVersion, unsigned int mStatus, std::string mStatusText)
-        : mVersion(mVersion)
-        , mStatus(mStatus)
-        , mStatusText(std::move(mStatusText)) {}
+    Response::Response(Version version, unsigned int status, std::string_view statusText, std::pmr::memory_resource* resource)
+        : mVersion(version)
+        , mStatus(status)
+        , mStatusText(statusText, resource)
+        , mHeader(resource) {}
 } // namespace Strawberry::Net::HTTP
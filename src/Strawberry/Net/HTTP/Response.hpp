@@ -4,6 +4,10 @@
 #include "Constants.hpp"
 #include "Header.hpp"
 #include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
 
 
 namespace Strawberry::Net::HTTP
@@ -11,7 +15,9 @@ namespace Strawberry::Net::HTTP
     class Response
     {
         public:
-            Response(Version mVersion, unsigned int mStatus, std::string mStatusText);
+            /// The status text and header fields are allocated from the resource, which has to outlive the response.
+            Response(Version version, unsigned int status, std::string_view statusText,
+                     std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 
             [[nodiscard]] const Version& GetVersion() const
@@ -26,7 +32,7 @@ namespace Strawberry::Net::HTTP
             }
 
 
-            [[nodiscard]] const std::string& GetStatusText() const
+            [[nodiscard]] std::string_view GetStatusText() const
             {
                 return mStatusText;
             }
@@ -50,15 +56,21 @@ namespace Strawberry::Net::HTTP
             }
 
 
-			void SetPayload(const Core::IO::DynamicByteBuffer& payload)
+            Core::IO::DynamicByteBuffer& GetPayload()
             {
-                mPayload = payload;
+                return mPayload;
+            }
+
+
+			void SetPayload(Core::IO::DynamicByteBuffer payload)
+            {
+                mPayload = std::move(payload);
             }
 
         private:
             Version                     mVersion;
             unsigned int                mStatus;
-            std::string                 mStatusText;
+            std::pmr::string            mStatusText;
             Header                      mHeader;
             Core::IO::DynamicByteBuffer mPayload;
     };
@@ -0,0 +1,401 @@
+#include "Strawberry/Net/HTTP/ResponseParser.hpp"
+
+
+#include "Strawberry/Net/HTTP/Scanner.hpp"
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/Logging.hpp"
+#include <algorithm>
+#include <limits>
+
+
+namespace Strawberry::Net::HTTP
+{
+    static char ToLowercase(char c)
+    {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+
+    static bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+    {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+        {
+            return ToLowercase(x) == ToLowercase(y);
+        });
+    }
+
+
+    static std::string_view TrimWhitespace(std::string_view string)
+    {
+        while (!string.empty() && (string.front() == ' ' || string.front() == '\t')) string.remove_prefix(1);
+        while (!string.empty() && (string.back() == ' ' || string.back() == '\t')) string.remove_suffix(1);
+        return string;
+    }
+
+
+    /// Parses an unsigned integer in the given base, rejecting empty strings, stray characters and overflow.
+    static Core::Optional<size_t> ParseUnsigned(std::string_view digits, unsigned int base)
+    {
+        if (digits.empty()) return {};
+
+        size_t value = 0;
+        for (char c : digits)
+        {
+            unsigned int digit;
+            if (c >= '0' && c <= '9') digit = c - '0';
+            else if (base == 16 && c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else if (base == 16 && c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+            else return {};
+
+            if (value > (std::numeric_limits<size_t>::max() - digit) / base) return {};
+            value = value * base + digit;
+        }
+
+        return value;
+    }
+
+
+    /// Calls the given function with each element of a comma separated list, trimmed of whitespace.
+    template<typename F>
+    static void ForEachListElement(std::string_view list, F&& function)
+    {
+        while (!list.empty())
+        {
+            auto comma = list.find(',');
+            if (auto element = TrimWhitespace(list.substr(0, comma)); !element.empty()) function(element);
+            if (comma == std::string_view::npos) break;
+            list.remove_prefix(comma + 1);
+        }
+    }
+
+
+    void ResponseParser::Reset(bool headRequest)
+    {
+        *this        = ResponseParser();
+        mHeadRequest = headRequest;
+    }
+
+
+    Core::Result<ResponseParser::Event, Error> ResponseParser::Next(std::string_view input, size_t& consumed)
+    {
+        consumed = 0;
+
+        // Framing lines don't produce events, so keep going until something does or input runs out.
+        while (true)
+        {
+            auto   remaining  = input.substr(consumed);
+            size_t lineLength = 0;
+
+            switch (mState)
+            {
+                case State::StatusLine:
+                {
+                    auto line = NextLine(remaining, lineLength);
+                    if (!line) return line.Err();
+                    consumed += lineLength;
+                    // Empty lines before the status line are ignored (RFC 9112 section 2.2).
+                    if (line->empty()) continue;
+                    return ParseStatusLine(*line);
+                }
+                case State::Header:
+                case State::Trailer:
+                {
+                    if (remaining.empty() || (remaining[0] != '\r' && remaining[0] != '\n'))
+                    {
+                        return ParseHeaderLine(remaining, consumed);
+                    }
+
+                    // A blank line ends the header block.
+                    auto line = NextLine(remaining, lineLength);
+                    if (!line) return line.Err();
+                    if (!line->empty()) return Error(ErrorProtocolError {});
+                    consumed += lineLength;
+                    if (mState == State::Header) return EndHeaders();
+                    mState = State::Complete;
+                    return Event(MessageComplete {});
+                }
+                case State::Body:
+                    return TakeBody(remaining, consumed, State::MessageEnd);
+                case State::BodyUntilClose:
+                    if (remaining.empty()) return Error(ErrorNoData {});
+                    consumed += remaining.size();
+                    return Event(BodyData {remaining});
+                case State::ChunkSize:
+                {
+                    auto line = NextLine(remaining, lineLength);
+                    if (!line) return line.Err();
+                    consumed += lineLength;
+                    if (auto result = ParseChunkSize(*line); !result) return result.Err();
+                    continue;
+                }
+                case State::ChunkData:
+                    return TakeBody(remaining, consumed, State::ChunkDataEnd);
+                case State::ChunkDataEnd:
+                {
+                    auto line = NextLine(remaining, lineLength);
+                    if (!line) return line.Err();
+                    if (!line->empty()) return Error(ErrorProtocolError {});
+                    consumed += lineLength;
+                    mState    = State::ChunkSize;
+                    continue;
+                }
+                case State::MessageEnd:
+                case State::Complete:
+                    mState = State::Complete;
+                    return Event(MessageComplete {});
+            }
+
+            Core::Unreachable();
+        }
+    }
+
+
+    Core::Result<ResponseParser::Event, Error> ResponseParser::Finish()
+    {
+        if (mState == State::BodyUntilClose || mState == State::MessageEnd || mState == State::Complete)
+        {
+            mState = State::Complete;
+            return Event(MessageComplete {});
+        }
+
+        Core::Logging::Error("HTTP connection closed before the end of the response.");
+        return Error(ErrorConnectionReset {});
+    }
+
+
+    bool ResponseParser::IsComplete() const
+    {
+        return mState == State::Complete;
+    }
+
+
+    Core::Optional<size_t> ResponseParser::GetContentLength() const
+    {
+        if (mTransferEncoding) return {};
+        return mContentLength;
+    }
+
+
+    bool ResponseParser::IsKeepAlive() const
+    {
+        // Switching protocols hands the connection over, and bodies without a length end by closing it.
+        if (mStatus == 101 || mBodyUntilClose) return false;
+        if (mConnectionClose || (mKeepAliveMax && *mKeepAliveMax == 0)) return false;
+        return mPersistent || mConnectionKeepAlive;
+    }
+
+
+    Core::Optional<size_t> ResponseParser::GetKeepAliveTimeout() const
+    {
+        return mKeepAliveTimeout;
+    }
+
+
+    Core::Optional<size_t> ResponseParser::GetKeepAliveMax() const
+    {
+        return mKeepAliveMax;
+    }
+
+
+    Core::Result<std::string_view, Error> ResponseParser::NextLine(std::string_view input, size_t& lineLength)
+    {
+        // Resume searching from where the last call on this input gave up.
+        auto start    = std::min(mScanned, input.size());
+        auto lineFeed = start + Scanner::LINE_FEED.Find(input.substr(start));
+        if (lineFeed == input.size())
+        {
+            mScanned = input.size();
+            if (input.size() > MAX_LINE_LENGTH) return Error(ErrorProtocolError {});
+            return Error(ErrorNoData {});
+        }
+
+        mScanned   = 0;
+        lineLength = lineFeed + 1;
+
+        // Lines should end with CRLF, but a bare LF is accepted (RFC 9112 section 2.2).
+        auto line = input.substr(0, lineFeed);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        return line;
+    }
+
+
+    Core::Result<ResponseParser::Event, Error> ResponseParser::NeedMoreInput(std::string_view input)
+    {
+        mScanned = input.size();
+        if (input.size() > MAX_LINE_LENGTH) return Error(ErrorProtocolError {});
+        return Error(ErrorNoData {});
+    }
+
+
+    Core::Result<ResponseParser::Event, Error> ResponseParser::ParseStatusLine(std::string_view line)
+    {
+        static constexpr std::string_view PREFIX = "HTTP/";
+        if (!line.starts_with(PREFIX)) return Error(ErrorProtocolError {});
+        line.remove_prefix(PREFIX.size());
+
+        auto versionEnd = line.find(' ');
+        if (versionEnd == std::string_view::npos) return Error(ErrorProtocolError {});
+        auto version = Version::Parse(line.substr(0, versionEnd));
+        if (!version) return Error(ErrorProtocolError {});
+        line.remove_prefix(versionEnd + 1);
+
+        if (line.size() < 3 || (line.size() > 3 && line[3] != ' ')) return Error(ErrorProtocolError {});
+        auto status = ParseUnsigned(line.substr(0, 3), 10);
+        if (!status || *status < 100) return Error(ErrorProtocolError {});
+
+        mStatus     = static_cast<unsigned int>(*status);
+        // HTTP/1.0 connections close after each response unless asked otherwise (RFC 9112 section 9.3).
+        mPersistent = *version != Version::VERSION_1_0;
+        mState  = State::Header;
+        return Event(StatusLine {*version, mStatus, line.size() > 4 ? line.substr(4) : std::string_view()});
+    }
+
+
+    Core::Result<ResponseParser::Event, Error> ResponseParser::ParseHeaderLine(std::string_view input, size_t& consumed)
+    {
+        // A partial line is only parsed again once its end has arrived.
+        if (mScanned > 0 && mScanned < input.size()
+            && Scanner::LINE_FEED.Find(input.substr(mScanned)) == input.size() - mScanned)
+        {
+            return NeedMoreInput(input);
+        }
+
+        // Field names are tokens, which also rejects folded lines and whitespace before the colon.
+        auto colon = Scanner::NAME_DELIMITERS.Find(input);
+        if (colon == input.size()) return NeedMoreInput(input);
+        if (colon == 0 || input[colon] != ':') return Error(ErrorProtocolError {});
+
+        // The value runs until the line ending, and mustn't contain any other control characters.
+        auto valueEnd = colon + 1 + Scanner::VALUE_DELIMITERS.Find(input.substr(colon + 1));
+        if (valueEnd == input.size()) return NeedMoreInput(input);
+
+        size_t lineLength;
+        if (input[valueEnd] == '\n')
+        {
+            lineLength = valueEnd + 1;
+        }
+        else if (input[valueEnd] == '\r')
+        {
+            if (valueEnd + 1 == input.size()) return NeedMoreInput(input);
+            if (input[valueEnd + 1] != '\n') return Error(ErrorProtocolError {});
+            lineLength = valueEnd + 2;
+        }
+        else
+        {
+            return Error(ErrorProtocolError {});
+        }
+
+        mScanned  = 0;
+        consumed += lineLength;
+
+        auto name  = input.substr(0, colon);
+        auto value = TrimWhitespace(input.substr(colon + 1, valueEnd - colon - 1));
+
+        if (mState == State::Header && EqualsIgnoreCase(name, "Content-Length"))
+        {
+            auto length = ParseUnsigned(value, 10);
+            // Repeated Content-Length fields must agree, or the body can be read in more than one way.
+            if (!length || (mContentLength && *mContentLength != *length)) return Error(ErrorProtocolError {});
+            mContentLength = *length;
+        }
+        else if (mState == State::Header && EqualsIgnoreCase(name, "Transfer-Encoding"))
+        {
+            // Chunked has to be the last coding applied.
+            auto lastComma    = value.rfind(',');
+            mTransferEncoding = true;
+            mChunked          = EqualsIgnoreCase(TrimWhitespace(lastComma == std::string_view::npos ? value : value.substr(lastComma + 1)), "chunked");
+        }
+        else if (mState == State::Header && EqualsIgnoreCase(name, "Connection"))
+        {
+            ParseConnection(value);
+        }
+        else if (mState == State::Header && EqualsIgnoreCase(name, "Keep-Alive"))
+        {
+            ParseKeepAlive(value);
+        }
+
+        return Event(HeaderField {name, value});
+    }
+
+
+    Core::Result<void, Error> ResponseParser::ParseChunkSize(std::string_view line)
+    {
+        // Chunk extensions are ignored.
+        auto size = ParseUnsigned(TrimWhitespace(line.substr(0, line.find(';'))), 16);
+        if (!size) return ErrorProtocolError {};
+
+        // The last chunk is empty, and followed by optional trailer fields.
+        mRemaining = *size;
+        mState     = mRemaining > 0 ? State::ChunkData : State::Trailer;
+        return Core::Success;
+    }
+
+
+    void ResponseParser::ParseConnection(std::string_view value)
+    {
+        ForEachListElement(value, [this](std::string_view option)
+        {
+            if (EqualsIgnoreCase(option, "close")) mConnectionClose = true;
+            else if (EqualsIgnoreCase(option, "keep-alive")) mConnectionKeepAlive = true;
+        });
+    }
+
+
+    void ResponseParser::ParseKeepAlive(std::string_view value)
+    {
+        // Parameters look like "timeout=5, max=100". Malformed ones are ignored, since they're only hints.
+        ForEachListElement(value, [this](std::string_view parameter)
+        {
+            auto equals = parameter.find('=');
+            if (equals == std::string_view::npos) return;
+
+            auto name   = TrimWhitespace(parameter.substr(0, equals));
+            auto number = ParseUnsigned(TrimWhitespace(parameter.substr(equals + 1)), 10);
+            if (!number) return;
+
+            if (EqualsIgnoreCase(name, "timeout")) mKeepAliveTimeout = *number;
+            else if (EqualsIgnoreCase(name, "max")) mKeepAliveMax = *number;
+        });
+    }
+
+
+    ResponseParser::Event ResponseParser::EndHeaders()
+    {
+        // Informational, No Content and Not Modified responses, and responses to HEAD, never have a body.
+        bool bodyless = mHeadRequest || (mStatus >= 100 && mStatus < 200) || mStatus == 204 || mStatus == 304;
+
+        if (bodyless)
+        {
+            mState = State::MessageEnd;
+        }
+        else if (mChunked)
+        {
+            mState = State::ChunkSize;
+        }
+        // Transfer-Encoding overrides Content-Length, and without chunked last, the body runs until the connection closes.
+        else if (mContentLength && !mTransferEncoding)
+        {
+            mRemaining = *mContentLength;
+            mState     = mRemaining > 0 ? State::Body : State::MessageEnd;
+        }
+        else
+        {
+            mState          = State::BodyUntilClose;
+            mBodyUntilClose = true;
+        }
+
+        return HeadersComplete {};
+    }
+
+
+    Core::Result<ResponseParser::Event, Error> ResponseParser::TakeBody(std::string_view input, size_t& consumed, State next)
+    {
+        if (input.empty()) return Error(ErrorNoData {});
+
+        auto length = std::min(mRemaining, input.size());
+        consumed   += length;
+        mRemaining -= length;
+        if (mRemaining == 0) mState = next;
+        return Event(BodyData {input.substr(0, length)});
+    }
+} // namespace Strawberry::Net::HTTP
@@ -0,0 +1,141 @@
+#pragma once
+
+
+#include "Constants.hpp"
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+#include "Strawberry/Core/Types/Variant.hpp"
+#include <cstddef>
+#include <string_view>
+
+
+namespace Strawberry::Net::HTTP
+{
+    /// An incremental HTTP/1.1 response parser.
+    ///
+    /// The parser doesn't copy or buffer input. Each call to Next() parses one element from the start of the
+    /// given input, and returns views into that input. When the input doesn't yet hold a whole element,
+    /// Next() returns ErrorNoData, and should be called again with the unconsumed input plus whatever arrives next.
+    class ResponseParser
+    {
+        public:
+            /// The longest status, header or chunk size line which will be accepted.
+            static constexpr size_t MAX_LINE_LENGTH = 64 * 1024;
+
+
+            struct StatusLine
+            {
+                Version          version;
+                unsigned int     status;
+                std::string_view reason;
+            };
+
+
+            /// A header field, or a trailer field after a chunked body.
+            struct HeaderField
+            {
+                std::string_view name;
+                std::string_view value;
+            };
+
+
+            struct HeadersComplete {};
+
+
+            /// Part of the body, with any chunked encoding removed.
+            struct BodyData
+            {
+                std::string_view data;
+            };
+
+
+            struct MessageComplete {};
+
+
+            using Event = Core::Variant<StatusLine, HeaderField, HeadersComplete, BodyData, MessageComplete>;
+
+        public:
+            /// Prepares to parse a new response. Responses to HEAD requests have no body,
+            /// whatever their headers say.
+            void Reset(bool headRequest = false);
+
+
+            /// Parses the next element from the start of input, and sets consumed to the number of bytes it used.
+            /// The caller should discard those bytes before the next call, even when an error is returned,
+            /// since framing such as chunk sizes is consumed without producing an event.
+            /// Views in the returned event point into input, and so are only valid until then.
+            ///
+            /// Returns ErrorNoData if more input is needed, or ErrorProtocolError if the response is malformed.
+            Core::Result<Event, Error> Next(std::string_view input, size_t& consumed);
+            /// Signals that the connection closed, which ends bodies with no length.
+            /// Returns MessageComplete if that was a valid end of the response.
+            Core::Result<Event, Error> Finish();
+
+
+            /// Returns whether the whole response has been parsed.
+            [[nodiscard]] bool IsComplete() const;
+            /// Returns the body length given by Content-Length, once headers have been parsed.
+            [[nodiscard]] Core::Optional<size_t> GetContentLength() const;
+            /// Returns whether the connection can carry another request once this response is complete,
+            /// going by the HTTP version, the Connection header, and how the body is delimited.
+            [[nodiscard]] bool                   IsKeepAlive() const;
+            /// Returns the idle timeout in seconds from the Keep-Alive header, if the server sent one.
+            [[nodiscard]] Core::Optional<size_t> GetKeepAliveTimeout() const;
+            /// Returns how many more requests the server will accept from the Keep-Alive header, if it sent one.
+            [[nodiscard]] Core::Optional<size_t> GetKeepAliveMax() const;
+
+        private:
+            enum class State
+            {
+                StatusLine,
+                Header,
+                Body,
+                BodyUntilClose,
+                ChunkSize,
+                ChunkData,
+                ChunkDataEnd,
+                Trailer,
+                MessageEnd,
+                Complete,
+            };
+
+
+            /// Finds the next line in input, without its line ending, and the length including the line ending.
+            Core::Result<std::string_view, Error> NextLine(std::string_view input, size_t& lineLength);
+            /// Records that input holds an incomplete line.
+            Core::Result<Event, Error>            NeedMoreInput(std::string_view input);
+
+            Core::Result<Event, Error> ParseStatusLine(std::string_view line);
+            /// Parses a header line from the start of input in a single pass, finding its end along the way.
+            Core::Result<Event, Error> ParseHeaderLine(std::string_view input, size_t& consumed);
+            Core::Result<void, Error>  ParseChunkSize(std::string_view line);
+            void                       ParseConnection(std::string_view value);
+            void                       ParseKeepAlive(std::string_view value);
+            /// Decides how the body is framed, once all header fields are known.
+            Event                      EndHeaders();
+            /// Returns as much body data as is available, up to the remaining length.
+            Core::Result<Event, Error> TakeBody(std::string_view input, size_t& consumed, State next);
+
+
+            State                  mState        = State::StatusLine;
+            bool                   mHeadRequest  = false;
+            unsigned int           mStatus       = 0;
+            /// Whether the response's version makes connections persistent by default.
+            bool                   mPersistent   = true;
+            /// Whether the response has a Transfer-Encoding, in which case its Content-Length is ignored.
+            bool                   mTransferEncoding = false;
+            bool                   mChunked      = false;
+            bool                   mBodyUntilClose = false;
+            Core::Optional<size_t> mContentLength;
+            /// Body bytes left in the current chunk, or in the whole body without chunked encoding.
+            size_t                 mRemaining    = 0;
+            /// How much of the current input has already been searched for a line ending.
+            size_t                 mScanned      = 0;
+            /// Connection options, which default to those of the response's HTTP version.
+            bool                   mConnectionClose     = false;
+            bool                   mConnectionKeepAlive = false;
+            Core::Optional<size_t> mKeepAliveTimeout;
+            Core::Optional<size_t> mKeepAliveMax;
+    };
+} // namespace Strawberry::Net::HTTP
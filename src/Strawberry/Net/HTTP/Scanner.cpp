@@ -0,0 +1,219 @@
+#include "Strawberry/Net/HTTP/Scanner.hpp"
+
+
+#include "Strawberry/Core/Markers.hpp"
+#include <bit>
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define STRAWBERRY_NET_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define STRAWBERRY_NET_NEON 1
+#include <arm_neon.h>
+#endif
+
+
+// GCC and Clang need to be told which instruction sets a function may use. MSVC allows any intrinsic anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define STRAWBERRY_NET_TARGET(isa) __attribute__((target(isa)))
+#else
+#define STRAWBERRY_NET_TARGET(isa)
+#endif
+
+
+namespace Strawberry::Net::HTTP
+{
+#if STRAWBERRY_NET_X86
+    static bool SupportsSSE42()
+    {
+#if defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 1);
+        return registers[2] & (1 << 20);
+#else
+        return __builtin_cpu_supports("sse4.2");
+#endif
+    }
+
+
+    static bool SupportsAVX2()
+    {
+#if defined(_MSC_VER)
+        int registers[4];
+        __cpuid(registers, 1);
+        // The OS must also save the AVX registers on context switches.
+        bool osSavesAVX = (registers[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(registers, 7, 0);
+        return osSavesAVX && (registers[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+
+    ByteSet::Implementation ByteSet::GetBestImplementation()
+    {
+        static const Implementation best = []()
+        {
+#if STRAWBERRY_NET_X86
+            if (SupportsAVX2()) return Implementation::AVX2;
+            if (SupportsSSE42()) return Implementation::SSE42;
+#elif STRAWBERRY_NET_NEON
+            return Implementation::NEON;
+#endif
+            return Implementation::Scalar;
+        }();
+        return best;
+    }
+
+
+    size_t ByteSet::Find(const char* data, size_t length) const
+    {
+        return Find(data, length, GetBestImplementation());
+    }
+
+
+    size_t ByteSet::Find(const char* data, size_t length, Implementation implementation) const
+    {
+        switch (implementation)
+        {
+            case Implementation::Scalar: return FindScalar(data, length);
+            case Implementation::SSE42: return FindSSE42(data, length);
+            case Implementation::AVX2: return FindAVX2(data, length);
+            case Implementation::NEON: return FindNEON(data, length);
+        }
+
+        Core::Unreachable();
+    }
+
+
+    size_t ByteSet::FindScalar(const char* data, size_t length) const
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            if (mMembers[static_cast<uint8_t>(data[i])]) return i;
+        }
+        return length;
+    }
+
+
+#if STRAWBERRY_NET_X86
+    /// Returns a bit for each of the 16 bytes at data which belong to the set.
+    STRAWBERRY_NET_TARGET("sse4.2")
+    static inline unsigned MatchBlockSSE42(__m128i lowTable, __m128i highTable, const char* data)
+    {
+        const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+        __m128i       block      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i       low        = _mm_shuffle_epi8(lowTable, _mm_and_si128(block, nibbleMask));
+        __m128i       high       = _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi16(block, 4), nibbleMask));
+        // Bytes outside the set have no bits in common between their two lookups.
+        return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128()))) & 0xFFFF;
+    }
+
+
+    STRAWBERRY_NET_TARGET("sse4.2")
+    size_t ByteSet::FindSSE42(const char* data, size_t length) const
+    {
+        if (length < 16) return FindScalar(data, length);
+
+        const __m128i lowTable  = _mm_load_si128(reinterpret_cast<const __m128i*>(mLowNibbles.data()));
+        const __m128i highTable = _mm_load_si128(reinterpret_cast<const __m128i*>(mHighNibbles.data()));
+
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            if (auto matches = MatchBlockSSE42(lowTable, highTable, data + i)) return i + std::countr_zero(matches);
+        }
+
+        // Check the tail with a block which overlaps bytes already checked, and ignore those.
+        if (i < length)
+        {
+            if (auto matches = MatchBlockSSE42(lowTable, highTable, data + length - 16) >> (i - (length - 16))) return i + std::countr_zero(matches);
+        }
+
+        return length;
+    }
+
+
+    STRAWBERRY_NET_TARGET("avx2")
+    size_t ByteSet::FindAVX2(const char* data, size_t length) const
+    {
+        if (length < 16) return FindScalar(data, length);
+
+        // Shuffles look up within each 128 bit lane, so both lanes get a copy of the tables.
+        const __m128i lowTable128  = _mm_load_si128(reinterpret_cast<const __m128i*>(mLowNibbles.data()));
+        const __m128i highTable128 = _mm_load_si128(reinterpret_cast<const __m128i*>(mHighNibbles.data()));
+        const __m256i lowTable     = _mm256_broadcastsi128_si256(lowTable128);
+        const __m256i highTable    = _mm256_broadcastsi128_si256(highTable128);
+        const __m256i nibbleMask   = _mm256_set1_epi8(0x0F);
+
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32)
+        {
+            __m256i block   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i low     = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(block, nibbleMask));
+            __m256i high    = _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibbleMask));
+            auto    outside = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256())));
+            if (outside != 0xFFFFFFFF) return i + std::countr_one(outside);
+        }
+
+        // The tail is finished with 16 byte blocks. Being compiled for AVX2, these use VEX encoded instructions,
+        // since mixing in legacy SSE code with the upper halves of the AVX registers dirty is very slow on some CPUs.
+        if (i + 16 <= length)
+        {
+            if (auto matches = MatchBlockSSE42(lowTable128, highTable128, data + i)) return i + std::countr_zero(matches);
+            i += 16;
+        }
+
+        if (i < length)
+        {
+            if (auto matches = MatchBlockSSE42(lowTable128, highTable128, data + length - 16) >> (i - (length - 16))) return i + std::countr_zero(matches);
+        }
+
+        return length;
+    }
+#else
+    size_t ByteSet::FindSSE42(const char* data, size_t length) const
+    {
+        return FindScalar(data, length);
+    }
+
+
+    size_t ByteSet::FindAVX2(const char* data, size_t length) const
+    {
+        return FindScalar(data, length);
+    }
+#endif
+
+
+#if STRAWBERRY_NET_NEON
+    size_t ByteSet::FindNEON(const char* data, size_t length) const
+    {
+        const uint8x16_t lowTable   = vld1q_u8(mLowNibbles.data());
+        const uint8x16_t highTable  = vld1q_u8(mHighNibbles.data());
+        const uint8x16_t nibbleMask = vdupq_n_u8(0x0F);
+
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16)
+        {
+            uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+            uint8x16_t low   = vqtbl1q_u8(lowTable, vandq_u8(block, nibbleMask));
+            uint8x16_t high  = vqtbl1q_u8(highTable, vshrq_n_u8(block, 4));
+            uint8x16_t found = vtstq_u8(low, high);
+            // NEON has no movemask, so narrow each byte to 4 bits of a 64 bit mask.
+            uint64_t   mask  = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)), 0);
+            if (mask != 0) return i + std::countr_zero(mask) / 4;
+        }
+
+        return i + FindScalar(data + i, length - i);
+    }
+#else
+    size_t ByteSet::FindNEON(const char* data, size_t length) const
+    {
+        return FindScalar(data, length);
+    }
+#endif
+} // namespace Strawberry::Net::HTTP
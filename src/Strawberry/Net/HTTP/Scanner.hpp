@@ -0,0 +1,128 @@
+#pragma once
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+namespace Strawberry::Net::HTTP
+{
+    /// A set of bytes which can be searched for 16 or 32 bytes at a time.
+    ///
+    /// Membership is stored as a pair of nibble lookup tables, in the style of picohttpparser and simdjson:
+    /// a byte belongs to the set when the entries for its low and high nibbles share a bit. Vector shuffles
+    /// look up every byte of a block at once, using SSE4.2 or AVX2 when the CPU has them, NEON on ARM,
+    /// and a plain table lookup otherwise.
+    class ByteSet
+    {
+        public:
+            enum class Implementation
+            {
+                Scalar,
+                SSE42,
+                AVX2,
+                NEON,
+            };
+
+
+            /// Creates the set of bytes for which predicate returns true.
+            /// Fails to compile if the set is too irregular to be described by nibble tables.
+            template<typename Predicate>
+            static consteval ByteSet Of(Predicate predicate);
+
+
+            /// Returns the fastest implementation this CPU supports.
+            static Implementation GetBestImplementation();
+
+
+            [[nodiscard]] constexpr bool Contains(uint8_t byte) const
+            {
+                return mMembers[byte];
+            }
+
+
+            /// Returns the position of the first byte of data in this set, or length if there is none.
+            [[nodiscard]] size_t Find(const char* data, size_t length) const;
+            /// Returns the position of the first byte of data in this set, or its size if there is none.
+            [[nodiscard]] size_t Find(std::string_view data) const
+            {
+                return Find(data.data(), data.size());
+            }
+            /// Searches using the given implementation, which must be supported by this CPU.
+            [[nodiscard]] size_t Find(const char* data, size_t length, Implementation implementation) const;
+
+        private:
+            constexpr ByteSet() = default;
+
+
+            [[nodiscard]] size_t FindScalar(const char* data, size_t length) const;
+            [[nodiscard]] size_t FindSSE42(const char* data, size_t length) const;
+            [[nodiscard]] size_t FindAVX2(const char* data, size_t length) const;
+            [[nodiscard]] size_t FindNEON(const char* data, size_t length) const;
+
+
+            std::array<bool, 256>                mMembers{};
+            alignas(16) std::array<uint8_t, 16> mLowNibbles{};
+            alignas(16) std::array<uint8_t, 16> mHighNibbles{};
+    };
+
+
+    template<typename Predicate>
+    consteval ByteSet ByteSet::Of(Predicate predicate)
+    {
+        ByteSet set;
+        for (int byte = 0; byte < 256; byte++)
+        {
+            set.mMembers[byte] = predicate(static_cast<uint8_t>(byte));
+        }
+
+        // Group high nibbles by which low nibbles they pair with, giving each distinct group one bit.
+        std::array<uint16_t, 8> groups{};
+        size_t                  groupCount = 0;
+        for (int high = 0; high < 16; high++)
+        {
+            uint16_t lows = 0;
+            for (int low = 0; low < 16; low++)
+            {
+                if (set.mMembers[high << 4 | low]) lows |= 1 << low;
+            }
+            if (lows == 0) continue;
+
+            size_t group = 0;
+            while (group < groupCount && groups[group] != lows) group++;
+            if (group == groupCount)
+            {
+                if (groupCount == groups.size()) throw "ByteSet needs more than 8 nibble groups";
+                groups[groupCount++] = lows;
+                for (int low = 0; low < 16; low++)
+                {
+                    if (lows & (1 << low)) set.mLowNibbles[low] |= 1 << group;
+                }
+            }
+            set.mHighNibbles[high] = static_cast<uint8_t>(1 << group);
+        }
+
+        return set;
+    }
+
+
+    namespace Scanner
+    {
+        /// Characters allowed in header field names (RFC 9110 tchar).
+        constexpr bool IsTokenCharacter(uint8_t c)
+        {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+                   || std::string_view("!#$%&'*+-.^_`|~").find(static_cast<char>(c)) != std::string_view::npos;
+        }
+
+
+        /// Bytes which end a header field name, either the colon or something invalid.
+        inline constexpr ByteSet NAME_DELIMITERS = ByteSet::Of([](uint8_t c) { return !IsTokenCharacter(c); });
+        /// Bytes which end a header field value, either the line ending or a control character other than tab.
+        inline constexpr ByteSet VALUE_DELIMITERS = ByteSet::Of([](uint8_t c) { return (c < 0x20 && c != '\t') || c == 0x7F; });
+        /// Line feeds, which end status and chunk size lines.
+        inline constexpr ByteSet LINE_FEED = ByteSet::Of([](uint8_t c) { return c == '\n'; });
+    } // namespace Scanner
+} // namespace Strawberry::Net::HTTP
@@ -6,10 +6,14 @@
 //======================================================================================================================
 #include "Strawberry/Net/Socket/Types.hpp"
 #include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Core/Assert.hpp"
 // Standard Library
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
-#include <deque>
-#include <thread>
+#include <span>
+#include <vector>
 
 
 namespace Strawberry::Net::Socket
@@ -22,6 +26,11 @@ namespace Strawberry::Net::Socket
     class BufferedSocket<S>
     {
         public:
+            /// How long reads wait for the socket at a time, when no data is available.
+            static constexpr std::chrono::milliseconds WAIT_INTERVAL{100};
+
+
+
             BufferedSocket(S socket, size_t bufferSize)
                 : mCapacity(bufferSize)
                 , mSocket(std::move(socket))
@@ -32,12 +41,12 @@ namespace Strawberry::Net::Socket
             BufferedSocket& operator=(const BufferedSocket&) = delete;
 
             BufferedSocket(BufferedSocket&&) noexcept = default;
-            BufferedSocket& operator=(BufferedSocket&& buffered) = delete;
+            BufferedSocket& operator=(BufferedSocket&&) noexcept = default;
 
 
-            bool Poll() const
+            bool Poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) const
             {
-                return !mBuffer.empty() || mSocket.Poll();
+                return GetBufferedSize() > 0 || mSocket.Poll(timeout);
             }
 
 
@@ -47,21 +56,15 @@ namespace Strawberry::Net::Socket
 
                 while (bytes.Size() < size)
                 {
-                    if (mBuffer.empty())
+                    if (GetBufferedSize() == 0)
                     {
-                        if (auto refillResult = RefillBuffer(); !refillResult)
+                        if (auto fillResult = Fill(); !fillResult)
                         {
-                            if (refillResult.Err().template IsType<ErrorNoData>()) continue;
-                            return refillResult.Err();
+                            return fillResult.Err();
                         }
                     }
 
-
-                    while (!mBuffer.empty() && bytes.Size() < size)
-                    {
-                        bytes.Push(mBuffer.front());
-                        mBuffer.pop_front();
-                    }
+                    TakeBuffered(bytes, size);
 
                     if (!Poll())
                     {
@@ -79,36 +82,76 @@ namespace Strawberry::Net::Socket
 
                 while (bytes.Size() < size)
                 {
-                    if (mBuffer.empty())
+                    if (GetBufferedSize() == 0)
                     {
-                        if (auto refillResult = RefillBuffer(); !refillResult)
+                        if (auto fillResult = Fill(); !fillResult)
                         {
-                            if (refillResult.Err().template IsType<ErrorNoData>()) continue;
-                            return refillResult.Err();
+                            return fillResult.Err();
                         }
                     }
 
+                    TakeBuffered(bytes, size);
+                }
 
-                    while (!mBuffer.empty() && bytes.Size() < size)
-                    {
-                        bytes.Push(mBuffer.front());
-                        mBuffer.pop_front();
-                    }
+                return bytes;
+            }
+
+
+            StreamWriteResult Write(const Core::IO::DynamicByteBuffer& bytes)
+            {
+                return mSocket.Write(bytes);
+            }
+
+
+            StreamWriteResult Write(std::span<const uint8_t> bytes)
+            {
+                return mSocket.Write(bytes);
+            }
+
+
+            /// Returns the bytes which have been received but not yet consumed, without copying them.
+            /// The view is invalidated by any other call which reads from the socket.
+            [[nodiscard]] std::span<const uint8_t> Peek() const
+            {
+                return {mBuffer.data() + mReadPosition, GetBufferedSize()};
+            }
+
+
+            /// Discards bytes from the front of the buffer, once they have been handled after Peek().
+            void Consume(size_t count)
+            {
+                Core::Assert(count <= GetBufferedSize());
+                mReadPosition += count;
+
+                if (mReadPosition == mWritePosition)
+                {
+                    mReadPosition  = 0;
+                    mWritePosition = 0;
+                }
+            }
 
 
-                    if (bytes.Size() < size && !Poll())
+            /// Waits until more data has been received into the buffer.
+            /// Returns ErrorMessageSize if the buffer is already full.
+            Core::Result<void, Error> Fill()
+            {
+                while (true)
+                {
+                    auto refillResult = RefillBuffer();
+                    if (refillResult || !refillResult.Err().template IsType<ErrorNoData>())
                     {
-                        std::this_thread::yield();
+                        return refillResult;
                     }
-                }
 
-                return bytes;
+                    // Sleep in poll until the socket is readable, rather than spinning.
+                    (void) mSocket.Poll(WAIT_INTERVAL);
+                }
             }
 
 
-            StreamWriteResult Write(Core::IO::DynamicByteBuffer bytes)
+            [[nodiscard]] size_t GetBufferedSize() const
             {
-                return mSocket.Write(bytes);
+                return mWritePosition - mReadPosition;
             }
 
 
@@ -130,6 +173,12 @@ namespace Strawberry::Net::Socket
             }
 
 
+            [[nodiscard]] const S& GetSocket() const
+            {
+                return mSocket;
+            }
+
+
             S TakeSocket() &&
             {
                 return std::move(mSocket);
@@ -144,29 +193,59 @@ namespace Strawberry::Net::Socket
                     return ErrorNoData {};
                 }
 
-                const size_t bufferSpaceAvailable = mCapacity - mBuffer.size();
-                if (bufferSpaceAvailable > 0)
+                // Move unconsumed bytes to the front, to make room behind them.
+                if (mReadPosition > 0)
                 {
-                    if (auto readResult = mSocket.Read(bufferSpaceAvailable))
-                    {
-                        for (auto byte: readResult.Unwrap())
-                        {
-                            mBuffer.emplace_back(byte);
-                        }
-                    }
-                    else
-                    {
-                        return readResult.Err();
-                    }
+                    std::copy(mBuffer.begin() + static_cast<std::ptrdiff_t>(mReadPosition),
+                              mBuffer.begin() + static_cast<std::ptrdiff_t>(mWritePosition),
+                              mBuffer.begin());
+                    mWritePosition -= mReadPosition;
+                    mReadPosition   = 0;
                 }
 
+                if (mWritePosition >= mCapacity)
+                {
+                    return ErrorMessageSize {};
+                }
+
+                // Grow the buffer as it fills, up to the capacity. It is never shrunk,
+                // so once it is big enough, data is received straight into it without allocating.
+                if (mBuffer.size() - mWritePosition < MIN_READ_SIZE && mBuffer.size() < mCapacity)
+                {
+                    mBuffer.resize(std::min(mCapacity, std::max(mBuffer.size() * 2, mWritePosition + MIN_READ_SIZE)));
+                }
+
+                const size_t end        = std::min(mBuffer.size(), mCapacity);
+                auto         readResult = mSocket.ReadInto({mBuffer.data() + mWritePosition, end - mWritePosition});
+                if (!readResult)
+                {
+                    return readResult.Err();
+                }
+
+                mWritePosition += readResult.Unwrap();
                 return Core::Success;
             }
 
+
+            /// Moves buffered bytes into the given buffer, until it holds size bytes.
+            void TakeBuffered(Core::IO::DynamicByteBuffer& bytes, size_t size)
+            {
+                const size_t count = std::min(size - bytes.Size(), GetBufferedSize());
+                bytes.Push(mBuffer.data() + mReadPosition, count);
+                Consume(count);
+            }
+
         private:
-            size_t              mCapacity;
-            S                   mSocket;
-            std::deque<uint8_t> mBuffer;
+            /// The least room to receive into before the buffer is grown.
+            static constexpr size_t MIN_READ_SIZE = 16 * 1024;
+
+
+            size_t               mCapacity;
+            S                    mSocket;
+            /// Received bytes are those before mWritePosition, and those before mReadPosition have already been consumed.
+            std::vector<uint8_t> mBuffer;
+            size_t               mReadPosition  = 0;
+            size_t               mWritePosition = 0;
     };
 
 
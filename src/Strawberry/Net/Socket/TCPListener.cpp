@@ -17,6 +17,7 @@
 #if STRAWBERRY_TARGET_WINDOWS
 #include <ws2tcpip.h>
 #elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+#include <fcntl.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <netdb.h>
@@ -44,6 +45,12 @@ namespace Strawberry::Net::Socket
 
 
 	Core::Result<TCPListener, Error> TCPListener::Bind(const Endpoint& endpoint)
+	{
+		return Bind(endpoint, TCPListenerOptions {});
+	}
+
+
+	Core::Result<TCPListener, Error> TCPListener::Bind(const Endpoint& endpoint, const TCPListenerOptions& options)
 	{
 		Core::Logging::Info("Opening TCP Listener at {}", endpoint.ToString());
 
@@ -62,6 +69,37 @@ namespace Strawberry::Net::Socket
 		// Construct listener object.
 		TCPListener listener(socketHandle, endpoint);
 
+		if (options.reusePort)
+		{
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+			SOCKET_OPTION_TYPE reusePort = 1;
+			if (setsockopt(listener.mSocket, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char*>(&reusePort), sizeof(reusePort)) == SOCKET_ERROR_CODE)
+			{
+				Core::Logging::Error("Failed to set SO_REUSEPORT on TCP Listener for {}. Error code: {}", endpoint.ToString(), API::GetError());
+				return ErrorSocketBinding {};
+			}
+#else
+			Core::Logging::Error("TCP Listeners can't share ports on this platform.");
+			return ErrorNotSupported {};
+#endif
+		}
+
+		if (!options.blocking)
+		{
+#if STRAWBERRY_TARGET_WINDOWS
+			u_long nonBlocking = 1;
+			const bool failed = ioctlsocket(listener.mSocket, FIONBIO, &nonBlocking) == SOCKET_ERROR_CODE;
+#elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+			int flags = fcntl(listener.mSocket, F_GETFL, 0);
+			const bool failed = flags == -1 || fcntl(listener.mSocket, F_SETFL, flags | O_NONBLOCK) == -1;
+#endif
+			if (failed)
+			{
+				Core::Logging::Error("Failed to make TCP Listener for {} non-blocking. Error code: {}", endpoint.ToString(), API::GetError());
+				return ErrorSocketCreation {};
+			}
+		}
+
 		sockaddr_storage peer = endpoint.GetPlatformRepresentation();
 		socklen_t peerLen = endpoint.GetAddress().IsIPv6() ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
 
@@ -140,18 +178,28 @@ namespace Strawberry::Net::Socket
 	}
 
 
-	Core::Optional<TCPSocket> TCPListener::Accept() const noexcept
+	Core::Result<TCPSocket, Error> TCPListener::Accept() const noexcept
 	{
 		sockaddr_storage peer{};
 		socklen_t		 peerLen = sizeof(peer);
 
 		SocketHandle socketHandle = accept(mSocket, reinterpret_cast<sockaddr*>(&peer), &peerLen);
-		if (socketHandle == SOCKET_ERROR_CODE)
+		while (socketHandle == SOCKET_ERROR_CODE)
 		{
-			auto error = API::GetError();
-			switch (error)
+			switch (auto error = API::GetError())
 			{
-			default: Core::Unreachable();
+			case SOCKET_ERROR_TYPE_CODE(EWOULDBLOCK):
+				return ErrorNoData {};
+			// The connection went away before it could be accepted.
+			case SOCKET_ERROR_TYPE_CODE(ECONNABORTED):
+				return ErrorConnectionReset {};
+			case SOCKET_ERROR_TYPE_CODE(EINTR):
+				peerLen      = sizeof(peer);
+				socketHandle = accept(mSocket, reinterpret_cast<sockaddr*>(&peer), &peerLen);
+				break;
+			default:
+				Core::Logging::Error("Failed to accept connection on TCP Listener for {}. Error code: {}", mEndpoint.ToString(), error);
+				return ErrorSystem {};
 			}
 		}
 
@@ -173,7 +221,17 @@ namespace Strawberry::Net::Socket
 		Core::AssertEQ(
 			setsockopt(socketHandle, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&keepAlive), sizeof(keepAlive)),
 			0);
+#ifdef SO_NOSIGPIPE
+		SOCKET_OPTION_TYPE noSigPipe = 1;
+		Core::AssertEQ(setsockopt(socketHandle, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe)), 0);
+#endif
 
 		return TCPSocket(socketHandle, endpoint.Unwrap());
 	}
+
+
+	TCPSocket::SocketHandle TCPListener::GetHandle() const noexcept
+	{
+		return mSocket;
+	}
 }
@@ -18,6 +18,18 @@
 //----------------------------------------------------------------------------------------------------------------------
 namespace Strawberry::Net::Socket
 {
+	/// Settings for binding a TCPListener.
+	struct TCPListenerOptions
+	{
+		/// Lets several listeners bind the same endpoint, each accepting a share of its connections,
+		/// so that each thread of a server can accept on its own listener. Linux balances connections
+		/// between the listeners. Not supported on Windows.
+		bool reusePort = false;
+		/// Whether Accept() waits for a connection. Non-blocking listeners return ErrorNoData when none is waiting.
+		bool blocking  = true;
+	};
+
+
 	class TCPListener
 	{
 	private:
@@ -29,6 +41,7 @@ namespace Strawberry::Net::Socket
 
 	public:
 		static Core::Result<TCPListener, Error> Bind(const Endpoint& endpoint);
+		static Core::Result<TCPListener, Error> Bind(const Endpoint& endpoint, const TCPListenerOptions& options);
 
 
 		TCPListener(const TCPListener&) = delete;
@@ -38,7 +51,11 @@ namespace Strawberry::Net::Socket
 		~TCPListener();
 
 
-		Core::Optional<TCPSocket> Accept() const	noexcept;
+		/// Accepts the next connection. Returns ErrorNoData if a non-blocking listener has none waiting,
+		/// and ErrorConnectionReset if the connection was closed before it could be accepted.
+		Core::Result<TCPSocket, Error> Accept() const	noexcept;
+		/// Returns the platform handle of this listener, for registering with an event loop.
+		TCPSocket::SocketHandle        GetHandle() const	noexcept;
 
 	private:
 		TCPListener(SocketHandle handle, Endpoint endpoint);
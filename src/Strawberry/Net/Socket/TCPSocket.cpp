@@ -8,21 +8,40 @@
 #include "Strawberry/Core/Markers.hpp"
 #include <Strawberry/Core/IO/Logging.hpp>
 #include <sys/poll.h>
+// Standard Library
+#include <algorithm>
 // OS-Level Networking Headers
 #if STRAWBERRY_TARGET_WINDOWS
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+#include <fcntl.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif // STRAWBERRY_TARGET_WINDOWS
 
 
 namespace Strawberry::Net::Socket
 {
-	Core::Result<TCPSocket, Error> TCPSocket::Connect(const Endpoint& endpoint)
+	/// Puts a socket handle into blocking or non-blocking mode.
+	static bool SetHandleBlocking(TCPSocket::SocketHandle handle, bool blocking)
+	{
+#if STRAWBERRY_TARGET_WINDOWS
+		u_long nonBlocking = blocking ? 0 : 1;
+		return ioctlsocket(handle, FIONBIO, &nonBlocking) != SOCKET_ERROR_CODE;
+#elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		int flags = fcntl(handle, F_GETFL, 0);
+		return flags != -1 && fcntl(handle, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK) != -1;
+#endif
+	}
+
+
+	Core::Result<TCPSocket, Error> TCPSocket::Connect(const Endpoint& endpoint, bool blocking)
 	{
 		Core::Logging::Info("Connecting TCP Socket to {}", endpoint.ToString());
 
@@ -49,20 +68,35 @@ namespace Strawberry::Net::Socket
 			return ErrorSocketCreation {};
 		}
 
+		TCPSocket tcpSocket(socketHandle, endpoint);
+		if (!blocking && !SetHandleBlocking(socketHandle, false))
+		{
+			Core::Logging::Error("Failed to make TCP Socket for endpoint {} non-blocking", endpoint.ToString());
+			return ErrorSocketCreation {};
+		}
+
 		auto connection = connect(socketHandle, (const struct sockaddr*) &peer, peerLen);
 		if (connection == -1)
 		{
-			Core::Logging::Error("Failed to estabilish TCP connection to endpoint {}", endpoint.ToString());
-			return ErrorAddressResolution {};
+			auto error = API::GetError();
+			const bool inProgress = error == SOCKET_ERROR_TYPE_CODE(EINPROGRESS) || error == SOCKET_ERROR_TYPE_CODE(EWOULDBLOCK);
+			if (blocking || !inProgress)
+			{
+				Core::Logging::Error("Failed to estabilish TCP connection to endpoint {}", endpoint.ToString());
+				return ErrorAddressResolution {};
+			}
 		}
 
-		TCPSocket tcpSocket(socketHandle, endpoint);
-
 		SOCKET_OPTION_TYPE keepAlive = 1;
 		SOCKET_ERROR_CODE_TYPE optResult =
 			setsockopt(tcpSocket.mSocket, SOL_SOCKET, SO_KEEPALIVE,
 					   reinterpret_cast<const char*>(&keepAlive), sizeof(keepAlive));
 		Core::AssertEQ(optResult, 0);
+#ifdef SO_NOSIGPIPE
+		// Mac has no MSG_NOSIGNAL, so writes to a closed connection are kept from raising SIGPIPE here instead.
+		SOCKET_OPTION_TYPE noSigPipe = 1;
+		Core::AssertEQ(setsockopt(tcpSocket.mSocket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe)), 0);
+#endif
 
 
 		Core::Logging::Info("Connected TCP Socket ({}) to {}", tcpSocket.mSocket, endpoint.ToString());
@@ -78,7 +112,10 @@ namespace Strawberry::Net::Socket
 	TCPSocket::TCPSocket(TCPSocket&& other) noexcept
 		: mSocket(std::exchange(other.mSocket, -1))
 		, mEndpoint(std::move(other.mEndpoint))
-		, mBuffer(std::move(other.mBuffer)) {}
+		, mBuffer(std::move(other.mBuffer))
+		, mPartialRead(std::move(other.mPartialRead))
+		, mTimestamping(other.mTimestamping)
+		, mReceiveTimestamp(other.mReceiveTimestamp) {}
 
 
 	TCPSocket& TCPSocket::operator=(TCPSocket&& other) noexcept
@@ -109,14 +146,32 @@ namespace Strawberry::Net::Socket
 	}
 
 
-	bool TCPSocket::Poll() const
+	TCPSocket::SocketHandle TCPSocket::GetHandle() const noexcept
+	{
+		return mSocket;
+	}
+
+
+	Core::Result<void, Error> TCPSocket::SetBlocking(bool blocking)
+	{
+		if (!SetHandleBlocking(mSocket, blocking))
+		{
+			Core::Logging::Error("Failed to set blocking mode of TCP socket ({}). Error code: {}.", mSocket, API::GetError());
+			return ErrorUnknown{};
+		}
+
+		return Core::Success;
+	}
+
+
+	bool TCPSocket::Poll(std::chrono::milliseconds timeout) const
 	{
 		SOCKET_POLL_FD_TYPE fds[] = {
 			{ mSocket, POLLIN, 0}
 		};
 
-		int pollResult = SOCKET_POLL_FUNCTION(fds, 1, 0);
-		if (pollResult <= 0)
+		int pollResult = SOCKET_POLL_FUNCTION(fds, 1, static_cast<int>(std::max<std::chrono::milliseconds::rep>(timeout.count(), -1)));
+		if (pollResult < 0)
 		{
 			Core::Logging::Error("Error when polling TCP socket! Error code: {}", API::GetError());
 			return false;
@@ -130,68 +185,249 @@ namespace Strawberry::Net::Socket
 	{
 		if (mBuffer.Size() < length) mBuffer = Core::IO::DynamicByteBuffer::Zeroes(length);
 
-		auto recvResult = recv(mSocket, reinterpret_cast<char*>(mBuffer.Data()), mBuffer.Size(), 0);
-		if (recvResult == SOCKET_ERROR_CODE)
+		auto readResult = ReadInto({mBuffer.Data(), length});
+		if (!readResult)
 		{
-			switch (auto error = API::GetError())
-			{
-			default:
-				Core::Logging::Error("Unhandled error code in TCPSocket::Read! Code: {}.", error);
-				return ErrorUnknown{};
-			}
+			return readResult.Err();
 		}
 
-		Core::Assert(recvResult > 0);
-		return Core::IO::DynamicByteBuffer(mBuffer.Data(), length);
+		return Core::IO::DynamicByteBuffer(mBuffer.Data(), readResult.Unwrap());
 	}
 
 
 	StreamReadResult TCPSocket::ReadAll(size_t length)
 	{
-		size_t bytesRead = 0;
-		if (mBuffer.Size() < length) mBuffer = Core::IO::DynamicByteBuffer::Zeroes(length);
-
-		while (bytesRead < length)
+		while (mPartialRead.Size() < length)
 		{
-			auto read = Read(length - bytesRead);
-			if (read.IsOk())
-			{
-				memcpy(mBuffer.Data() + bytesRead, read->Data(), read->Size());
-				bytesRead += read->Size();
-			}
-			else
+			const size_t offset = mPartialRead.Size();
+			mPartialRead.Resize(length);
+
+			auto read = ReadInto({mPartialRead.Data() + offset, length - offset});
+			mPartialRead.Resize(offset + (read ? *read : 0));
+			// Non-blocking sockets keep what has arrived for the next call.
+			if (!read)
 			{
 				return read.Err();
 			}
 		}
 
-		return Core::IO::DynamicByteBuffer(mBuffer.Data(), length);
+		return std::exchange(mPartialRead, {});
 	}
 
 
 	StreamWriteResult TCPSocket::Write(const Core::IO::DynamicByteBuffer& bytes)
+	{
+		return Write(std::span<const uint8_t>(bytes.Data(), bytes.Size()));
+	}
+
+
+	StreamWriteResult TCPSocket::Write(std::span<const uint8_t> bytes)
 	{
 		size_t bytesSent = 0;
 
-		while (bytesSent < bytes.Size())
+		while (bytesSent < bytes.size())
 		{
-			auto sendResult = send(mSocket, reinterpret_cast<const char*>(bytes.Data()) + bytesSent, bytes.Size() - bytesSent, 0);
+#ifdef MSG_NOSIGNAL
+			// Writing to a connection the peer has closed fails, rather than raising SIGPIPE.
+			auto sendResult = send(mSocket, reinterpret_cast<const char*>(bytes.data()) + bytesSent, bytes.size() - bytesSent, MSG_NOSIGNAL);
+#else
+			auto sendResult = send(mSocket, reinterpret_cast<const char*>(bytes.data()) + bytesSent, bytes.size() - bytesSent, 0);
+#endif
 			if (sendResult > 0)
 			{
 				bytesSent += sendResult;
+				continue;
+			}
+
+			switch (auto error = API::GetError())
+			{
+			case SOCKET_ERROR_TYPE_CODE(EINTR):
+				continue;
+			// Non-blocking sockets hand back the rest of the write once the send buffer is full.
+			case SOCKET_ERROR_TYPE_CODE(EWOULDBLOCK):
+				return ErrorWantWrite {.bytesWritten = bytesSent};
+			case SOCKET_ERROR_TYPE_CODE(ECONNRESET):
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+			case EPIPE:
+#endif
+				return ErrorConnectionReset{};
+			default:
+				Core::Logging::Error("Unhandled error code in TCPSocket::Write! Code: {}.", error);
+				return ErrorUnknown{};
+			}
+		}
+
+		return Core::Success;
+	}
+
+
+	Core::Result<size_t, Error> TCPSocket::ReadInto(std::span<uint8_t> buffer)
+	{
+		decltype(recv(mSocket, nullptr, 0, 0)) recvResult;
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		if (mTimestamping)
+		{
+			// Read with recvmsg so that the kernel can attach the receive time.
+			iovec vector{.iov_base = buffer.data(), .iov_len = buffer.size()};
+			alignas(cmsghdr) char control[Timestamping::CONTROL_BUFFER_SIZE];
+			msghdr message{};
+			message.msg_iov        = &vector;
+			message.msg_iovlen     = 1;
+			message.msg_control    = control;
+			message.msg_controllen = sizeof(control);
+
+			recvResult = recvmsg(mSocket, &message, 0);
+			if (recvResult > 0) mReceiveTimestamp = Timestamping::FromControlMessages(message);
+		}
+		else
+#endif
+		{
+			recvResult = recv(mSocket, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0);
+		}
+
+		if (recvResult == SOCKET_ERROR_CODE)
+		{
+			switch (auto error = API::GetError())
+			{
+			// Interrupted by a signal before anything was received.
+			case SOCKET_ERROR_TYPE_CODE(EINTR):
+				return ReadInto(buffer);
+			case SOCKET_ERROR_TYPE_CODE(EWOULDBLOCK):
+				return ErrorNoData{};
+			case SOCKET_ERROR_TYPE_CODE(ECONNRESET):
+				return ErrorConnectionReset{};
+			default:
+				Core::Logging::Error("Unhandled error code in TCPSocket::ReadInto! Code: {}.", error);
+				return ErrorUnknown{};
 			}
-			else
+		}
+
+		// The peer closed the connection.
+		if (recvResult == 0)
+		{
+			return ErrorConnectionReset {};
+		}
+
+		return static_cast<size_t>(recvResult);
+	}
+
+
+	Core::Result<size_t, Error> TCPSocket::WriteVectored(std::span<const std::span<const uint8_t>> buffers)
+	{
+		// Buffers beyond the limit are left for the caller to send with the remainder.
+		static constexpr size_t MAX_BUFFERS = 64;
+		const size_t count = std::min(buffers.size(), MAX_BUFFERS);
+
+#if STRAWBERRY_TARGET_WINDOWS
+		WSABUF vectors[MAX_BUFFERS];
+		for (size_t i = 0; i < count; i++)
+		{
+			vectors[i].buf = reinterpret_cast<char*>(const_cast<uint8_t*>(buffers[i].data()));
+			vectors[i].len = static_cast<ULONG>(buffers[i].size());
+		}
+
+		DWORD sent = 0;
+		const bool failed = WSASend(mSocket, vectors, static_cast<DWORD>(count), &sent, 0, nullptr, nullptr) == SOCKET_ERROR_CODE;
+#elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		iovec vectors[MAX_BUFFERS];
+		for (size_t i = 0; i < count; i++)
+		{
+			vectors[i].iov_base = const_cast<uint8_t*>(buffers[i].data());
+			vectors[i].iov_len  = buffers[i].size();
+		}
+
+		msghdr message{};
+		message.msg_iov    = vectors;
+		message.msg_iovlen = count;
+#ifdef MSG_NOSIGNAL
+		// Writing to a connection the peer has closed fails, rather than raising SIGPIPE.
+		const ssize_t sent = sendmsg(mSocket, &message, MSG_NOSIGNAL);
+#else
+		const ssize_t sent = sendmsg(mSocket, &message, 0);
+#endif
+		const bool failed = sent == SOCKET_ERROR_CODE;
+#endif
+
+		if (failed)
+		{
+			switch (auto error = API::GetError())
 			{
-				switch (auto error = API::GetError())
-				{
-				default:
-					Core::Logging::Error("Unhandled error code in TCPSocket::Write! Code: {}.", error);
-					return ErrorUnknown{};
-				}
+			// Interrupted by a signal before anything was sent.
+			case SOCKET_ERROR_TYPE_CODE(EINTR):
+				return WriteVectored(buffers);
+			case SOCKET_ERROR_TYPE_CODE(EWOULDBLOCK):
+				return ErrorWantWrite{};
+			case SOCKET_ERROR_TYPE_CODE(ECONNRESET):
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+			case EPIPE:
+#endif
+				return ErrorConnectionReset{};
+			default:
+				Core::Logging::Error("Unhandled error code in TCPSocket::WriteVectored! Code: {}.", error);
+				return ErrorUnknown{};
 			}
 		}
 
-		Core::Assert(bytesSent == bytes.Size());
+		return static_cast<size_t>(sent);
+	}
+
+
+	Core::Result<void, Error> TCPSocket::SetNoDelay(bool noDelay)
+	{
+		SOCKET_OPTION_TYPE value = noDelay ? 1 : 0;
+		if (setsockopt(mSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&value), sizeof(value)) == SOCKET_ERROR_CODE)
+		{
+			Core::Logging::Error("Failed to set TCP_NODELAY on TCP socket ({}). Error code: {}.", mSocket, API::GetError());
+			return ErrorUnknown{};
+		}
+
 		return Core::Success;
 	}
+
+
+	Core::Result<void, Error> TCPSocket::SetTimestamping(bool enabled)
+	{
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		if (auto result = Timestamping::SetReceive(mSocket, enabled); !result)
+		{
+			return result;
+		}
+
+		mTimestamping = enabled;
+		if (!enabled) mReceiveTimestamp.Reset();
+		return Core::Success;
+#else
+		if (!enabled) return Core::Success;
+		Core::Logging::Error("Kernel receive timestamps are not supported on this platform!");
+		return ErrorNotSupported{};
+#endif
+	}
+
+
+	Core::Result<void, Error> TCPSocket::SetTransmitTimestamping(bool enabled)
+	{
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		return Timestamping::SetTransmit(mSocket, enabled);
+#else
+		if (!enabled) return Core::Success;
+		Core::Logging::Error("Transmit timestamps are not supported on this platform!");
+		return ErrorNotSupported{};
+#endif
+	}
+
+
+	const Core::Optional<Timestamp>& TCPSocket::GetReceiveTimestamp() const noexcept
+	{
+		return mReceiveTimestamp;
+	}
+
+
+	Core::Optional<TransmitTimestamp> TCPSocket::ReadTransmitTimestamp() const
+	{
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		return Timestamping::ReadTransmitTimestamp(mSocket);
+#else
+		return {};
+#endif
+	}
 } // namespace Strawberry::Net::Socket
@@ -11,9 +11,14 @@
 
 #include "Strawberry/Net/Endpoint.hpp"
 #include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Net/Socket/Timestamp.hpp"
 #include "Strawberry/Net/Socket/Types.hpp"
 #include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
 #include "Strawberry/Core/Types/Result.hpp"
+// Standard Library
+#include <chrono>
+#include <cstdint>
+#include <span>
 
 
 
@@ -24,7 +29,7 @@ namespace Strawberry::Net::Socket
 		friend class TLSSocket;
 		friend class TCPListener;
 
-	private:
+	public:
 #if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
 		using SocketHandle = int;
 #elif STRAWBERRY_TARGET_WINDOWS
@@ -32,7 +37,11 @@ namespace Strawberry::Net::Socket
 #endif
 
 	public:
-		static Core::Result<TCPSocket, Error> Connect(const Endpoint& endpoint);
+		/// Connects to the given endpoint.
+		///
+		/// Non-blocking sockets return before the connection is established.
+		/// The socket becomes writable once it is, and reports a failure on the first read or write.
+		static Core::Result<TCPSocket, Error> Connect(const Endpoint& endpoint, bool blocking = true);
 
 	public:
 		TCPSocket(const TCPSocket& other) = delete;
@@ -43,10 +52,47 @@ namespace Strawberry::Net::Socket
 
 
 		const Endpoint&    GetEndpoint() const noexcept;
-		[[nodiscard]] bool Poll() const;
+		/// Returns the platform handle of this socket, for registering with an event loop.
+		SocketHandle       GetHandle() const noexcept;
+
+
+		/// Sets whether reads block until data arrives.
+		/// When non-blocking, Read() returns ErrorNoData if nothing is available.
+		Core::Result<void, Error> SetBlocking(bool blocking);
+
+
+		/// Returns whether the socket is readable, waiting up to timeout for it to become so.
+		/// A negative timeout waits indefinitely.
+		[[nodiscard]] bool Poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) const;
 		StreamReadResult   Read(size_t length);
+		/// Reads exactly length bytes. Non-blocking sockets return ErrorNoData until they have all arrived,
+		/// keeping those which have, so the call should be repeated with the same length once the socket is readable.
 		StreamReadResult   ReadAll(size_t length);
+		/// Writes the given bytes. Non-blocking sockets return ErrorWantWrite once the send buffer is full,
+		/// with how many bytes were written before it. The rest is left for the caller to write once the socket is writable.
 		StreamWriteResult  Write(const Core::IO::DynamicByteBuffer& bytes);
+		/// Writes the given bytes, without them having to be copied into a buffer first.
+		StreamWriteResult  Write(std::span<const uint8_t> bytes);
+		/// Reads up to buffer.size() bytes straight into the buffer, and returns how many were read.
+		/// Non-blocking sockets return ErrorNoData when nothing is available.
+		Core::Result<size_t, Error> ReadInto(std::span<uint8_t> buffer);
+		/// Writes several buffers with one system call, without copying them together, and returns how many bytes were written.
+		/// This may be fewer than given. Non-blocking sockets return ErrorWantWrite when nothing could be written.
+		Core::Result<size_t, Error> WriteVectored(std::span<const std::span<const uint8_t>> buffers);
+
+
+		/// Sets whether small writes are sent straight away, rather than held back to be coalesced (Nagle's algorithm).
+		Core::Result<void, Error> SetNoDelay(bool noDelay);
+
+
+		/// Enables recording the kernel receive time of data returned by Read() and ReadInto().
+		Core::Result<void, Error> SetTimestamping(bool enabled);
+		/// Enables software transmit timestamps for written data. Only supported on Linux.
+		Core::Result<void, Error> SetTransmitTimestamping(bool enabled);
+		/// Returns the kernel receive time of the data returned by the last call to Read() or ReadInto().
+		[[nodiscard]] const Core::Optional<Timestamp>& GetReceiveTimestamp() const noexcept;
+		/// Returns the next available transmit timestamp, without blocking.
+		[[nodiscard]] Core::Optional<TransmitTimestamp> ReadTransmitTimestamp() const;
 
 	private:
 		TCPSocket(SocketHandle socketHandle, Endpoint endpoint);
@@ -55,5 +101,11 @@ namespace Strawberry::Net::Socket
 		SocketHandle mSocket;
 		Endpoint	 mEndpoint;
 		Core::IO::DynamicByteBuffer mBuffer;
+		/// Bytes received by a non-blocking ReadAll() which is waiting for the rest.
+		Core::IO::DynamicByteBuffer mPartialRead;
+		/// Whether kernel receive timestamps have been requested.
+		bool                        mTimestamping = false;
+		/// Kernel receive time of the most recent read.
+		Core::Optional<Timestamp>   mReceiveTimestamp;
 	};
 } // namespace Strawberry::Net::Socket
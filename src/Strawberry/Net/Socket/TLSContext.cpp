@@ -0,0 +1,502 @@
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+#include "Strawberry/Net/Socket/TLSContext.hpp"
+// Strawberry Net
+#include "Strawberry/Net/Address.hpp"
+// Strawberry Core
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/Logging.hpp"
+// Open SSL
+#include <openssl/core_names.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+// Standard Library
+#include <algorithm>
+#include <utility>
+// Platform specific CPU feature detection
+#if STRAWBERRY_TARGET_LINUX && defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+
+namespace Strawberry::Net::Socket
+{
+	/// Returns whether this CPU has instructions to accelerate AES.
+	static bool HasHardwareAES()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return __builtin_cpu_supports("aes");
+#elif defined(__aarch64__) && STRAWBERRY_TARGET_LINUX
+		return getauxval(AT_HWCAP) & HWCAP_AES;
+#elif defined(__aarch64__) && STRAWBERRY_TARGET_MAC
+		// Every Apple silicon CPU implements the ARMv8 crypto extensions.
+		return true;
+#else
+		return false;
+#endif
+	}
+
+
+	/// Logs and clears the OpenSSL error queue.
+	static void LogOpenSSLErrors(const char* context)
+	{
+		while (auto error = ERR_get_error())
+		{
+			char buffer[256];
+			ERR_error_string_n(error, buffer, sizeof(buffer));
+			Core::Logging::Error("{}: {}", context, buffer);
+		}
+	}
+
+
+	struct TLSContext::ServerState
+	{
+		/// ALPN protocols in wire format, in order of preference.
+		std::vector<unsigned char> alpnProtocols;
+		std::vector<TLSTicketKey>  ticketKeys;
+	};
+
+
+	/// Converts protocol names into the list of length prefixed strings used by ALPN.
+	static std::vector<unsigned char> EncodeALPN(const std::vector<std::string>& protocols)
+	{
+		std::vector<unsigned char> wire;
+		for (const auto& protocol : protocols)
+		{
+			Core::Assert(!protocol.empty() && protocol.size() <= 255, "Invalid ALPN protocol name");
+			wire.push_back(static_cast<unsigned char>(protocol.size()));
+			wire.insert(wire.end(), protocol.begin(), protocol.end());
+		}
+		return wire;
+	}
+
+
+	/// Returns the ex_data index under which server contexts store their ServerState.
+	static int GetServerStateIndex()
+	{
+		static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+		return index;
+	}
+
+
+	Core::Result<TLSTrustStore, Error> TLSTrustStore::System()
+	{
+		static const Core::Optional<TLSTrustStore> system = []() -> Core::Optional<TLSTrustStore>
+		{
+			X509_STORE* store = X509_STORE_new();
+			if (store == nullptr) return {};
+
+			if (X509_STORE_set_default_paths(store) != 1)
+			{
+				LogOpenSSLErrors("Failed to load the system trust store");
+				X509_STORE_free(store);
+				return {};
+			}
+
+			return TLSTrustStore(store);
+		}();
+
+		if (!system) return ErrorOpenSSL {};
+		return *system;
+	}
+
+
+	Core::Result<TLSTrustStore, Error> TLSTrustStore::Load(const Core::Optional<std::string>& file, const Core::Optional<std::string>& directory)
+	{
+		X509_STORE* store = X509_STORE_new();
+		if (store == nullptr) return ErrorSSLAllocation {};
+
+		TLSTrustStore trustStore(store);
+		if (X509_STORE_load_locations(store, file ? file->c_str() : nullptr, directory ? directory->c_str() : nullptr) != 1)
+		{
+			LogOpenSSLErrors("Failed to load trust store");
+			return ErrorOpenSSL {};
+		}
+
+		return trustStore;
+	}
+
+
+	TLSTrustStore::TLSTrustStore(X509_STORE* store)
+		: mStore(store) {}
+
+
+	TLSTrustStore::TLSTrustStore(const TLSTrustStore& other)
+		: mStore(other.mStore)
+	{
+		X509_STORE_up_ref(mStore);
+	}
+
+
+	TLSTrustStore& TLSTrustStore::operator=(const TLSTrustStore& other)
+	{
+		if (this != &other)
+		{
+			std::destroy_at(this);
+			std::construct_at(this, other);
+		}
+
+		return *this;
+	}
+
+
+	TLSTrustStore::TLSTrustStore(TLSTrustStore&& other) noexcept
+		: mStore(std::exchange(other.mStore, nullptr)) {}
+
+
+	TLSTrustStore& TLSTrustStore::operator=(TLSTrustStore&& other) noexcept
+	{
+		if (this != &other)
+		{
+			std::destroy_at(this);
+			std::construct_at(this, std::move(other));
+		}
+
+		return *this;
+	}
+
+
+	TLSTrustStore::~TLSTrustStore()
+	{
+		if (mStore) X509_STORE_free(mStore);
+	}
+
+
+	X509_STORE* TLSTrustStore::GetHandle() const noexcept
+	{
+		return mStore;
+	}
+
+
+	TLSTicketKey TLSTicketKey::Generate()
+	{
+		TLSTicketKey key;
+		Core::AssertEQ(RAND_bytes(key.name.data(), static_cast<int>(key.name.size())), 1);
+		Core::AssertEQ(RAND_bytes(key.hmacKey.data(), static_cast<int>(key.hmacKey.size())), 1);
+		Core::AssertEQ(RAND_bytes(key.aesKey.data(), static_cast<int>(key.aesKey.size())), 1);
+		return key;
+	}
+
+
+	TLSContextOptions TLSContextOptions::FastHandshake()
+	{
+		TLSContextOptions options;
+		options.groups = "X25519:P-256";
+		if (HasHardwareAES())
+		{
+			options.cipherSuites = "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384:TLS_CHACHA20_POLY1305_SHA256";
+			options.cipherList   = "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305";
+		}
+		else
+		{
+			options.cipherSuites = "TLS_CHACHA20_POLY1305_SHA256:TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384";
+			options.cipherList   = "ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305:ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256";
+		}
+		return options;
+	}
+
+
+	const TLSContext& TLSContext::Default()
+	{
+		// Initialised exactly once, even when first used from several threads.
+		static const TLSContext context = Create(TLSContextOptions{}).Unwrap();
+		return context;
+	}
+
+
+	Core::Result<TLSContext, Error> TLSContext::Create(const TLSContextOptions& options)
+	{
+		OPENSSL_init_ssl(OPENSSL_INIT_LOAD_SSL_STRINGS | OPENSSL_INIT_LOAD_CRYPTO_STRINGS, nullptr);
+
+		SSL_CTX* handle = SSL_CTX_new(TLS_client_method());
+		if (handle == nullptr)
+		{
+			return ErrorSSLAllocation {};
+		}
+
+		TLSContext context(handle, std::make_shared<TLSSessionCache>(options.sessionCacheCapacity), options.verifyPeer);
+		context.mSessionCache->Attach(handle);
+
+		if (auto result = Configure(handle, options); !result)
+		{
+			return result.Err();
+		}
+
+		if (!options.alpnProtocols.empty())
+		{
+			auto wire = EncodeALPN(options.alpnProtocols);
+			// Unlike most of OpenSSL, this returns 0 on success.
+			if (SSL_CTX_set_alpn_protos(handle, wire.data(), static_cast<unsigned int>(wire.size())) != 0)
+			{
+				LogOpenSSLErrors("Failed to set ALPN protocols");
+				return ErrorOpenSSL {};
+			}
+		}
+
+		return context;
+	}
+
+
+	Core::Result<TLSContext, Error> TLSContext::CreateServer(const TLSServerOptions& options)
+	{
+		OPENSSL_init_ssl(OPENSSL_INIT_LOAD_SSL_STRINGS | OPENSSL_INIT_LOAD_CRYPTO_STRINGS, nullptr);
+
+		SSL_CTX* handle = SSL_CTX_new(TLS_server_method());
+		if (handle == nullptr)
+		{
+			return ErrorSSLAllocation {};
+		}
+
+		// Servers resume sessions through tickets, so they have no client session cache.
+		TLSContext context(handle, nullptr, options.verifyPeer);
+
+		if (auto result = Configure(handle, options); !result)
+		{
+			return result.Err();
+		}
+
+		if (options.verifyPeer)
+		{
+			SSL_CTX_set_verify(handle, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, nullptr);
+		}
+
+		if (SSL_CTX_use_certificate_chain_file(handle, options.certificateChainFile.c_str()) != 1)
+		{
+			LogOpenSSLErrors("Failed to load certificate chain");
+			return ErrorOpenSSL {};
+		}
+
+		if (SSL_CTX_use_PrivateKey_file(handle, options.privateKeyFile.c_str(), SSL_FILETYPE_PEM) != 1
+			|| SSL_CTX_check_private_key(handle) != 1)
+		{
+			LogOpenSSLErrors("Failed to load private key");
+			return ErrorOpenSSL {};
+		}
+
+		context.mServerState = std::make_shared<ServerState>(ServerState{
+			.alpnProtocols = EncodeALPN(options.alpnProtocols),
+			.ticketKeys    = options.ticketKeys,
+		});
+		SSL_CTX_set_ex_data(handle, GetServerStateIndex(), context.mServerState.get());
+
+		if (!options.alpnProtocols.empty())
+		{
+			SSL_CTX_set_alpn_select_cb(handle, &TLSContext::OnSelectALPN, context.mServerState.get());
+		}
+
+		if (!options.ticketKeys.empty())
+		{
+			SSL_CTX_set_tlsext_ticket_key_evp_cb(handle, &TLSContext::OnTicketKey);
+		}
+
+		return context;
+	}
+
+
+	int TLSContext::OnSelectALPN(SSL*, const unsigned char** out, unsigned char* outLength, const unsigned char* in, unsigned int inLength, void* argument)
+	{
+		const auto* state = static_cast<const ServerState*>(argument);
+
+		unsigned char* selected = nullptr;
+		if (SSL_select_next_proto(&selected, outLength, state->alpnProtocols.data(), static_cast<unsigned int>(state->alpnProtocols.size()), in, inLength) != OPENSSL_NPN_NEGOTIATED)
+		{
+			return SSL_TLSEXT_ERR_NOACK;
+		}
+
+		*out = selected;
+		return SSL_TLSEXT_ERR_OK;
+	}
+
+
+	int TLSContext::OnTicketKey(SSL* ssl, unsigned char* keyName, unsigned char* iv, EVP_CIPHER_CTX* cipher, EVP_MAC_CTX* mac, int encrypt)
+	{
+		const auto* state = static_cast<const ServerState*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), GetServerStateIndex()));
+		if (state == nullptr || state->ticketKeys.empty()) return -1;
+
+		const TLSTicketKey* key = nullptr;
+		if (encrypt)
+		{
+			key = &state->ticketKeys.front();
+			if (RAND_bytes(iv, EVP_CIPHER_get_iv_length(EVP_aes_256_cbc())) != 1) return -1;
+			std::copy(key->name.begin(), key->name.end(), keyName);
+		}
+		else
+		{
+			auto match = std::find_if(state->ticketKeys.begin(), state->ticketKeys.end(), [keyName](const TLSTicketKey& candidate)
+			{
+				return std::equal(candidate.name.begin(), candidate.name.end(), keyName);
+			});
+
+			// Unknown keys just mean a full handshake.
+			if (match == state->ticketKeys.end()) return 0;
+			key = &*match;
+		}
+
+		OSSL_PARAM parameters[] = {
+			OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0),
+			OSSL_PARAM_construct_end()
+		};
+		if (EVP_MAC_init(mac, key->hmacKey.data(), key->hmacKey.size(), parameters) != 1) return -1;
+
+		auto cipherResult = encrypt
+			? EVP_EncryptInit_ex(cipher, EVP_aes_256_cbc(), nullptr, key->aesKey.data(), iv)
+			: EVP_DecryptInit_ex(cipher, EVP_aes_256_cbc(), nullptr, key->aesKey.data(), iv);
+		if (cipherResult != 1) return -1;
+
+		// Tickets under an older key are accepted, but replaced with one under the current key.
+		return encrypt || key == &state->ticketKeys.front() ? 1 : 2;
+	}
+
+
+	Core::Result<void, Error> TLSContext::Configure(SSL_CTX* context, const TLSContextOptions& options)
+	{
+		if (SSL_CTX_set_min_proto_version(context, options.minimumVersion) != 1)
+		{
+			LogOpenSSLErrors("Failed to set minimum TLS version");
+			return ErrorOpenSSL {};
+		}
+
+		if (!options.cipherList.empty() && SSL_CTX_set_cipher_list(context, options.cipherList.c_str()) != 1)
+		{
+			LogOpenSSLErrors("Failed to set TLS 1.2 cipher list");
+			return ErrorOpenSSL {};
+		}
+
+		if (!options.cipherSuites.empty() && SSL_CTX_set_ciphersuites(context, options.cipherSuites.c_str()) != 1)
+		{
+			LogOpenSSLErrors("Failed to set TLS 1.3 cipher suites");
+			return ErrorOpenSSL {};
+		}
+
+		if (!options.groups.empty() && SSL_CTX_set1_groups_list(context, options.groups.c_str()) != 1)
+		{
+			LogOpenSSLErrors("Failed to set key exchange groups");
+			return ErrorOpenSSL {};
+		}
+
+		if (options.verifyPeer)
+		{
+			auto trustStore = options.trustStore ? Core::Result<TLSTrustStore, Error>(*options.trustStore) : TLSTrustStore::System();
+			if (!trustStore)
+			{
+				return trustStore.Err();
+			}
+
+			// Shares the store rather than copying it.
+			SSL_CTX_set1_cert_store(context, trustStore->GetHandle());
+			SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+		}
+
+		return Core::Success;
+	}
+
+
+	TLSContext::TLSContext(SSL_CTX* context, std::shared_ptr<TLSSessionCache> sessionCache, bool verifyPeer)
+		: mContext(context)
+		, mSessionCache(std::move(sessionCache))
+		, mVerifyPeer(verifyPeer) {}
+
+
+	TLSContext::TLSContext(const TLSContext& other)
+		: mContext(other.mContext)
+		, mSessionCache(other.mSessionCache)
+		, mVerifyPeer(other.mVerifyPeer)
+		, mServerState(other.mServerState)
+	{
+		SSL_CTX_up_ref(mContext);
+	}
+
+
+	TLSContext& TLSContext::operator=(const TLSContext& other)
+	{
+		if (this != &other)
+		{
+			std::destroy_at(this);
+			std::construct_at(this, other);
+		}
+
+		return *this;
+	}
+
+
+	TLSContext::TLSContext(TLSContext&& other) noexcept
+		: mContext(std::exchange(other.mContext, nullptr))
+		, mSessionCache(std::move(other.mSessionCache))
+		, mVerifyPeer(other.mVerifyPeer)
+		, mServerState(std::move(other.mServerState)) {}
+
+
+	TLSContext& TLSContext::operator=(TLSContext&& other) noexcept
+	{
+		if (this != &other)
+		{
+			std::destroy_at(this);
+			std::construct_at(this, std::move(other));
+		}
+
+		return *this;
+	}
+
+
+	TLSContext::~TLSContext()
+	{
+		if (mContext) SSL_CTX_free(mContext);
+	}
+
+
+	SSL_CTX* TLSContext::GetHandle() const noexcept
+	{
+		return mContext;
+	}
+
+
+	TLSSessionCache& TLSContext::GetSessionCache() const noexcept
+	{
+		Core::Assert(mSessionCache != nullptr, "Server TLS contexts have no session cache");
+		return *mSessionCache;
+	}
+
+
+	bool TLSContext::VerifiesPeer() const noexcept
+	{
+		return mVerifyPeer;
+	}
+
+
+	Core::Result<void, Error> TLSContext::SetPeerIdentity(SSL* ssl, const Core::Optional<std::string>& name) const
+	{
+		if (!name)
+		{
+			if (!mVerifyPeer) return Core::Success;
+
+			// Otherwise any trusted certificate would do, whoever it was issued to.
+			Core::Logging::Error("Cannot verify a TLS peer with neither a hostname nor an address to check its certificate against");
+			return ErrorSSLHandshake {};
+		}
+
+		// Addresses can't be sent for SNI (RFC 6066 section 3).
+		if (IPv4Address::Parse(*name) || IPv6Address::Parse(*name))
+		{
+			if (mVerifyPeer && !X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), name->c_str()))
+			{
+				return ErrorOpenSSL {};
+			}
+			return Core::Success;
+		}
+
+		auto hostnameResult = SSL_set_tlsext_host_name(ssl, name->c_str());
+		Core::Assert(hostnameResult);
+
+		// The certificate must also have been issued for the host we asked for.
+		if (mVerifyPeer)
+		{
+			auto hostResult = SSL_set1_host(ssl, name->c_str());
+			Core::Assert(hostResult);
+		}
+
+		return Core::Success;
+	}
+} // namespace Strawberry::Net::Socket
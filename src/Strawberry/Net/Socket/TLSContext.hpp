@@ -0,0 +1,165 @@
+#pragma once
+
+
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+// Strawberry Net
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Net/Socket/TLSSessionCache.hpp"
+// Strawberry Core
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+// Open SSL
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+// Standard Library
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace Strawberry::Net::Socket
+{
+	/// A set of trusted certificate authorities, which can be shared between many contexts.
+	///
+	/// Copies refer to the same underlying store.
+	class TLSTrustStore
+	{
+	public:
+		/// Returns the platform's default trust store, which is loaded once per process.
+		static Core::Result<TLSTrustStore, Error> System();
+		/// Loads a store from a PEM file and/or a directory of hashed certificates.
+		static Core::Result<TLSTrustStore, Error> Load(const Core::Optional<std::string>& file, const Core::Optional<std::string>& directory = {});
+
+	public:
+		TLSTrustStore(const TLSTrustStore& other);
+		TLSTrustStore& operator=(const TLSTrustStore& other);
+		TLSTrustStore(TLSTrustStore&& other) noexcept;
+		TLSTrustStore& operator=(TLSTrustStore&& other) noexcept;
+		~TLSTrustStore();
+
+
+		[[nodiscard]] X509_STORE* GetHandle() const noexcept;
+
+	private:
+		explicit TLSTrustStore(X509_STORE* store);
+
+
+		X509_STORE* mStore;
+	};
+
+
+	/// Settings for a TLS context.
+	struct TLSContextOptions
+	{
+		/// Application protocols to offer through ALPN, in order of preference, e.g. {"h2", "http/1.1"}.
+		std::vector<std::string>      alpnProtocols;
+		/// OpenSSL cipher list for TLS 1.2. Empty keeps the OpenSSL default.
+		std::string                   cipherList;
+		/// OpenSSL cipher suites for TLS 1.3. Empty keeps the OpenSSL default.
+		std::string                   cipherSuites;
+		/// Key exchange groups in order of preference, e.g. "X25519:P-256". Empty keeps the OpenSSL default.
+		std::string                   groups;
+		/// The oldest protocol version to negotiate.
+		int                           minimumVersion       = TLS1_2_VERSION;
+		/// Whether to verify the peer's certificate chain, and for clients the hostname it was issued to.
+		bool                          verifyPeer           = false;
+		/// Authorities to verify peers against. Defaults to the system trust store.
+		Core::Optional<TLSTrustStore> trustStore;
+		/// Number of client sessions to keep for resumption.
+		size_t                        sessionCacheCapacity = TLSSessionCache::DEFAULT_CAPACITY;
+
+
+		/// Options tuned for fast handshakes: X25519 key exchange, with AES-GCM preferred
+		/// when the CPU accelerates AES and ChaCha20-Poly1305 preferred otherwise.
+		static TLSContextOptions FastHandshake();
+	};
+
+
+	/// A key for encrypting session tickets.
+	///
+	/// Servers behind the same address should share their keys, so that any of them can resume a session.
+	struct TLSTicketKey
+	{
+		std::array<uint8_t, 16> name;
+		std::array<uint8_t, 32> hmacKey;
+		std::array<uint8_t, 32> aesKey;
+
+
+		/// Generates a new random key.
+		static TLSTicketKey Generate();
+	};
+
+
+	/// Settings for a server TLS context.
+	struct TLSServerOptions : TLSContextOptions
+	{
+		/// PEM file containing the server certificate, followed by any intermediate certificates.
+		std::string               certificateChainFile;
+		/// PEM file containing the private key for the certificate.
+		std::string               privateKeyFile;
+		/// Keys for session tickets. New tickets are encrypted with the first key, and tickets encrypted with the others
+		/// are still accepted and renewed, so keys can be rotated. Empty uses a random key for the lifetime of the context.
+		std::vector<TLSTicketKey> ticketKeys;
+	};
+
+
+	/// Configuration shared by TLS connections, wrapping an OpenSSL context and its session cache.
+	///
+	/// Contexts are immutable once created and safe to use from many threads.
+	/// Copies are cheap and refer to the same underlying context.
+	class TLSContext
+	{
+	public:
+		/// Returns the process-wide client context, with default options.
+		static const TLSContext&             Default();
+		/// Creates a client context.
+		static Core::Result<TLSContext, Error> Create(const TLSContextOptions& options);
+		/// Creates a server context.
+		///
+		/// ALPN protocols are selected in the server's order of preference.
+		/// Enabling peer verification requires clients to present a certificate.
+		static Core::Result<TLSContext, Error> CreateServer(const TLSServerOptions& options);
+
+	public:
+		TLSContext(const TLSContext& other);
+		TLSContext& operator=(const TLSContext& other);
+		TLSContext(TLSContext&& other) noexcept;
+		TLSContext& operator=(TLSContext&& other) noexcept;
+		~TLSContext();
+
+
+		[[nodiscard]] SSL_CTX*         GetHandle() const noexcept;
+		/// Returns the cache of sessions to resume. Only client contexts have one.
+		[[nodiscard]] TLSSessionCache& GetSessionCache() const noexcept;
+		[[nodiscard]] bool             VerifiesPeer() const noexcept;
+		/// Sets the name of the server a client connection is for, to send for SNI and, if peers are verified,
+		/// to check its certificate against. IP addresses are checked against the certificate's addresses instead,
+		/// and aren't sent. Fails if peers are verified and there is no name.
+		Core::Result<void, Error>      SetPeerIdentity(SSL* ssl, const Core::Optional<std::string>& name) const;
+
+	private:
+		/// State referred to by the callbacks of server contexts.
+		struct ServerState;
+
+
+		TLSContext(SSL_CTX* context, std::shared_ptr<TLSSessionCache> sessionCache, bool verifyPeer);
+
+
+		/// Applies the options shared by every kind of context.
+		static Core::Result<void, Error> Configure(SSL_CTX* context, const TLSContextOptions& options);
+		/// Picks the first of the server's ALPN protocols which the client also offered.
+		static int OnSelectALPN(SSL* ssl, const unsigned char** out, unsigned char* outLength, const unsigned char* in, unsigned int inLength, void* argument);
+		/// Selects the key for encrypting or decrypting a session ticket.
+		static int OnTicketKey(SSL* ssl, unsigned char* keyName, unsigned char* iv, EVP_CIPHER_CTX* cipher, EVP_MAC_CTX* mac, int encrypt);
+
+
+		SSL_CTX*                         mContext;
+		std::shared_ptr<TLSSessionCache> mSessionCache;
+		bool                             mVerifyPeer;
+		std::shared_ptr<ServerState>     mServerState;
+	};
+} // namespace Strawberry::Net::Socket
@@ -0,0 +1,242 @@
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+#include "Strawberry/Net/Socket/TLSEngine.hpp"
+// Strawberry Core
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/Logging.hpp"
+// Standard Library
+#include <algorithm>
+#include <utility>
+
+
+namespace Strawberry::Net::Socket
+{
+	Core::Result<TLSEngine, Error> TLSEngine::Client(const Core::Optional<std::string>& serverName)
+	{
+		return Client(TLSContext::Default(), serverName);
+	}
+
+
+	Core::Result<TLSEngine, Error> TLSEngine::Client(const TLSContext& context, const Core::Optional<std::string>& serverName)
+	{
+		SSL* ssl = SSL_new(context.GetHandle());
+		if (ssl == nullptr)
+		{
+			return ErrorSSLAllocation {};
+		}
+
+		BIO* networkIn  = BIO_new(BIO_s_mem());
+		BIO* networkOut = BIO_new(BIO_s_mem());
+		if (networkIn == nullptr || networkOut == nullptr)
+		{
+			BIO_free(networkIn);
+			BIO_free(networkOut);
+			SSL_free(ssl);
+			return ErrorSSLAllocation {};
+		}
+
+		// Reading from an empty memory BIO should ask for more data, rather than signal end of file.
+		BIO_set_mem_eof_return(networkIn, -1);
+		SSL_set_bio(ssl, networkIn, networkOut);
+
+		if (auto identityResult = context.SetPeerIdentity(ssl, serverName); !identityResult)
+		{
+			SSL_free(ssl);
+			return identityResult.Err();
+		}
+
+		SSL_set_connect_state(ssl);
+		return TLSEngine(ssl, networkIn, networkOut);
+	}
+
+
+	TLSEngine::TLSEngine(SSL* ssl, BIO* networkIn, BIO* networkOut)
+		: mSSL(ssl)
+		, mNetworkIn(networkIn)
+		, mNetworkOut(networkOut) {}
+
+
+	TLSEngine::TLSEngine(TLSEngine&& other) noexcept
+		: mSSL(std::exchange(other.mSSL, nullptr))
+		, mNetworkIn(std::exchange(other.mNetworkIn, nullptr))
+		, mNetworkOut(std::exchange(other.mNetworkOut, nullptr)) {}
+
+
+	TLSEngine& TLSEngine::operator=(TLSEngine&& other) noexcept
+	{
+		if (this != &other)
+		{
+			std::destroy_at(this);
+			std::construct_at(this, std::move(other));
+		}
+
+		return *this;
+	}
+
+
+	TLSEngine::~TLSEngine()
+	{
+		if (mSSL)
+		{
+			// Also frees both BIOs.
+			SSL_free(mSSL);
+		}
+	}
+
+
+	void TLSEngine::WriteCiphertext(const uint8_t* data, size_t length)
+	{
+		// Memory BIOs grow as needed, so this always consumes everything.
+		size_t written = 0;
+		auto   result  = BIO_write_ex(mNetworkIn, data, length, &written);
+		Core::Assert(length == 0 || (result == 1 && written == length));
+	}
+
+
+	void TLSEngine::WriteCiphertext(const Core::IO::DynamicByteBuffer& bytes)
+	{
+		WriteCiphertext(bytes.Data(), bytes.Size());
+	}
+
+
+	size_t TLSEngine::GetPendingCiphertext() const
+	{
+		return BIO_ctrl_pending(mNetworkOut);
+	}
+
+
+	Core::IO::DynamicByteBuffer TLSEngine::ReadCiphertext()
+	{
+		auto bytes = Core::IO::DynamicByteBuffer::Zeroes(GetPendingCiphertext());
+		if (bytes.Size() > 0)
+		{
+			size_t read   = 0;
+			auto   result = BIO_read_ex(mNetworkOut, bytes.Data(), bytes.Size(), &read);
+			Core::Assert(result == 1 && read == bytes.Size());
+		}
+
+		return bytes;
+	}
+
+
+	Core::Result<void, Error> TLSEngine::Handshake()
+	{
+		if (IsHandshakeComplete())
+		{
+			return Core::Success;
+		}
+
+		auto handshakeResult = SSL_do_handshake(mSSL);
+		if (handshakeResult == 1)
+		{
+			return Core::Success;
+		}
+
+		switch (auto error = SSL_get_error(mSSL, handshakeResult))
+		{
+		case SSL_ERROR_WANT_READ: return ErrorWantRead {};
+		default:
+			Core::Logging::Error("TLSEngine handshake failed. Error code: {}.", error);
+			return ErrorSSLHandshake {};
+		}
+	}
+
+
+	bool TLSEngine::IsHandshakeComplete() const
+	{
+		return SSL_is_init_finished(mSSL);
+	}
+
+
+	StreamWriteResult TLSEngine::Encrypt(const Core::IO::DynamicByteBuffer& plaintext)
+	{
+		if (auto handshakeResult = Handshake(); !handshakeResult)
+		{
+			return handshakeResult;
+		}
+
+		size_t bytesSent = 0;
+		while (bytesSent < plaintext.Size())
+		{
+			size_t written = 0;
+			if (SSL_write_ex(mSSL, plaintext.Data() + bytesSent, plaintext.Size() - bytesSent, &written) != 1)
+			{
+				switch (auto error = SSL_get_error(mSSL, 0))
+				{
+				case SSL_ERROR_WANT_READ: return ErrorWantRead {};
+				case SSL_ERROR_ZERO_RETURN: return ErrorConnectionReset {};
+				case SSL_ERROR_SSL: return ErrorOpenSSL {};
+				default:
+					Core::Logging::Error("Unknown SSL_write error code: {}", error);
+					return ErrorOpenSSL {};
+				}
+			}
+
+			bytesSent += written;
+		}
+
+		return Core::Success;
+	}
+
+
+	StreamReadResult TLSEngine::Decrypt(size_t maxLength)
+	{
+		Core::IO::DynamicByteBuffer plaintext;
+
+		// Decrypt as many records as are available, rather than one per call.
+		while (plaintext.Size() < maxLength)
+		{
+			const size_t chunkSize = std::min(DECRYPT_CHUNK_SIZE, maxLength - plaintext.Size());
+			const size_t offset    = plaintext.Size();
+			plaintext.Resize(offset + chunkSize);
+
+			size_t read = 0;
+			if (SSL_read_ex(mSSL, plaintext.Data() + offset, chunkSize, &read) == 1)
+			{
+				plaintext.Resize(offset + read);
+				continue;
+			}
+
+			plaintext.Resize(offset);
+			switch (auto error = SSL_get_error(mSSL, 0))
+			{
+			case SSL_ERROR_WANT_READ:
+				break;
+			case SSL_ERROR_ZERO_RETURN:
+				// Hand out what was decrypted before the close_notify first.
+				if (plaintext.Size() > 0) return plaintext;
+				return ErrorConnectionReset {};
+			case SSL_ERROR_SSL: return ErrorOpenSSL {};
+			// Anything else is down to what the peer sent, so is an error rather than a crash.
+			default:
+				Core::Logging::Error("Unknown SSL_read error code: {}", error);
+				return ErrorOpenSSL {};
+			}
+
+			break;
+		}
+
+		if (plaintext.Size() == 0)
+		{
+			return ErrorNoData {};
+		}
+
+		return plaintext;
+	}
+
+
+	size_t TLSEngine::GetPendingPlaintext() const
+	{
+		return SSL_pending(mSSL);
+	}
+
+
+	void TLSEngine::Shutdown()
+	{
+		if (IsHandshakeComplete())
+		{
+			SSL_shutdown(mSSL);
+		}
+	}
+} // namespace Strawberry::Net::Socket
@@ -0,0 +1,91 @@
+#pragma once
+
+
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+// Strawberry Net
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Net/Socket/TLSContext.hpp"
+#include "Strawberry/Net/Socket/Types.hpp"
+// Strawberry Core
+#include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+// Open SSL
+#include <openssl/ssl.h>
+// Standard Library
+#include <cstdint>
+#include <limits>
+#include <string>
+
+
+namespace Strawberry::Net::Socket
+{
+	/// A TLS connection which isn't bound to any transport.
+	///
+	/// Ciphertext is exchanged with the transport through memory buffers, so the engine can run over
+	/// io_uring, shared memory or in-memory pipes, and many engines can be driven from one batch of I/O.
+	/// Data received from the transport is passed to WriteCiphertext(), and whatever ReadCiphertext()
+	/// returns must be sent to the peer after every call which may produce output.
+	class TLSEngine
+	{
+	public:
+		/// Creates a client engine, sending the given server name for SNI.
+		static Core::Result<TLSEngine, Error> Client(const Core::Optional<std::string>& serverName = {});
+		/// Creates a client engine using the given context.
+		/// If the context verifies peers, the server name is required, and may be an IP address.
+		static Core::Result<TLSEngine, Error> Client(const TLSContext& context, const Core::Optional<std::string>& serverName = {});
+
+	public:
+		TLSEngine(const TLSEngine&)            = delete;
+		TLSEngine& operator=(const TLSEngine&) = delete;
+		TLSEngine(TLSEngine&& other) noexcept;
+		TLSEngine& operator=(TLSEngine&& other) noexcept;
+		~TLSEngine();
+
+
+		//======================================================================================================================
+		//	Transport side
+		//----------------------------------------------------------------------------------------------------------------------
+		/// Hands ciphertext received from the peer to the engine.
+		void                                      WriteCiphertext(const uint8_t* data, size_t length);
+		void                                      WriteCiphertext(const Core::IO::DynamicByteBuffer& bytes);
+		/// Returns the number of ciphertext bytes waiting to be sent to the peer.
+		[[nodiscard]] size_t                      GetPendingCiphertext() const;
+		/// Removes and returns all ciphertext waiting to be sent to the peer.
+		[[nodiscard]] Core::IO::DynamicByteBuffer ReadCiphertext();
+
+
+		//======================================================================================================================
+		//	Application side
+		//----------------------------------------------------------------------------------------------------------------------
+		/// Advances the handshake with the ciphertext received so far.
+		/// Returns ErrorWantRead until the handshake is complete and more ciphertext is needed.
+		Core::Result<void, Error> Handshake();
+		[[nodiscard]] bool        IsHandshakeComplete() const;
+		/// Encrypts the given plaintext into records, which are then available from ReadCiphertext().
+		StreamWriteResult         Encrypt(const Core::IO::DynamicByteBuffer& plaintext);
+		/// Decrypts every complete record received so far, up to maxLength bytes of plaintext.
+		/// Returns ErrorNoData if no complete record is available.
+		StreamReadResult          Decrypt(size_t maxLength = std::numeric_limits<size_t>::max());
+		/// Returns the number of decrypted bytes buffered from a partially consumed record.
+		[[nodiscard]] size_t      GetPendingPlaintext() const;
+		/// Queues a close_notify alert for the peer.
+		void                      Shutdown();
+
+	private:
+		TLSEngine(SSL* ssl, BIO* networkIn, BIO* networkOut);
+
+
+		/// Size of the chunks which records are decrypted into.
+		static constexpr size_t DECRYPT_CHUNK_SIZE = 16 * 1024;
+
+
+		SSL* mSSL;
+		/// Ciphertext from the peer, read by OpenSSL. Owned by mSSL.
+		BIO* mNetworkIn;
+		/// Ciphertext for the peer, written by OpenSSL. Owned by mSSL.
+		BIO* mNetworkOut;
+	};
+} // namespace Strawberry::Net::Socket
@@ -0,0 +1,178 @@
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+// Strawberry Net
+#include "Strawberry/Net/Socket/TLSListener.hpp"
+// Strawberry Core
+#include "Strawberry/Core/IO/Logging.hpp"
+// Standard Library
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+//======================================================================================================================
+//	Method Definitions
+//----------------------------------------------------------------------------------------------------------------------
+namespace Strawberry::Net::Socket
+{
+	/// Threads which perform server handshakes for accepted connections.
+	class TLSListener::HandshakePool
+	{
+	public:
+		HandshakePool(TLSContext context, std::chrono::milliseconds timeout, size_t workerCount)
+			: mContext(std::move(context))
+			, mTimeout(timeout)
+		{
+			for (size_t i = 0; i < workerCount; i++)
+			{
+				mWorkers.emplace_back([this] { Run(); });
+			}
+		}
+
+
+		HandshakePool(const HandshakePool&)            = delete;
+		HandshakePool& operator=(const HandshakePool&) = delete;
+
+
+		~HandshakePool()
+		{
+			{
+				std::lock_guard lock(mMutex);
+				mStopping = true;
+			}
+			mCondition.notify_all();
+
+			for (auto& worker : mWorkers)
+			{
+				worker.join();
+			}
+		}
+
+
+		void Submit(TCPSocket socket, Handler handler)
+		{
+			{
+				std::lock_guard lock(mMutex);
+				mJobs.push_back(Job{std::move(socket), std::move(handler)});
+			}
+			mCondition.notify_one();
+		}
+
+	private:
+		struct Job
+		{
+			TCPSocket socket;
+			Handler   handler;
+		};
+
+
+		void Run()
+		{
+			while (true)
+			{
+				std::unique_lock lock(mMutex);
+				mCondition.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+				// Finish queued handshakes before stopping, so every handler is called.
+				if (mJobs.empty()) return;
+
+				Job job = std::move(mJobs.front());
+				mJobs.pop_front();
+				lock.unlock();
+
+				job.handler(TLSSocket::Accept(std::move(job.socket), mContext, mTimeout));
+			}
+		}
+
+
+		TLSContext                mContext;
+		std::chrono::milliseconds mTimeout;
+		std::mutex                mMutex;
+		std::condition_variable   mCondition;
+		std::deque<Job>           mJobs;
+		bool                      mStopping = false;
+		std::vector<std::thread>  mWorkers;
+	};
+
+
+	Core::Result<TLSListener, Error> TLSListener::Bind(const Endpoint& endpoint, TLSContext context, const TLSListenerOptions& options)
+	{
+		auto listener = TCPListener::Bind(endpoint);
+		if (!listener)
+		{
+			return listener.Err();
+		}
+
+		std::unique_ptr<HandshakePool> pool;
+		if (options.handshakeWorkers > 0)
+		{
+			pool = std::make_unique<HandshakePool>(context, options.handshakeTimeout, options.handshakeWorkers);
+		}
+
+		return TLSListener(listener.Unwrap(), std::move(context), options.handshakeTimeout, std::move(pool));
+	}
+
+
+	TLSListener::TLSListener(TCPListener listener, TLSContext context, std::chrono::milliseconds handshakeTimeout, std::unique_ptr<HandshakePool> pool)
+		: mListener(std::move(listener))
+		, mContext(std::move(context))
+		, mHandshakeTimeout(handshakeTimeout)
+		, mPool(std::move(pool)) {}
+
+
+	TLSListener::TLSListener(TLSListener&& other) noexcept
+		: mListener(std::move(other.mListener))
+		, mContext(std::move(other.mContext))
+		, mHandshakeTimeout(other.mHandshakeTimeout)
+		, mPool(std::move(other.mPool)) {}
+
+
+	TLSListener& TLSListener::operator=(TLSListener&& other) noexcept
+	{
+		if (this != &other)
+		{
+			std::destroy_at(this);
+			std::construct_at(this, std::move(other));
+		}
+
+		return *this;
+	}
+
+
+	TLSListener::~TLSListener() = default;
+
+
+	Core::Result<TLSSocket, Error> TLSListener::Accept()
+	{
+		auto socket = mListener.Accept();
+		if (!socket)
+		{
+			return socket.Err();
+		}
+
+		return TLSSocket::Accept(socket.Unwrap(), mContext, mHandshakeTimeout);
+	}
+
+
+	Core::Result<void, Error> TLSListener::Accept(Handler handler)
+	{
+		auto socket = mListener.Accept();
+		if (!socket)
+		{
+			return socket.Err();
+		}
+
+		if (mPool)
+		{
+			mPool->Submit(socket.Unwrap(), std::move(handler));
+		}
+		else
+		{
+			handler(TLSSocket::Accept(socket.Unwrap(), mContext, mHandshakeTimeout));
+		}
+
+		return Core::Success;
+	}
+} // namespace Strawberry::Net::Socket
@@ -0,0 +1,75 @@
+#pragma once
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+// Strawberry Net
+#include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/Error.hpp"
+#include "Strawberry/Net/Socket/TCPListener.hpp"
+#include "Strawberry/Net/Socket/TLSContext.hpp"
+#include "Strawberry/Net/Socket/TLSSocket.hpp"
+// Strawberry Core
+#include "Strawberry/Core/Types/Result.hpp"
+// Standard Library
+#include <chrono>
+#include <functional>
+#include <memory>
+
+
+//======================================================================================================================
+//	Class Declaration
+//----------------------------------------------------------------------------------------------------------------------
+namespace Strawberry::Net::Socket
+{
+	/// Settings for binding a TLSListener.
+	struct TLSListenerOptions
+	{
+		/// With more than 0, handshakes started by Accept(Handler) run on a pool of this many threads,
+		/// so slow or numerous handshakes don't hold up accepting.
+		size_t                    handshakeWorkers = 0;
+		/// How long a client has to complete its handshake before the connection is dropped.
+		/// Negative waits indefinitely.
+		std::chrono::milliseconds handshakeTimeout = std::chrono::seconds(10);
+	};
+
+
+	/// Accepts TLS connections, using a context created with TLSContext::CreateServer.
+	class TLSListener
+	{
+	public:
+		/// Receives the result of a handshake started by Accept(Handler).
+		using Handler = std::function<void(Core::Result<TLSSocket, Error>)>;
+
+
+		/// Binds to the given endpoint.
+		static Core::Result<TLSListener, Error> Bind(const Endpoint& endpoint, TLSContext context, const TLSListenerOptions& options = {});
+
+
+		TLSListener(const TLSListener&)            = delete;
+		TLSListener& operator=(const TLSListener&) = delete;
+		TLSListener(TLSListener&& other) noexcept;
+		TLSListener& operator=(TLSListener&& other) noexcept;
+		/// Waits for queued handshakes to finish.
+		~TLSListener();
+
+
+		/// Accepts the next connection and completes its handshake on the calling thread.
+		Core::Result<TLSSocket, Error> Accept();
+		/// Accepts the next connection and hands its handshake to the worker pool.
+		/// The handler is called from a worker thread, or from the calling thread when there are no workers.
+		/// Errors are returned if accepting fails, and passed to the handler if the handshake does.
+		Core::Result<void, Error>      Accept(Handler handler);
+
+	private:
+		class HandshakePool;
+
+
+		TLSListener(TCPListener listener, TLSContext context, std::chrono::milliseconds handshakeTimeout, std::unique_ptr<HandshakePool> pool);
+
+
+		TCPListener                    mListener;
+		TLSContext                     mContext;
+		std::chrono::milliseconds      mHandshakeTimeout;
+		std::unique_ptr<HandshakePool> mPool;
+	};
+} // namespace Strawberry::Net::Socket
@@ -0,0 +1,158 @@
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+#include "Strawberry/Net/Socket/TLSSessionCache.hpp"
+// Strawberry Core
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/Logging.hpp"
+// Standard Library
+#include <ctime>
+
+
+namespace Strawberry::Net::Socket
+{
+	/// Frees the key string attached to an SSL object.
+	static void FreeKey(void*, void* key, CRYPTO_EX_DATA*, int, long, void*)
+	{
+		delete static_cast<std::string*>(key);
+	}
+
+
+	/// Returns the ex_data index under which connection keys are stored.
+	static int GetKeyIndex()
+	{
+		static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &FreeKey);
+		return index;
+	}
+
+
+	/// Returns whether a session can still be offered to the server.
+	static bool IsResumable(const SSL_SESSION* session)
+	{
+		if (!SSL_SESSION_is_resumable(session)) return false;
+
+		const auto expiry = SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session);
+		return std::time(nullptr) < expiry;
+	}
+
+
+	std::string TLSSessionCache::GetKey(const Endpoint& endpoint)
+	{
+		return endpoint.ToString();
+	}
+
+
+	void TLSSessionCache::SetKey(SSL* ssl, const std::string& key)
+	{
+		delete static_cast<std::string*>(SSL_get_ex_data(ssl, GetKeyIndex()));
+		SSL_set_ex_data(ssl, GetKeyIndex(), new std::string(key));
+	}
+
+
+	TLSSessionCache::TLSSessionCache(size_t capacity)
+		: mCapacity(capacity)
+	{
+		Core::Assert(mCapacity > 0);
+	}
+
+
+	TLSSessionCache::~TLSSessionCache()
+	{
+		Clear();
+	}
+
+
+	void TLSSessionCache::Attach(SSL_CTX* context)
+	{
+		// Clients only cache externally, through the callback.
+		SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_set_app_data(context, this);
+		SSL_CTX_sess_set_new_cb(context, &TLSSessionCache::OnNewSession);
+	}
+
+
+	SSL_SESSION* TLSSessionCache::Take(const std::string& key)
+	{
+		std::unique_lock lock(mMutex);
+
+		auto entry = mIndex.find(key);
+		if (entry == mIndex.end()) return nullptr;
+
+		SSL_SESSION* session = entry->second->session;
+		if (!IsResumable(session))
+		{
+			SSL_SESSION_free(session);
+			mEntries.erase(entry->second);
+			mIndex.erase(entry);
+			return nullptr;
+		}
+
+		if (SSL_SESSION_get_protocol_version(session) >= TLS1_3_VERSION)
+		{
+			mEntries.erase(entry->second);
+			mIndex.erase(entry);
+		}
+		else
+		{
+			SSL_SESSION_up_ref(session);
+		}
+
+		return session;
+	}
+
+
+	void TLSSessionCache::Store(const std::string& key, SSL_SESSION* session)
+	{
+		std::unique_lock lock(mMutex);
+
+		if (auto entry = mIndex.find(key); entry != mIndex.end())
+		{
+			SSL_SESSION_free(entry->second->session);
+			mEntries.erase(entry->second);
+			mIndex.erase(entry);
+		}
+		else if (mEntries.size() >= mCapacity)
+		{
+			SSL_SESSION_free(mEntries.back().session);
+			mIndex.erase(mEntries.back().key);
+			mEntries.pop_back();
+		}
+
+		mEntries.push_front(Entry{.key = key, .session = session});
+		mIndex.emplace(key, mEntries.begin());
+	}
+
+
+	void TLSSessionCache::Clear()
+	{
+		std::unique_lock lock(mMutex);
+
+		for (auto& entry : mEntries)
+		{
+			SSL_SESSION_free(entry.session);
+		}
+		mEntries.clear();
+		mIndex.clear();
+	}
+
+
+	size_t TLSSessionCache::Size() const
+	{
+		std::unique_lock lock(mMutex);
+		return mEntries.size();
+	}
+
+
+	int TLSSessionCache::OnNewSession(SSL* ssl, SSL_SESSION* session)
+	{
+		auto* cache = static_cast<TLSSessionCache*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+		auto* key   = static_cast<std::string*>(SSL_get_ex_data(ssl, GetKeyIndex()));
+		if (cache == nullptr || key == nullptr) return 0;
+
+		Core::Logging::Trace("Caching TLS session for {}", *key);
+		cache->Store(*key, session);
+
+		// Returning 1 tells OpenSSL that we have kept its reference to the session.
+		return 1;
+	}
+} // namespace Strawberry::Net::Socket
@@ -0,0 +1,75 @@
+#pragma once
+
+
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+// Strawberry Net
+#include "Strawberry/Net/Endpoint.hpp"
+// Open SSL
+#include <openssl/ssl.h>
+// Standard Library
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+namespace Strawberry::Net::Socket
+{
+	/// Thread-safe cache of client TLS sessions, keyed by hostname and port.
+	///
+	/// Stores TLS 1.3 session tickets and TLS 1.2 session IDs as the server hands them out,
+	/// so that later connections to the same upstream can resume instead of running a full handshake.
+	class TLSSessionCache
+	{
+	public:
+		static constexpr size_t DEFAULT_CAPACITY = 256;
+
+
+		/// Returns the cache key used for connections to the given endpoint.
+		static std::string GetKey(const Endpoint& endpoint);
+		/// Tags a connection with the key that its sessions should be stored under.
+		static void        SetKey(SSL* ssl, const std::string& key);
+
+	public:
+		explicit TLSSessionCache(size_t capacity = DEFAULT_CAPACITY);
+		TLSSessionCache(const TLSSessionCache&)            = delete;
+		TLSSessionCache& operator=(const TLSSessionCache&) = delete;
+		~TLSSessionCache();
+
+
+		/// Makes this cache receive every new session negotiated with the given context.
+		void Attach(SSL_CTX* context);
+
+
+		/// Returns a resumable session for the given key, or nullptr.
+		/// The caller owns the returned reference. TLS 1.3 tickets are removed from the cache,
+		/// since they should only be used once.
+		[[nodiscard]] SSL_SESSION* Take(const std::string& key);
+		/// Stores a session, taking ownership of the given reference.
+		void                       Store(const std::string& key, SSL_SESSION* session);
+		/// Removes all sessions.
+		void                       Clear();
+		/// Returns the number of cached sessions.
+		[[nodiscard]] size_t       Size() const;
+
+	private:
+		/// OpenSSL new session callback.
+		static int OnNewSession(SSL* ssl, SSL_SESSION* session);
+
+
+		struct Entry
+		{
+			std::string  key;
+			SSL_SESSION* session;
+		};
+
+
+		mutable std::mutex                                           mMutex;
+		size_t                                                       mCapacity;
+		/// Sessions ordered from most to least recently stored.
+		std::list<Entry>                                             mEntries;
+		std::unordered_map<std::string, std::list<Entry>::iterator> mIndex;
+	};
+} // namespace Strawberry::Net::Socket
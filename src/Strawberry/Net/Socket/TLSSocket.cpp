@@ -2,10 +2,16 @@
 //	Includes
 //----------------------------------------------------------------------------------------------------------------------
 #include "Strawberry/Net/Socket/TLSSocket.hpp"
+#include "Strawberry/Net/Socket/TLSContext.hpp"
+#include "Strawberry/Net/Socket/TLSSessionCache.hpp"
+#include "Strawberry/Net/Socket/Platform.hpp"
 // Core
 #include "Strawberry/Core/Assert.hpp"
 #include "Strawberry/Core/IO/Logging.hpp"
 // System
+#include <algorithm>
+#include <cerrno>
+#include <limits>
 #include <memory>
 #include <openssl/tls1.h>
 #include <openssl/err.h>
@@ -14,96 +20,238 @@
 #if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
 
 
+#include <poll.h>
 #include <unistd.h>
+#if STRAWBERRY_TARGET_LINUX
+#include <fcntl.h>
+#endif
+
+
+#elif STRAWBERRY_TARGET_WINDOWS
+
+
+#include <winsock2.h>
 
 
 #endif
 
 
-class TLSContext
+namespace Strawberry::Net::Socket
 {
-public:
-	static SSL_CTX* Get()
+	/// Waits up to timeout for the given socket to be ready for the given poll events, indefinitely if it is negative.
+	/// Returns whether it became ready.
+	static bool WaitForSocket(TCPSocket::SocketHandle handle, short events, std::chrono::milliseconds timeout)
 	{
-		if (!mInstance)
-		{
-			mInstance = std::unique_ptr<TLSContext>(new TLSContext());
-		}
-
-		return mInstance->mSSL_CONTEXT;
+		SOCKET_POLL_FD_TYPE fds[] = {
+			{ handle, events, 0}
+		};
+		return SOCKET_POLL_FUNCTION(fds, 1, static_cast<int>(std::max<std::chrono::milliseconds::rep>(timeout.count(), -1))) > 0;
 	}
 
 
-	~TLSContext()
+	Core::Result<TLSSocket, Error> TLSSocket::Connect(const Endpoint& endpoint)
 	{
-		SSL_CTX_free(mSSL_CONTEXT);
+		return Connect(endpoint, TLSConnectOptions{});
 	}
 
-private:
-	TLSContext()
-	{
-		SSL_library_init();
-		OpenSSL_add_all_algorithms();
-		SSL_load_error_strings();
 
-		mSSL_CONTEXT = SSL_CTX_new(TLS_client_method());
-		Strawberry::Core::Assert(mSSL_CONTEXT != nullptr);
+	Core::Result<TLSSocket, Error> TLSSocket::Connect(const Endpoint& endpoint, const TLSContext& context)
+	{
+		TLSConnectOptions options;
+		options.context = context;
+		return Connect(endpoint, options);
 	}
 
 
-	SSL_CTX* mSSL_CONTEXT;
-
-	static std::unique_ptr<TLSContext> mInstance;
-};
-
-
-std::unique_ptr<TLSContext> TLSContext::mInstance = nullptr;
+	Core::Result<TLSSocket, Error> TLSSocket::Connect(const Endpoint& endpoint, const Core::IO::DynamicByteBuffer& earlyData)
+	{
+		TLSConnectOptions options;
+		options.earlyData = earlyData;
+		return Connect(endpoint, options);
+	}
 
 
-namespace Strawberry::Net::Socket
-{
-	Core::Result<TLSSocket, Error> TLSSocket::Connect(const Endpoint& endpoint)
+	Core::Result<TLSSocket, Error> TLSSocket::Connect(const Endpoint& endpoint, const TLSConnectOptions& options)
 	{
-		auto tcp = TCPSocket::Connect(endpoint);
+		auto tcp = TCPSocket::Connect(endpoint, options.blocking);
 		if (!tcp)
 		{
 			return tcp.Err();
 		}
 
-		auto ssl = SSL_new(TLSContext::Get());
+		const TLSContext& context = options.context ? options.context.Value() : TLSContext::Default();
+		auto ssl = SSL_new(context.GetHandle());
 		if (ssl == nullptr)
 		{
 			return ErrorSSLAllocation {};
 		}
 
-		if (endpoint.GetHostname())
+		// Endpoints without a hostname were given by address, so the certificate must have been issued for that.
+		auto identity = endpoint.GetHostname() ? endpoint.GetHostname() : Core::Optional<std::string>(endpoint.GetAddress().AsString());
+		if (auto identityResult = context.SetPeerIdentity(ssl, identity); !identityResult)
 		{
-			auto hostnameResult = SSL_set_tlsext_host_name(ssl, endpoint.GetHostname()->c_str());
-			Core::Assert(hostnameResult);
+			SSL_free(ssl);
+			return identityResult.Err();
+		}
+
+		// OpenSSL installs the keys into the kernel as they are negotiated,
+		// and silently stays in user space if it cannot.
+		if (options.kernelTLS)
+		{
+			SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);
+		}
+		// Otherwise non-blocking sockets pull as many records as are available into OpenSSL with each receive.
+		// Kernel TLS receive can't be combined with read ahead, and blocking sockets read one record at a time,
+		// so that whatever has been received but not decrypted is still on the socket for Poll() to see.
+		else if (!options.blocking)
+		{
+			SSL_set_read_ahead(ssl, 1);
+		}
+
+		// Non-blocking writes may be partial, and are retried from the pending write buffer.
+		if (!options.blocking)
+		{
+			SSL_set_mode(ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 		}
 
 		SSL_set_fd(ssl, tcp->mSocket);
-		auto connectResult = SSL_connect(ssl);
-		if (connectResult == -1)
+		SSL_set_connect_state(ssl);
+		TLSSocket tls(tcp.Unwrap(), ssl, endpoint, context);
+		tls.mBlocking = options.blocking;
+		tls.SetRecordSizing(options.recordSizing);
+		const auto* earlyData = options.earlyData ? &options.earlyData.Value() : nullptr;
+
+		// Offer a cached session, and have any new sessions stored under this endpoint.
+		const auto cacheKey = TLSSessionCache::GetKey(endpoint);
+		TLSSessionCache::SetKey(ssl, cacheKey);
+		bool earlyDataSent = false;
+		if (SSL_SESSION* session = context.GetSessionCache().Take(cacheKey))
+		{
+			SSL_set_session(ssl, session);
+
+			if (options.blocking && earlyData && earlyData->Size() > 0 && SSL_SESSION_get_max_early_data(session) >= earlyData->Size())
+			{
+				size_t written = 0;
+				earlyDataSent = SSL_write_early_data(ssl, earlyData->Data(), earlyData->Size(), &written) == 1
+					&& written == earlyData->Size();
+			}
+
+			SSL_SESSION_free(session);
+		}
+
+		// Non-blocking sockets hand the handshake over to the caller's event loop.
+		if (!options.blocking)
+		{
+			if (earlyData && earlyData->Size() > 0)
+			{
+				tls.mPendingWrite = *earlyData;
+			}
+
+			return tls;
+		}
+
+		if (auto handshakeResult = tls.Handshake(); !handshakeResult)
+		{
+			return handshakeResult.Err();
+		}
+
+		// Early data which wasn't sent, or was rejected, has to go over the established connection.
+		if (earlyData && earlyData->Size() > 0 && !tls.WasEarlyDataAccepted())
+		{
+			if (earlyDataSent)
+			{
+				Core::Logging::Info("Early data rejected by {}, resending.", endpoint.ToString());
+			}
+
+			if (auto writeResult = tls.Write(*earlyData); !writeResult)
+			{
+				return writeResult.Err();
+			}
+		}
+
+		return tls;
+	}
+
+
+	Core::Result<TLSSocket, Error> TLSSocket::Accept(TCPSocket socket, const TLSContext& context, std::chrono::milliseconds timeout)
+	{
+		auto ssl = SSL_new(context.GetHandle());
+		if (ssl == nullptr)
+		{
+			return ErrorSSLAllocation {};
+		}
+
+		SSL_set_fd(ssl, socket.GetHandle());
+		SSL_set_accept_state(ssl);
+
+		auto endpoint = socket.GetEndpoint();
+		TLSSocket tls(std::move(socket), ssl, std::move(endpoint), context);
+		if (timeout.count() < 0)
+		{
+			if (auto handshakeResult = tls.Handshake(); !handshakeResult)
+			{
+				return handshakeResult.Err();
+			}
+
+			return tls;
+		}
+
+		// Handshake without blocking, so that a client which stops responding can't hold up the caller past the deadline.
+		if (auto blockingResult = tls.mTCP.SetBlocking(false); !blockingResult)
+		{
+			return blockingResult.Err();
+		}
+
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		while (true)
+		{
+			auto handshakeResult = tls.Handshake();
+			if (handshakeResult) break;
+			if (!handshakeResult.Err().IsType<ErrorWantRead>() && !handshakeResult.Err().IsType<ErrorWantWrite>())
+			{
+				return handshakeResult.Err();
+			}
+
+			auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+			if (remaining.count() <= 0
+				|| !WaitForSocket(tls.GetHandle(), handshakeResult.Err().IsType<ErrorWantRead>() ? POLLIN : POLLOUT, remaining))
+			{
+				Core::Logging::Error("TLS handshake with {} timed out.", tls.mEndpoint.ToString());
+				return ErrorTimeout {};
+			}
+		}
+
+		if (auto blockingResult = tls.mTCP.SetBlocking(true); !blockingResult)
 		{
-			return ErrorSSLHandshake {};
+			return blockingResult.Err();
 		}
 
-		TLSSocket tls(tcp.Unwrap(), ssl, endpoint);
 		return tls;
 	}
 
 
-	TLSSocket::TLSSocket(TCPSocket socket, SSL* ssl, Endpoint endpoint)
+	TLSSocket::TLSSocket(TCPSocket socket, SSL* ssl, Endpoint endpoint, TLSContext context)
 		: mTCP(std::move(socket))
 		, mSSL(ssl)
-		, mEndpoint(std::move(endpoint)) {}
+		, mEndpoint(std::move(endpoint))
+		, mContext(std::move(context)) {}
 
 
 	TLSSocket::TLSSocket(TLSSocket&& other) noexcept
 		: mTCP(std::move(other.mTCP))
 		, mSSL(std::exchange(other.mSSL, nullptr))
-		, mEndpoint(other.GetEndpoint()) {}
+		, mEndpoint(other.GetEndpoint())
+		, mContext(other.mContext)
+		, mBlocking(other.mBlocking)
+		, mKernelSend(other.mKernelSend)
+		, mBuffer(std::move(other.mBuffer))
+		, mPartialRead(std::move(other.mPartialRead))
+		, mPendingWrite(std::move(other.mPendingWrite))
+		, mRetryLength(other.mRetryLength)
+		, mRecordSizing(other.mRecordSizing)
+		, mRecordSize(other.mRecordSize)
+		, mBytesSinceIdle(other.mBytesSinceIdle)
+		, mLastWrite(other.mLastWrite) {}
 
 
 	TLSSocket& TLSSocket::operator=(TLSSocket&& other) noexcept
@@ -122,14 +270,9 @@ namespace Strawberry::Net::Socket
 	{
 		if (mSSL)
 		{
-			SSL_shutdown(mSSL);
-
-#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
-			close(mTCP.mSocket);
-#elif STRAWBERRY_TARGET_WINDOWS
-			closesocket(mTCP.mSocket);
-#endif
-
+			// Only send close_notify over connections which completed their handshake.
+			// The underlying socket is closed by mTCP.
+			if (SSL_is_init_finished(mSSL)) SSL_shutdown(mSSL);
 			SSL_free(mSSL);
 		}
 	}
@@ -141,22 +284,256 @@ namespace Strawberry::Net::Socket
 	}
 
 
-	bool TLSSocket::Poll() const
+	const TLSContext& TLSSocket::GetContext() const noexcept
+	{
+		return mContext;
+	}
+
+
+	TCPSocket::SocketHandle TLSSocket::GetHandle() const noexcept
+	{
+		return mTCP.GetHandle();
+	}
+
+
+	bool TLSSocket::IsHandshakeComplete() const
+	{
+		return SSL_is_init_finished(mSSL);
+	}
+
+
+	Core::Result<void, Error> TLSSocket::Handshake()
+	{
+		if (IsHandshakeComplete())
+		{
+			return Core::Success;
+		}
+
+		auto handshakeResult = SSL_do_handshake(mSSL);
+		if (handshakeResult != 1)
+		{
+			switch (auto error = SSL_get_error(mSSL, handshakeResult))
+			{
+			case SSL_ERROR_WANT_READ: return ErrorWantRead {};
+			case SSL_ERROR_WANT_WRITE: return ErrorWantWrite {};
+			default:
+				Core::Logging::Error("TLS handshake with {} failed. Error code: {}.", mEndpoint.ToString(), error);
+				if (auto verifyResult = SSL_get_verify_result(mSSL); verifyResult != X509_V_OK)
+				{
+					Core::Logging::Error("Certificate verification failed: {}.", X509_verify_cert_error_string(verifyResult));
+				}
+				return ErrorSSLHandshake {};
+			}
+		}
+
+		mKernelSend = IsKernelSendEnabled();
+		if (SSL_get_options(mSSL) & SSL_OP_ENABLE_KTLS)
+		{
+			Core::Logging::Info("Kernel TLS for {}: send {}, receive {}.", mEndpoint.ToString(),
+								mKernelSend ? "enabled" : "unavailable",
+								IsKernelReceiveEnabled() ? "enabled" : "unavailable");
+		}
+
+		// Writes queued while handshaking can go out now. Anything left over is reported by WantsWrite().
+		if (auto flushResult = Flush(); !flushResult && !flushResult.Err().IsType<ErrorWantWrite>() && !flushResult.Err().IsType<ErrorWantRead>())
+		{
+			return flushResult;
+		}
+
+		return Core::Success;
+	}
+
+
+	bool TLSSocket::WantsWrite() const
+	{
+		return mPendingWrite.Size() > 0;
+	}
+
+
+	Core::Result<void, Error> TLSSocket::Flush()
+	{
+		if (mPendingWrite.Size() == 0)
+		{
+			return Core::Success;
+		}
+
+		// Completing the handshake flushes the queue.
+		if (!IsHandshakeComplete())
+		{
+			if (auto handshakeResult = Handshake(); !handshakeResult)
+			{
+				return handshakeResult;
+			}
+
+			return WantsWrite() ? Core::Result<void, Error>(ErrorWantWrite {}) : Core::Success;
+		}
+
+		size_t bytesSent = 0;
+		Core::Result<void, Error> result = Core::Success;
+		while (bytesSent < mPendingWrite.Size())
+		{
+			// A write which would have blocked must be retried with the same length, and so the same record size.
+			// SSL_write takes an int, so larger writes go out over several calls.
+			int length = mRetryLength > 0 ? mRetryLength : static_cast<int>(std::min<size_t>(BeginRecords(mPendingWrite.Size() - bytesSent), std::numeric_limits<int>::max()));
+			auto writeResult = SSL_write(mSSL, mPendingWrite.Data() + bytesSent, length);
+			if (writeResult > 0)
+			{
+				mRetryLength = 0;
+				bytesSent += writeResult;
+				EndRecords(writeResult);
+				continue;
+			}
+
+			switch (int error = SSL_get_error(mSSL, writeResult))
+			{
+			case SSL_ERROR_WANT_WRITE: result = ErrorWantWrite {}; mRetryLength = length; break;
+			case SSL_ERROR_WANT_READ: result = ErrorWantRead {}; mRetryLength = length; break;
+			case SSL_ERROR_SSL: return ErrorOpenSSL {};
+			case SSL_ERROR_SYSCALL: return ErrorSystem {};
+			case SSL_ERROR_ZERO_RETURN: return ErrorConnectionReset {};
+			default:
+				Core::Logging::Error("Unknown SSL_write error code: {}", error);
+				Core::Unreachable();
+			}
+			break;
+		}
+
+		mPendingWrite = Core::IO::DynamicByteBuffer(mPendingWrite.Data() + bytesSent, mPendingWrite.Size() - bytesSent);
+		return result;
+	}
+
+
+	Core::Optional<std::string> TLSSocket::GetALPNProtocol() const
 	{
-		return mTCP.Poll();
+		const unsigned char* protocol = nullptr;
+		unsigned int         length   = 0;
+		SSL_get0_alpn_selected(mSSL, &protocol, &length);
+		if (protocol == nullptr || length == 0) return {};
+		return std::string(reinterpret_cast<const char*>(protocol), length);
+	}
+
+
+	bool TLSSocket::IsSessionReused() const
+	{
+		return SSL_session_reused(mSSL) == 1;
+	}
+
+
+	bool TLSSocket::WasEarlyDataAccepted() const
+	{
+		return SSL_get_early_data_status(mSSL) == SSL_EARLY_DATA_ACCEPTED;
+	}
+
+
+	bool TLSSocket::IsKernelSendEnabled() const
+	{
+		return BIO_get_ktls_send(SSL_get_wbio(mSSL)) == 1;
+	}
+
+
+	bool TLSSocket::IsKernelReceiveEnabled() const
+	{
+		return BIO_get_ktls_recv(SSL_get_rbio(mSSL)) == 1;
+	}
+
+
+	void TLSSocket::SetRecordSizing(const TLSRecordSizing& recordSizing)
+	{
+		// OpenSSL doesn't accept records smaller than 512 bytes.
+		Core::Assert(recordSizing.smallRecordSize >= 512 && recordSizing.smallRecordSize <= TLSRecordSizing::MAX_RECORD_SIZE);
+		mRecordSizing = recordSizing;
+	}
+
+
+	size_t TLSSocket::BeginRecords(size_t length)
+	{
+		if (std::chrono::steady_clock::now() - mLastWrite > mRecordSizing.idleTimeout)
+		{
+			mBytesSinceIdle = 0;
+		}
+
+		const bool   small      = mRecordSizing.enabled && mBytesSinceIdle < mRecordSizing.rampThreshold;
+		const size_t recordSize = small ? mRecordSizing.smallRecordSize : TLSRecordSizing::MAX_RECORD_SIZE;
+		if (recordSize != mRecordSize)
+		{
+			SSL_set_max_send_fragment(mSSL, recordSize);
+			mRecordSize = recordSize;
+		}
+
+		// Stop at the threshold, so the rest goes out in full size records.
+		return small ? std::min(length, mRecordSizing.rampThreshold - mBytesSinceIdle) : length;
+	}
+
+
+	void TLSSocket::EndRecords(size_t bytesWritten)
+	{
+		mBytesSinceIdle += bytesWritten;
+		mLastWrite       = std::chrono::steady_clock::now();
+	}
+
+
+	bool TLSSocket::Poll(std::chrono::milliseconds timeout) const
+	{
+		// Records are read from the socket whole, or several at once with read ahead,
+		// so data can be waiting in OpenSSL while the socket is empty.
+		if (HasBufferedRecord())
+		{
+			return true;
+		}
+
+		return mTCP.Poll(timeout);
+	}
+
+
+	bool TLSSocket::HasBufferedRecord() const
+	{
+		if (SSL_pending(mSSL) > 0)
+		{
+			return true;
+		}
+
+		// Received records which haven't been decrypted only build up with read ahead, on non-blocking sockets.
+		// They may end with a partial record, so peeking is the only way to tell whether there is a whole one.
+		if (mBlocking || !SSL_has_pending(mSSL))
+		{
+			return false;
+		}
+
+		uint8_t byte;
+		auto    peekResult = SSL_peek(mSSL, &byte, 1);
+		// Errors are reported as readable, so that the next read returns them.
+		return peekResult > 0 || SSL_get_error(mSSL, peekResult) != SSL_ERROR_WANT_READ;
 	}
 
 
 	StreamReadResult TLSSocket::Read(size_t length)
 	{
-		auto buffer = Core::IO::DynamicByteBuffer::Zeroes(length);
+		if (mBuffer.Size() < length) mBuffer = Core::IO::DynamicByteBuffer::Zeroes(length);
 
-		auto thisRead = SSL_read(mSSL, reinterpret_cast<void*>(buffer.Data()), static_cast<int>(length));
+		auto readResult = ReadInto({mBuffer.Data(), length});
+		if (!readResult)
+		{
+			return readResult.Err();
+		}
+
+		return Core::IO::DynamicByteBuffer(mBuffer.Data(), readResult.Unwrap());
+	}
+
+
+	Core::Result<size_t, Error> TLSSocket::ReadInto(std::span<uint8_t> buffer)
+	{
+		const int length = static_cast<int>(std::min<size_t>(buffer.size(), std::numeric_limits<int>::max()));
+
+		// With kernel TLS receive, SSL_read only collects already decrypted records and handles control messages.
+		auto thisRead = SSL_read(mSSL, buffer.data(), length);
 		if (thisRead <= 0)
 		{
 			auto error = SSL_get_error(mSSL, thisRead);
 			switch (error)
 			{
+			// Blocking sockets only get this when a system call was interrupted.
+			case SSL_ERROR_WANT_READ: return mBlocking ? ReadInto(buffer) : Error(ErrorNoData {});
+			case SSL_ERROR_WANT_WRITE: return Error(ErrorWantWrite {});
 			case SSL_ERROR_ZERO_RETURN: return Error(ErrorConnectionReset {});
 			case SSL_ERROR_SYSCALL: return Error(ErrorSystem {});
 			case SSL_ERROR_SSL: return Error(ErrorOpenSSL {});
@@ -165,51 +542,88 @@ namespace Strawberry::Net::Socket
 			}
 		}
 
-		Core::Assert(thisRead > 0);
-		buffer.Resize(thisRead);
-		return buffer;
+		int bytesRead = thisRead;
+
+		// Keep decrypting records which are already buffered, instead of returning one record per call.
+		while (bytesRead < length && HasBufferedRecord())
+		{
+			thisRead = SSL_read(mSSL, buffer.data() + bytesRead, length - bytesRead);
+			if (thisRead <= 0) break;
+			bytesRead += thisRead;
+		}
+
+		return static_cast<size_t>(bytesRead);
 	}
 
 
 	StreamReadResult TLSSocket::ReadAll(size_t length)
 	{
-		auto buffer = Core::IO::DynamicByteBuffer::WithCapacity(length);
-
-		while (buffer.Size() < length)
+		while (mPartialRead.Size() < length)
 		{
-			auto read = Read(length - buffer.Size());
+			const size_t offset = mPartialRead.Size();
+			mPartialRead.Resize(length);
 
-			if (read.IsOk())
-			{
-				buffer.Push(read.Unwrap());
-			}
-			else
+			auto read = ReadInto({mPartialRead.Data() + offset, length - offset});
+			mPartialRead.Resize(offset + (read ? *read : 0));
+			// Non-blocking sockets keep what has been decrypted for the next call.
+			if (!read)
 			{
 				return read.Err();
 			}
 		}
 
-		return buffer;
+		return std::exchange(mPartialRead, {});
 	}
 
 
 	StreamWriteResult TLSSocket::Write(const Core::IO::DynamicByteBuffer& bytes)
 	{
-		int bytesSent = 0;
+		return Write(std::span<const uint8_t>(bytes.Data(), bytes.Size()));
+	}
+
+
+	StreamWriteResult TLSSocket::Write(std::span<const uint8_t> bytes)
+	{
+		// Non-blocking writes are queued behind any earlier unsent data.
+		if (!mBlocking)
+		{
+			mPendingWrite.Push(bytes.data(), bytes.size());
+			auto flushResult = Flush();
+			if (!flushResult && (flushResult.Err().IsType<ErrorWantWrite>() || flushResult.Err().IsType<ErrorWantRead>()))
+			{
+				return Core::Success;
+			}
 
-		while (bytesSent < bytes.Size())
+			return flushResult;
+		}
+
+		// The kernel frames and encrypts plain writes itself.
+		if (mKernelSend)
 		{
-			auto writeResult = SSL_write(mSSL, bytes.Data() + bytesSent, bytes.Size() - bytesSent);
+			return mTCP.Write(bytes);
+		}
+
+		size_t bytesSent = 0;
+
+		while (bytesSent < bytes.size())
+		{
+			int  length      = mRetryLength > 0 ? mRetryLength : static_cast<int>(std::min<size_t>(BeginRecords(bytes.size() - bytesSent), std::numeric_limits<int>::max()));
+			auto writeResult = SSL_write(mSSL, bytes.data() + bytesSent, length);
 
 			if (writeResult > 0)
 			{
+				mRetryLength = 0;
 				bytesSent += writeResult;
+				EndRecords(writeResult);
 			}
 			else
 			{
 				int error = SSL_get_error(mSSL, writeResult);
 				switch (error)
 				{
+				// A system call was interrupted, so the same write is retried with the same length.
+				case SSL_ERROR_WANT_READ:
+				case SSL_ERROR_WANT_WRITE: mRetryLength = length; continue;
 				case SSL_ERROR_SSL: return ErrorOpenSSL {};
 				case SSL_ERROR_SYSCALL: return ErrorSystem {};
 				case SSL_ERROR_ZERO_RETURN: return ErrorConnectionReset {};
@@ -220,4 +634,96 @@ namespace Strawberry::Net::Socket
 
 		return Core::Success;
 	}
+
+
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+	StreamWriteResult TLSSocket::SendFile(int fileDescriptor, off_t offset, size_t length)
+	{
+		if (mKernelSend)
+		{
+			while (length > 0)
+			{
+				auto sent = SSL_sendfile(mSSL, fileDescriptor, offset, length, 0);
+				if (sent <= 0)
+				{
+					Core::Logging::Error("SSL_sendfile failed on {}. Error code: {}.", mEndpoint.ToString(), SSL_get_error(mSSL, static_cast<int>(sent)));
+					return ErrorSystem {};
+				}
+
+				offset += sent;
+				length -= sent;
+			}
+
+			return Core::Success;
+		}
+
+		// Without kernel TLS the file has to pass through OpenSSL.
+		auto chunk = Core::IO::DynamicByteBuffer::Zeroes(std::min(length, COPY_CHUNK_SIZE));
+		while (length > 0)
+		{
+			auto bytesRead = pread(fileDescriptor, chunk.Data(), std::min(length, chunk.Size()), offset);
+			if (bytesRead <= 0)
+			{
+				Core::Logging::Error("Failed to read file for TLSSocket::SendFile. Error code: {}.", errno);
+				return ErrorSystem {};
+			}
+
+			if (auto writeResult = Write(std::span<const uint8_t>(chunk.Data(), bytesRead)); !writeResult)
+			{
+				return writeResult;
+			}
+
+			offset += bytesRead;
+			length -= bytesRead;
+		}
+
+		return Core::Success;
+	}
+#endif
+
+
+#if STRAWBERRY_TARGET_LINUX
+	StreamWriteResult TLSSocket::Splice(int pipeDescriptor, size_t length)
+	{
+		if (mKernelSend)
+		{
+			while (length > 0)
+			{
+				auto moved = splice(pipeDescriptor, nullptr, mTCP.mSocket, nullptr, length, SPLICE_F_MOVE | SPLICE_F_MORE);
+				if (moved < 0 && errno == EINTR) continue;
+				if (moved <= 0)
+				{
+					Core::Logging::Error("Failed to splice into TLSSocket for {}. Error code: {}.", mEndpoint.ToString(), errno);
+					return ErrorSystem {};
+				}
+
+				length -= moved;
+			}
+
+			return Core::Success;
+		}
+
+		// Without kernel TLS the data has to pass through OpenSSL.
+		auto chunk = Core::IO::DynamicByteBuffer::Zeroes(std::min(length, COPY_CHUNK_SIZE));
+		while (length > 0)
+		{
+			auto bytesRead = read(pipeDescriptor, chunk.Data(), std::min(length, chunk.Size()));
+			if (bytesRead < 0 && errno == EINTR) continue;
+			if (bytesRead <= 0)
+			{
+				Core::Logging::Error("Failed to read pipe for TLSSocket::Splice. Error code: {}.", errno);
+				return ErrorSystem {};
+			}
+
+			if (auto writeResult = Write(std::span<const uint8_t>(chunk.Data(), bytesRead)); !writeResult)
+			{
+				return writeResult;
+			}
+
+			length -= bytesRead;
+		}
+
+		return Core::Success;
+	}
+#endif
 } // namespace Strawberry::Net::Socket
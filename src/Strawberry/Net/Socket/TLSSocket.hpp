@@ -5,12 +5,18 @@
 //======================================================================================================================
 #include "Strawberry/Net/Error.hpp"
 #include "Strawberry/Net/Socket/TCPSocket.hpp"
+#include "Strawberry/Net/Socket/TLSContext.hpp"
 #include "Strawberry/Core/Types/Optional.hpp"
 // Open SSL
 #include <openssl/ssl.h>
 // Standard Library
+#include <chrono>
 #include <memory>
+#include <span>
 #include <string>
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+#include <sys/types.h>
+#endif
 
 
 //======================================================================================================================
@@ -18,10 +24,63 @@
 //======================================================================================================================
 namespace Strawberry::Net::Socket
 {
+	/// Controls the size of the TLS records a socket sends.
+	///
+	/// A record can only be decrypted once all of it has arrived, so small records get the first bytes to the peer
+	/// sooner while the congestion window is small. Full size records have less overhead for bulk transfers.
+	struct TLSRecordSizing
+	{
+		/// Whether to vary record sizes. Otherwise every record is up to MAX_RECORD_SIZE bytes.
+		bool                      enabled          = true;
+		/// Plaintext bytes per record at the start of a connection, chosen so each record fits one TCP segment.
+		size_t                    smallRecordSize  = 1400;
+		/// Bytes to send in small records before switching to full size records.
+		size_t                    rampThreshold    = 128 * 1024;
+		/// Going this long without writing returns to small records, since the congestion window may have shrunk.
+		std::chrono::milliseconds idleTimeout      = std::chrono::seconds(1);
+
+
+		/// The largest record size TLS allows.
+		static constexpr size_t MAX_RECORD_SIZE = 16 * 1024;
+	};
+
+
+	/// Optional behaviour for establishing TLS connections.
+	struct TLSConnectOptions
+	{
+		/// The context to connect with. Defaults to TLSContext::Default().
+		Core::Optional<TLSContext>                  context;
+		/// Data to send as TLS 1.3 early data, see TLSSocket::Connect.
+		Core::Optional<Core::IO::DynamicByteBuffer> earlyData;
+		/// Hand record encryption over to the kernel after the handshake (Linux kTLS).
+		/// Falls back to encrypting in user space when the kernel doesn't support the negotiated cipher,
+		/// or the tls module isn't available.
+		bool                                        kernelTLS = false;
+		/// Whether Connect and I/O block. Non-blocking sockets are returned before the handshake,
+		/// which is then driven with Handshake(). Early data is sent once the handshake completes.
+		bool                                        blocking  = true;
+		/// How the socket sizes the records it sends.
+		TLSRecordSizing                             recordSizing;
+	};
+
+
 	class TLSSocket
 	{
 	public:
+		/// Connects to the given endpoint, resuming a cached session for it where possible.
 		static Core::Result<TLSSocket, Error> Connect(const Endpoint& endpoint);
+		/// Connects to the given endpoint using the given context.
+		static Core::Result<TLSSocket, Error> Connect(const Endpoint& endpoint, const TLSContext& context);
+		/// Connects to the given endpoint with the given options.
+		static Core::Result<TLSSocket, Error> Connect(const Endpoint& endpoint, const TLSConnectOptions& options);
+		/// Connects and sends the given data, as TLS 1.3 early data if a resumable session permits it.
+		///
+		/// Early data can be replayed by an attacker, so this must only be used for idempotent requests.
+		/// If the server rejects the early data, it is sent again once the handshake completes.
+		static Core::Result<TLSSocket, Error> Connect(const Endpoint& endpoint, const Core::IO::DynamicByteBuffer& earlyData);
+		/// Performs the server side of the handshake over an accepted connection, using a context from TLSContext::CreateServer.
+		/// Fails with ErrorTimeout if the handshake hasn't completed within timeout, unless it is negative.
+		static Core::Result<TLSSocket, Error> Accept(TCPSocket socket, const TLSContext& context, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
 
 	public:
 		TLSSocket(const TLSSocket& other) = delete;
@@ -32,19 +91,116 @@ namespace Strawberry::Net::Socket
 
 
 		Endpoint GetEndpoint() const;
+		/// Returns the context this socket was connected or accepted with.
+		const TLSContext& GetContext() const noexcept;
+		/// Returns the platform handle of the underlying socket, for registering with an event loop.
+		TCPSocket::SocketHandle GetHandle() const noexcept;
+
 
+		//======================================================================================================================
+		//	Non-blocking operation
+		//----------------------------------------------------------------------------------------------------------------------
+		/// Returns whether the TLS handshake has completed.
+		[[nodiscard]] bool IsHandshakeComplete() const;
+		/// Advances the handshake as far as possible without blocking.
+		///
+		/// Returns success once the handshake is complete. ErrorWantRead or ErrorWantWrite mean
+		/// that this should be called again once the socket is readable or writable.
+		Core::Result<void, Error> Handshake();
+		/// Returns whether written data is still queued, waiting for the socket to become writable.
+		[[nodiscard]] bool WantsWrite() const;
+		/// Sends as much queued data as possible without blocking.
+		/// Returns ErrorWantWrite or ErrorWantRead if data remains queued.
+		Core::Result<void, Error> Flush();
 
-		[[nodiscard]] bool Poll() const;
+
+		/// Returns the application protocol agreed through ALPN, if any.
+		[[nodiscard]] Core::Optional<std::string> GetALPNProtocol() const;
+		/// Returns whether the handshake resumed a previous session.
+		[[nodiscard]] bool IsSessionReused() const;
+		/// Returns whether the server accepted the early data sent by Connect.
+		[[nodiscard]] bool WasEarlyDataAccepted() const;
+		/// Returns whether outgoing records are encrypted by the kernel.
+		[[nodiscard]] bool IsKernelSendEnabled() const;
+		/// Returns whether incoming records are decrypted by the kernel.
+		[[nodiscard]] bool IsKernelReceiveEnabled() const;
+
+
+		/// Changes how records sent from now on are sized. Has no effect with kernel TLS, where the kernel frames records.
+		void SetRecordSizing(const TLSRecordSizing& recordSizing);
+
+
+		/// Returns whether there is data to read, either already decrypted by OpenSSL or waiting on the socket.
+		/// Waits up to timeout for the socket to become readable, indefinitely if it is negative.
+		[[nodiscard]] bool Poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) const;
+		/// Reads up to length bytes. Non-blocking sockets return ErrorNoData when there is nothing to read,
+		/// and ErrorWantWrite when OpenSSL must send data before it can read.
 		StreamReadResult   Read(size_t length);
+		/// Reads up to buffer.size() bytes straight into the buffer, and returns how many were read.
+		/// Errors are the same as for Read().
+		Core::Result<size_t, Error> ReadInto(std::span<uint8_t> buffer);
+		/// Reads exactly length bytes. Non-blocking sockets return ErrorNoData or ErrorWantWrite until they have all arrived,
+		/// keeping those which have, so the call should be repeated with the same length once the socket is ready.
 		StreamReadResult   ReadAll(size_t length);
+		/// Writes the given bytes. Non-blocking sockets queue whatever cannot be sent immediately, see Flush().
 		StreamWriteResult  Write(const Core::IO::DynamicByteBuffer& bytes);
+		/// Writes the given bytes, without them having to be copied into a buffer first.
+		StreamWriteResult  Write(std::span<const uint8_t> bytes);
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		/// Sends length bytes of the given file, starting from offset.
+		///
+		/// With kernel TLS the file is sent without copying it through user space.
+		/// Otherwise it is read and encrypted in chunks.
+		StreamWriteResult  SendFile(int fileDescriptor, off_t offset, size_t length);
+#endif
+#if STRAWBERRY_TARGET_LINUX
+		/// Sends length bytes read from the given pipe, such as one which data from another socket has been spliced into.
+		///
+		/// With kernel TLS the data is spliced from the pipe into the connection without copying it through user space.
+		/// Otherwise it is read and encrypted in chunks.
+		StreamWriteResult  Splice(int pipeDescriptor, size_t length);
+#endif
 
 	private:
-		TLSSocket(TCPSocket socket, SSL* ssl, Endpoint endpoint);
+		/// How much of a file or pipe is read and encrypted at a time, without kernel TLS.
+		static constexpr size_t COPY_CHUNK_SIZE = 64 * 1024;
+
+
+		TLSSocket(TCPSocket socket, SSL* ssl, Endpoint endpoint, TLSContext context);
+
+
+		/// Sets the record size for the next write, returning how many of the given bytes to write with it.
+		size_t BeginRecords(size_t length);
+		/// Accounts for bytes which were written.
+		void   EndRecords(size_t bytesWritten);
+		/// Returns whether a read would find data which has already been received, without waiting on the socket.
+		[[nodiscard]] bool HasBufferedRecord() const;
 
 
 		TCPSocket mTCP;
 		SSL*	  mSSL;
 		Endpoint  mEndpoint;
+		/// Keeps the context, and the session cache its callbacks refer to, alive for this connection.
+		TLSContext mContext;
+		/// Whether operations on this socket may block.
+		bool      mBlocking   = true;
+		/// Whether the kernel encrypts outgoing records, so writes can bypass OpenSSL.
+		bool      mKernelSend = false;
+		/// Buffer which Read() decrypts records into.
+		Core::IO::DynamicByteBuffer mBuffer;
+		/// Plaintext decrypted by a non-blocking ReadAll() which is waiting for the rest.
+		Core::IO::DynamicByteBuffer mPartialRead;
+		/// Plaintext accepted by Write() which could not yet be sent.
+		Core::IO::DynamicByteBuffer mPendingWrite;
+		/// Length of an SSL_write which must be retried with the same length, or 0.
+		int                         mRetryLength = 0;
+
+
+		TLSRecordSizing                       mRecordSizing;
+		/// The record size OpenSSL is currently set to.
+		size_t                                mRecordSize     = TLSRecordSizing::MAX_RECORD_SIZE;
+		/// Bytes sent since the connection started or last became idle.
+		size_t                                mBytesSinceIdle = 0;
+		std::chrono::steady_clock::time_point mLastWrite;
 	};
 } // namespace Strawberry::Net::Socket
@@ -0,0 +1,165 @@
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+// Strawberry Net
+#include "Strawberry/Net/Socket/Timestamp.hpp"
+#include "Strawberry/Net/Socket/API.hpp"
+#include "Strawberry/Net/Socket/Platform.hpp"
+// Strawberry Core
+#include "Strawberry/Core/IO/Logging.hpp"
+// Standard Library
+#include <cerrno>
+#include <cstring>
+// Platform specific networking headers
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+#include <ctime>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
+#if STRAWBERRY_TARGET_LINUX
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#endif
+
+
+namespace Strawberry::Net::Socket
+{
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+	static Timestamp ToTimestamp(const timespec& time)
+	{
+		return Timestamp(std::chrono::duration_cast<Timestamp::duration>(
+			std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec)));
+	}
+
+
+	static Timestamp ToTimestamp(const timeval& time)
+	{
+		return Timestamp(std::chrono::duration_cast<Timestamp::duration>(
+			std::chrono::seconds(time.tv_sec) + std::chrono::microseconds(time.tv_usec)));
+	}
+
+
+	Core::Result<void, Error> Timestamping::SetReceive(int socket, bool enabled)
+	{
+		SOCKET_OPTION_TYPE value = enabled ? 1 : 0;
+#if STRAWBERRY_TARGET_LINUX
+		auto result = setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &value, sizeof(value));
+#else
+		auto result = setsockopt(socket, SOL_SOCKET, SO_TIMESTAMP, &value, sizeof(value));
+#endif
+		if (result == SOCKET_ERROR_CODE)
+		{
+			Core::Logging::Error("Failed to set receive timestamping on socket ({}). Error code: {}.", socket, API::GetError());
+			return ErrorUnknown{};
+		}
+
+		return Core::Success;
+	}
+
+
+	Core::Result<void, Error> Timestamping::SetTransmit(int socket, bool enabled)
+	{
+#if STRAWBERRY_TARGET_LINUX
+		// Only report software timestamps, and loop back just the timestamp rather than the whole packet.
+		SOCKET_OPTION_TYPE flags = enabled
+			? SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY
+			: 0;
+		auto result = setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+		if (result == SOCKET_ERROR_CODE)
+		{
+			Core::Logging::Error("Failed to set transmit timestamping on socket ({}). Error code: {}.", socket, API::GetError());
+			return ErrorUnknown{};
+		}
+
+		return Core::Success;
+#else
+		if (!enabled) return Core::Success;
+		Core::Logging::Error("Transmit timestamps are not supported on this platform!");
+		return ErrorNotSupported{};
+#endif
+	}
+
+
+	Core::Optional<Timestamp> Timestamping::FromControlMessages(msghdr& message)
+	{
+		for (cmsghdr* control = CMSG_FIRSTHDR(&message); control != nullptr; control = CMSG_NXTHDR(&message, control))
+		{
+			if (control->cmsg_level != SOL_SOCKET) continue;
+
+#if STRAWBERRY_TARGET_LINUX
+			if (control->cmsg_type == SCM_TIMESTAMPNS)
+			{
+				timespec time;
+				memcpy(&time, CMSG_DATA(control), sizeof(time));
+				return ToTimestamp(time);
+			}
+			else if (control->cmsg_type == SCM_TIMESTAMPING)
+			{
+				// The first entry holds the software timestamp.
+				scm_timestamping timestamps;
+				memcpy(&timestamps, CMSG_DATA(control), sizeof(timestamps));
+				if (timestamps.ts[0].tv_sec != 0 || timestamps.ts[0].tv_nsec != 0)
+				{
+					return ToTimestamp(timestamps.ts[0]);
+				}
+			}
+#else
+			if (control->cmsg_type == SCM_TIMESTAMP)
+			{
+				timeval time;
+				memcpy(&time, CMSG_DATA(control), sizeof(time));
+				return ToTimestamp(time);
+			}
+#endif
+		}
+
+		return {};
+	}
+
+
+	Core::Optional<TransmitTimestamp> Timestamping::ReadTransmitTimestamp(int socket)
+	{
+#if STRAWBERRY_TARGET_LINUX
+		alignas(cmsghdr) char control[CONTROL_BUFFER_SIZE];
+		msghdr message{};
+		message.msg_control    = control;
+		message.msg_controllen = sizeof(control);
+
+		if (recvmsg(socket, &message, MSG_ERRQUEUE | MSG_DONTWAIT) == SOCKET_ERROR_CODE)
+		{
+			return {};
+		}
+
+		Core::Optional<Timestamp> timestamp;
+		Core::Optional<uint32_t>  id;
+		for (cmsghdr* cursor = CMSG_FIRSTHDR(&message); cursor != nullptr; cursor = CMSG_NXTHDR(&message, cursor))
+		{
+			if (cursor->cmsg_level == SOL_SOCKET && cursor->cmsg_type == SCM_TIMESTAMPING)
+			{
+				scm_timestamping timestamps;
+				memcpy(&timestamps, CMSG_DATA(cursor), sizeof(timestamps));
+				timestamp = ToTimestamp(timestamps.ts[0]);
+			}
+			else if ((cursor->cmsg_level == IPPROTO_IP && cursor->cmsg_type == IP_RECVERR)
+				|| (cursor->cmsg_level == IPPROTO_IPV6 && cursor->cmsg_type == IPV6_RECVERR))
+			{
+				sock_extended_err error;
+				memcpy(&error, CMSG_DATA(cursor), sizeof(error));
+				if (error.ee_errno == ENOMSG && error.ee_origin == SO_EE_ORIGIN_TIMESTAMPING)
+				{
+					id = error.ee_data;
+				}
+			}
+		}
+
+		if (timestamp && id)
+		{
+			return TransmitTimestamp{.id = *id, .timestamp = *timestamp};
+		}
+#endif
+
+		return {};
+	}
+#endif
+} // namespace Strawberry::Net::Socket
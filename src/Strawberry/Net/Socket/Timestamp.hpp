@@ -0,0 +1,65 @@
+#pragma once
+
+
+//======================================================================================================================
+//	Includes
+//----------------------------------------------------------------------------------------------------------------------
+// Strawberry Net
+#include "Strawberry/Net/Error.hpp"
+// Strawberry Core
+#include "Strawberry/Core/Types/Optional.hpp"
+#include "Strawberry/Core/Types/Result.hpp"
+// Standard Library
+#include <chrono>
+#include <cstdint>
+// Platform specific networking headers
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+#include <sys/socket.h>
+#endif
+
+
+namespace Strawberry::Net::Socket
+{
+	/// Time at which the kernel received or transmitted a packet.
+	/// Kernel timestamps are taken from the realtime clock.
+	using Timestamp = std::chrono::system_clock::time_point;
+
+
+	/// A software transmit timestamp read back from the kernel.
+	struct TransmitTimestamp
+	{
+		/// For UDP sockets, the index of the sent packet counting from when transmit timestamping was enabled.
+		/// For TCP sockets, the offset of the last byte of the timestamped write in the stream.
+		uint32_t  id;
+		/// Time at which the packet was handed to the network device.
+		Timestamp timestamp;
+	};
+
+
+	/// Returns the time data spent queued between the kernel receiving it and the application dispatching it.
+	inline std::chrono::nanoseconds GetQueueingDelay(Timestamp arrival, Timestamp dispatch = Timestamp::clock::now())
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(dispatch - arrival);
+	}
+
+
+	/// Platform glue shared by the sockets which support kernel timestamps.
+	class Timestamping
+	{
+	public:
+		/// Size of the ancillary data buffer to pass to recvmsg when timestamps are enabled.
+		static constexpr size_t CONTROL_BUFFER_SIZE = 256;
+
+
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		/// Enables or disables kernel receive timestamps on the given socket.
+		static Core::Result<void, Error> SetReceive(int socket, bool enabled);
+		/// Enables or disables software transmit timestamps on the given socket.
+		static Core::Result<void, Error> SetTransmit(int socket, bool enabled);
+		/// Extracts the receive timestamp from the ancillary data of a message read with recvmsg.
+		static Core::Optional<Timestamp> FromControlMessages(msghdr& message);
+		/// Reads a single transmit timestamp from the error queue of the given socket without blocking.
+		static Core::Optional<TransmitTimestamp> ReadTransmitTimestamp(int socket);
+#endif
+	};
+} // namespace Strawberry::Net::Socket
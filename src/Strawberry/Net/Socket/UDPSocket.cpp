@@ -14,8 +14,10 @@
 #if STRAWBERRY_TARGET_WINDOWS
 #include <winsock2.h>
 #include <ws2tcpip.h>
+#include <netioapi.h>
 #elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
 #include <fcntl.h>
+#include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <poll.h>
@@ -98,6 +100,7 @@ namespace Strawberry::Net::Socket
 		: mSocket(std::exchange(other.mSocket, -1))
 		, mEndpoint(std::move(other.mEndpoint))
 		, mIPv6(other.mIPv6)
+		, mTimestamping(other.mTimestamping)
 		, mBuffer(std::move(other.mBuffer)) {}
 
 
@@ -106,7 +109,7 @@ namespace Strawberry::Net::Socket
 		if (this != &other)
 		{
 			std::destroy_at(this);
-			mSocket = std::exchange(other.mSocket, -1);
+			std::construct_at(this, std::move(other));
 		}
 
 		return *this;
@@ -142,6 +145,25 @@ namespace Strawberry::Net::Socket
 		return static_cast<bool>(fds[0].revents & POLLIN);
 	}
 
+
+	Core::Result<void, Error> UDPSocket::SetBlocking(bool blocking)
+	{
+#if STRAWBERRY_TARGET_WINDOWS
+		u_long nonBlocking = blocking ? 0 : 1;
+		if (ioctlsocket(mSocket, FIONBIO, &nonBlocking) == SOCKET_ERROR_CODE)
+#elif STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		int flags = fcntl(mSocket, F_GETFL, 0);
+		if (flags == -1 || fcntl(mSocket, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK) == -1)
+#endif
+		{
+			Core::Logging::Error("Failed to set blocking mode of UDP socket ({}). Error code: {}.", mSocket, API::GetError());
+			return ErrorUnknown{};
+		}
+
+		return Core::Success;
+	}
+
+
 	Core::Result<void, Error> UDPSocket::Bind(const Endpoint& endpoint) noexcept
 	{
 		Core::Logging::Info("Binding UDP Socket ({}) to {}", mSocket, endpoint.ToString());
@@ -173,6 +195,20 @@ namespace Strawberry::Net::Socket
 
 		// Storage space for the peer's address.
 		sockaddr_storage peer{};
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		// Read with recvmsg so that ancillary data such as timestamps is available.
+		iovec vector{.iov_base = mBuffer.Data(), .iov_len = mBuffer.Size()};
+		alignas(cmsghdr) char control[Timestamping::CONTROL_BUFFER_SIZE];
+		msghdr message{};
+		message.msg_name       = &peer;
+		message.msg_namelen    = sizeof(peer);
+		message.msg_iov        = &vector;
+		message.msg_iovlen     = 1;
+		message.msg_control    = control;
+		message.msg_controllen = sizeof(control);
+		// Attempt to read the message
+		auto bytesRead = recvmsg(mSocket, &message, 0);
+#elif STRAWBERRY_TARGET_WINDOWS
 		// Must be set to the size of the available storage space,
 		// or nothing will be stored.
 		socklen_t		 peerLen   = sizeof(sockaddr_storage);
@@ -183,6 +219,7 @@ namespace Strawberry::Net::Socket
 			mBuffer.Size(), 0,
 			reinterpret_cast<sockaddr*>(&peer),
 			&peerLen);
+#endif
 
 		/// If we returned a positive integer, we succeeded in reading a message.
 		if (bytesRead > 0)
@@ -207,14 +244,23 @@ namespace Strawberry::Net::Socket
 				return ErrorUnknown{};
 			}
 
+			// Kernel receive time, if requested.
+			Core::Optional<Timestamp> timestamp;
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+			if (mTimestamping) timestamp = Timestamping::FromControlMessages(message);
+#endif
+
 			Core::Assert(endpoint.HasValue());
 			return UDPPacket{
-				.endpoint = std::move(endpoint),
-				.contents = Core::IO::DynamicByteBuffer(mBuffer.Data(), bytesRead)
+				.endpoint  = std::move(endpoint),
+				.contents  = Core::IO::DynamicByteBuffer(mBuffer.Data(), bytesRead),
+				.timestamp = timestamp
 			};
 		}
 		else switch (auto error = API::GetError())
 		{
+		case SOCKET_ERROR_TYPE_CODE(EWOULDBLOCK):
+			return ErrorNoData{};
 		default:
 			Core::Logging::Error("Unhandled error code when calling recvfrom in UDPSocket::Receive. recvfrom return = {}, Error code: {}.", bytesRead, error);
 			return ErrorUnknown{};
@@ -258,4 +304,231 @@ namespace Strawberry::Net::Socket
 		Core::AssertEQ(sendResult, bytes.Size());
 		return Core::Success;
 	}
+
+
+	Core::Result<void, Error> UDPSocket::SetReuseAddress(bool enabled)
+	{
+		SOCKET_OPTION_TYPE value = enabled ? 1 : 0;
+		if (auto result = SetSocketOption(SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value)); !result)
+		{
+			return result;
+		}
+
+#if STRAWBERRY_TARGET_MAC
+		// BSD derived systems only share multicast ports between sockets with SO_REUSEPORT.
+		return SetSocketOption(SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value));
+#else
+		return Core::Success;
+#endif
+	}
+
+
+	Core::Result<void, Error> UDPSocket::SetTimestamping(bool enabled)
+	{
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		if (auto result = Timestamping::SetReceive(mSocket, enabled); !result)
+		{
+			return result;
+		}
+
+		mTimestamping = enabled;
+		return Core::Success;
+#else
+		if (!enabled) return Core::Success;
+		Core::Logging::Error("Kernel receive timestamps are not supported on this platform!");
+		return ErrorNotSupported{};
+#endif
+	}
+
+
+	Core::Result<void, Error> UDPSocket::SetTransmitTimestamping(bool enabled)
+	{
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		return Timestamping::SetTransmit(mSocket, enabled);
+#else
+		if (!enabled) return Core::Success;
+		Core::Logging::Error("Transmit timestamps are not supported on this platform!");
+		return ErrorNotSupported{};
+#endif
+	}
+
+
+	Core::Optional<TransmitTimestamp> UDPSocket::ReadTransmitTimestamp() const
+	{
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+		return Timestamping::ReadTransmitTimestamp(mSocket);
+#else
+		return {};
+#endif
+	}
+
+
+	Core::Result<void, Error> UDPSocket::JoinGroup(const IPAddress& group, unsigned int interfaceIndex)
+	{
+		Core::Logging::Info("Joining multicast group {} on UDP Socket ({})", group.AsString(), mSocket);
+		return SetGroupMembership(MCAST_JOIN_GROUP, group, nullptr, interfaceIndex);
+	}
+
+
+	Core::Result<void, Error> UDPSocket::JoinGroup(const IPAddress& group, const IPAddress& source, unsigned int interfaceIndex)
+	{
+		Core::Logging::Info("Joining multicast group {} from source {} on UDP Socket ({})", group.AsString(), source.AsString(), mSocket);
+		return SetGroupMembership(MCAST_JOIN_SOURCE_GROUP, group, &source, interfaceIndex);
+	}
+
+
+	Core::Result<void, Error> UDPSocket::LeaveGroup(const IPAddress& group, unsigned int interfaceIndex)
+	{
+		Core::Logging::Info("Leaving multicast group {} on UDP Socket ({})", group.AsString(), mSocket);
+		return SetGroupMembership(MCAST_LEAVE_GROUP, group, nullptr, interfaceIndex);
+	}
+
+
+	Core::Result<void, Error> UDPSocket::LeaveGroup(const IPAddress& group, const IPAddress& source, unsigned int interfaceIndex)
+	{
+		Core::Logging::Info("Leaving multicast group {} from source {} on UDP Socket ({})", group.AsString(), source.AsString(), mSocket);
+		return SetGroupMembership(MCAST_LEAVE_SOURCE_GROUP, group, &source, interfaceIndex);
+	}
+
+
+	Core::Result<void, Error> UDPSocket::SetMulticastInterface(unsigned int interfaceIndex)
+	{
+		// IPv4 identifies interfaces by address unless given an ip_mreqn.
+		// Windows instead accepts an index in the form 0.0.0.x.
+#if STRAWBERRY_TARGET_WINDOWS
+		in_addr ipv4Interface{};
+		ipv4Interface.s_addr = htonl(interfaceIndex);
+#else
+		ip_mreqn ipv4Interface{};
+		ipv4Interface.imr_ifindex = static_cast<int>(interfaceIndex);
+#endif
+
+		if (!mIPv6)
+		{
+			return SetSocketOption(IPPROTO_IP, IP_MULTICAST_IF, &ipv4Interface, sizeof(ipv4Interface));
+		}
+
+#if STRAWBERRY_TARGET_LINUX
+		// Linux routes IPv4 traffic of dual-band sockets through the IPv4 options.
+		if (auto result = SetSocketOption(IPPROTO_IP, IP_MULTICAST_IF, &ipv4Interface, sizeof(ipv4Interface)); !result)
+		{
+			return result;
+		}
+#endif
+		SOCKET_OPTION_TYPE ipv6Interface = interfaceIndex;
+		return SetSocketOption(IPPROTO_IPV6, IPV6_MULTICAST_IF, &ipv6Interface, sizeof(ipv6Interface));
+	}
+
+
+	Core::Result<void, Error> UDPSocket::SetMulticastTTL(uint8_t hops)
+	{
+		SOCKET_OPTION_TYPE value = hops;
+		if (!mIPv6)
+		{
+			return SetSocketOption(IPPROTO_IP, IP_MULTICAST_TTL, &value, sizeof(value));
+		}
+
+#if STRAWBERRY_TARGET_LINUX
+		if (auto result = SetSocketOption(IPPROTO_IP, IP_MULTICAST_TTL, &value, sizeof(value)); !result)
+		{
+			return result;
+		}
+#endif
+		return SetSocketOption(IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &value, sizeof(value));
+	}
+
+
+	Core::Result<void, Error> UDPSocket::SetMulticastLoopback(bool enabled)
+	{
+		SOCKET_OPTION_TYPE value = enabled ? 1 : 0;
+		if (!mIPv6)
+		{
+			return SetSocketOption(IPPROTO_IP, IP_MULTICAST_LOOP, &value, sizeof(value));
+		}
+
+#if STRAWBERRY_TARGET_LINUX
+		if (auto result = SetSocketOption(IPPROTO_IP, IP_MULTICAST_LOOP, &value, sizeof(value)); !result)
+		{
+			return result;
+		}
+#endif
+		return SetSocketOption(IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &value, sizeof(value));
+	}
+
+
+	Core::Optional<unsigned int> UDPSocket::GetInterfaceIndex(const std::string& interfaceName)
+	{
+		unsigned int index = if_nametoindex(interfaceName.c_str());
+		if (index == 0)
+		{
+			Core::Logging::Error("No network interface named {}!", interfaceName);
+			return {};
+		}
+
+		return index;
+	}
+
+
+	Core::Result<void, Error> UDPSocket::SetGroupMembership(int option, const IPAddress& group, const IPAddress* source, unsigned int interfaceIndex)
+	{
+		if (group.IsIPv6() && !mIPv6)
+		{
+			Core::Logging::Error("Cannot use IPv6 multicast group {} on an IPv4 UDP socket!", group.AsString());
+			return ErrorIPAddressFamily{};
+		}
+
+		if (source && source->IsIPv6() != group.IsIPv6())
+		{
+			Core::Logging::Error("Multicast source {} does not match the address family of group {}!", source->AsString(), group.AsString());
+			return ErrorIPAddressFamily{};
+		}
+
+		// IPv4 groups are managed at the IP level, including on dual-band sockets.
+		const int level = group.IsIPv4() ? IPPROTO_IP : IPPROTO_IPV6;
+
+		if (source)
+		{
+			group_source_req request{};
+			request.gsr_interface = interfaceIndex;
+			request.gsr_group     = Endpoint(group, 0).GetPlatformRepresentation();
+			request.gsr_source    = Endpoint(*source, 0).GetPlatformRepresentation();
+			return SetSocketOption(level, option, &request, sizeof(request));
+		}
+		else
+		{
+			group_req request{};
+			request.gr_interface = interfaceIndex;
+			request.gr_group     = Endpoint(group, 0).GetPlatformRepresentation();
+			return SetSocketOption(level, option, &request, sizeof(request));
+		}
+	}
+
+
+	Core::Result<void, Error> UDPSocket::SetSocketOption(int level, int option, const void* value, size_t length)
+	{
+		auto result = setsockopt(mSocket, level, option, reinterpret_cast<const char*>(value), static_cast<socklen_t>(length));
+		if (result == SOCKET_ERROR_CODE)
+		{
+			switch (auto error = API::GetError())
+			{
+			case SOCKET_ERROR_TYPE_CODE(EADDRNOTAVAIL):
+#if STRAWBERRY_TARGET_MAC || STRAWBERRY_TARGET_LINUX
+			case ENODEV:
+#endif
+				Core::Logging::Error("Failed to set option {} on UDP socket ({}) because the address or interface was not available!", option, mSocket);
+				return ErrorAddressNotAvailable{};
+			case SOCKET_ERROR_TYPE_CODE(EADDRINUSE):
+				Core::Logging::Error("Failed to set option {} on UDP socket ({}) because the group was already joined!", option, mSocket);
+				return ErrorAddressInUse{};
+			case SOCKET_ERROR_TYPE_CODE(EAFNOSUPPORT):
+				Core::Logging::Error("Failed to set option {} on UDP socket ({}) because of a mismatched address family!", option, mSocket);
+				return ErrorIPAddressFamily{};
+			default:
+				Core::Logging::Error("Unhandled error code when setting option {} on UDP socket ({}). Code: {}.", option, mSocket, error);
+				return ErrorUnknown{};
+			}
+		}
+
+		return Core::Success;
+	}
 } // namespace Strawberry::Net::Socket
@@ -6,9 +6,12 @@
 //----------------------------------------------------------------------------------------------------------------------
 // Strawberry Net
 #include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/Socket/Timestamp.hpp"
 // Core
 #include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
 #include "Strawberry/Core/Types/Result.hpp"
+// Standard Library
+#include <string>
 #if STRAWBERRY_TARGET_WINDOWS
 #include <winsock2.h>
 #endif
@@ -20,6 +23,8 @@ namespace Strawberry::Net::Socket
 	{
 		Core::Optional<Endpoint>	endpoint;
 		Core::IO::DynamicByteBuffer contents;
+		/// Time at which the kernel received this packet, if timestamping is enabled.
+		Core::Optional<Timestamp>   timestamp;
 	};
 
 
@@ -57,19 +62,82 @@ namespace Strawberry::Net::Socket
 		Core::Result<void, Error> Bind(const Endpoint& endpoint) noexcept;
 
 
+		/// Sets whether Receive() should block until a packet arrives.
+		///
+		/// Sockets are blocking by default. When non-blocking, Receive() returns
+		/// ErrorNoData immediately if no packets are queued, so a socket can be
+		/// drained without calling Poll() before each packet.
+		Core::Result<void, Error> SetBlocking(bool blocking);
+
+
 		/// Returns whether there is data waiting to be received on this socket.
 		[[nodiscard]] bool                           Poll() const;
 		/// Reads a packet of data from this socket.
+		/// Returns ErrorNoData if the socket is non-blocking and no packet is queued.
 		[[nodiscard]] Core::Result<UDPPacket, Error> Receive();
 		/// Sends a message over this socket to the given endpoint.
 		[[nodiscard]] Core::Result<void, Error>      Send(const Endpoint& endpoint, const Core::IO::DynamicByteBuffer& bytes) const;
 
 
+		/// Allows several sockets on this host to bind to the same port.
+		///
+		/// Must be called before Bind(). Required for more than one local
+		/// consumer to receive the same multicast group.
+		Core::Result<void, Error> SetReuseAddress(bool enabled);
+
+
+		//======================================================================================================================
+		//	Multicast
+		//----------------------------------------------------------------------------------------------------------------------
+		/// Joins the given multicast group on the given interface.
+		///
+		/// An interface index of 0 lets the system choose the interface.
+		/// IPv4 groups may be joined from dual-band sockets.
+		Core::Result<void, Error> JoinGroup(const IPAddress& group, unsigned int interfaceIndex = 0);
+		/// Joins the given multicast group, only accepting packets sent by the given source.
+		Core::Result<void, Error> JoinGroup(const IPAddress& group, const IPAddress& source, unsigned int interfaceIndex = 0);
+		/// Leaves a group previously joined with JoinGroup(group, interfaceIndex).
+		Core::Result<void, Error> LeaveGroup(const IPAddress& group, unsigned int interfaceIndex = 0);
+		/// Leaves a source-specific group previously joined with JoinGroup(group, source, interfaceIndex).
+		Core::Result<void, Error> LeaveGroup(const IPAddress& group, const IPAddress& source, unsigned int interfaceIndex = 0);
+
+
+		/// Sets the interface which outgoing multicast packets are sent from.
+		/// An interface index of 0 restores the system default.
+		Core::Result<void, Error> SetMulticastInterface(unsigned int interfaceIndex);
+		/// Sets the TTL (IPv4) or hop limit (IPv6) of outgoing multicast packets.
+		Core::Result<void, Error> SetMulticastTTL(uint8_t hops);
+		/// Sets whether outgoing multicast packets are looped back to sockets on this host.
+		Core::Result<void, Error> SetMulticastLoopback(bool enabled);
+
+
+		//======================================================================================================================
+		//	Timestamping
+		//----------------------------------------------------------------------------------------------------------------------
+		/// Enables attaching kernel receive timestamps to received packets.
+		Core::Result<void, Error> SetTimestamping(bool enabled);
+		/// Enables software transmit timestamps for sent packets. Only supported on Linux.
+		Core::Result<void, Error> SetTransmitTimestamping(bool enabled);
+		/// Returns the next available transmit timestamp, without blocking.
+		[[nodiscard]] Core::Optional<TransmitTimestamp> ReadTransmitTimestamp() const;
+
+
+		/// Returns the index of the network interface with the given name, e.g. "eth0".
+		static Core::Optional<unsigned int> GetInterfaceIndex(const std::string& interfaceName);
+
+
 private:
 		/// Private default constructor for use in static methods of this class.
 		UDPSocket();
 
 
+		/// Issues a group membership request. Option is one of the protocol independent
+		/// MCAST_JOIN_GROUP family of socket options.
+		Core::Result<void, Error> SetGroupMembership(int option, const IPAddress& group, const IPAddress* source, unsigned int interfaceIndex);
+		/// Sets a socket option, translating failures into errors.
+		Core::Result<void, Error> SetSocketOption(int level, int option, const void* value, size_t length);
+
+
 		/// The handle to this socket.
 		SocketHandle             mSocket;
 		/// The endoint to which this socket is bound.
@@ -78,6 +146,8 @@ private:
 		/// Boolean of whether this socket was created with IPv6 capacilities.
 		/// True for both pure V6 and Dualband sockets.
 		bool                     mIPv6;
+		/// Whether kernel receive timestamps have been requested.
+		bool                     mTimestamping = false;
 
 
 		/// Size of the buffer in which to read packets to.
@@ -51,7 +51,7 @@ namespace Strawberry::Net::Websocket
         {
             if (auto msg = ReadMessage(); msg.IsErr() && msg.Err().template IsType<ErrorNoData>())
             {
-                std::this_thread::yield();
+                (void) mSocket->Poll(Socket::BufferedSocket<S>::WAIT_INTERVAL);
             }
             else
             {
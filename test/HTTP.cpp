@@ -1,13 +1,428 @@
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
+#include "Strawberry/Net/Address.hpp"
 #include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/HTTP/BodySource.hpp"
 #include "Strawberry/Net/HTTP/Constants.hpp"
 #include "Strawberry/Net/HTTP/HTTPClient.hpp"
+#include "Strawberry/Net/HTTP/HTTPConnectionPool.hpp"
 #include "Strawberry/Net/HTTP/Request.hpp"
+#include "Strawberry/Net/HTTP/RequestParser.hpp"
 #include "Strawberry/Net/HTTP/Response.hpp"
+#include "Strawberry/Net/Socket/TCPListener.hpp"
+#include "Strawberry/Net/Socket/TCPSocket.hpp"
 #include "Strawberry/Core/IO/Logging.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace Strawberry;
+using namespace Net;
+using namespace Net::HTTP;
+
+
+/// A plain TCP server, for seeing exactly what clients send and controlling how responses arrive.
+/// Each connection is served on its own thread, until the client closes it or the responder returns false.
+class TestServer
+{
+public:
+	/// Answers a request, given exactly as it was received. Returns whether to keep the connection open.
+	using Responder = std::function<bool(Socket::TCPSocket& socket, const std::string& request)>;
+
+
+	TestServer(const Endpoint& endpoint, Responder responder)
+		: mEndpoint(endpoint)
+		, mListener(Socket::TCPListener::Bind(endpoint).Unwrap())
+		, mResponder(std::move(responder))
+		, mAcceptor([this] { Accept(); })
+	{}
+
+
+	/// Clients must have closed their connections first.
+	~TestServer()
+	{
+		mStopping = true;
+		// Wake the acceptor up.
+		(void) Socket::TCPSocket::Connect(mEndpoint);
+		mAcceptor.join();
+		for (auto& connection : mConnections) connection.join();
+	}
+
+
+	[[nodiscard]] int GetConnectionCount() const
+	{
+		return mConnectionCount;
+	}
+
+
+	[[nodiscard]] std::vector<std::string> GetRequests() const
+	{
+		std::lock_guard lock(mMutex);
+		return mRequests;
+	}
+
+private:
+	void Accept()
+	{
+		while (true)
+		{
+			auto socket = mListener.Accept();
+			if (mStopping) return;
+			if (!socket) continue;
+
+			mConnectionCount++;
+			mConnections.emplace_back([this, socket = socket.Unwrap()]() mutable { Serve(socket); });
+		}
+	}
+
+
+	void Serve(Socket::TCPSocket& socket)
+	{
+		std::string received;
+		while (true)
+		{
+			// Chunked bodies are decoded in place, so the request is parsed from a copy.
+			std::vector<uint8_t> copy(received.begin(), received.end());
+			RequestParser        parser;
+			size_t               consumed = 0;
+			auto                 request  = parser.Parse(copy, consumed);
+			if (!request)
+			{
+				// Pipelined requests are answered before waiting for more.
+				Core::Assert(request.Err().IsType<ErrorNoData>());
+				auto bytes = socket.Read(64 * 1024);
+				if (!bytes || bytes->Size() == 0) return;
+				received += bytes->AsString();
+				continue;
+			}
+
+			std::string raw = received.substr(0, consumed);
+			received.erase(0, consumed);
+			{
+				std::lock_guard lock(mMutex);
+				mRequests.push_back(raw);
+			}
+			if (!mResponder(socket, raw)) return;
+		}
+	}
+
+
+	Endpoint                 mEndpoint;
+	Socket::TCPListener      mListener;
+	Responder                mResponder;
+	std::atomic<bool>        mStopping        = false;
+	std::atomic<int>         mConnectionCount = 0;
+	mutable std::mutex       mMutex;
+	std::vector<std::string> mRequests;
+	std::vector<std::thread> mConnections;
+	std::thread              mAcceptor;
+};
+
+
+void Write(Socket::TCPSocket& socket, std::string_view data)
+{
+	socket.Write(Core::IO::DynamicByteBuffer(data.data(), data.size())).Unwrap();
+}
+
+
+std::string Body(Response& response)
+{
+	return response.GetPayload().AsString();
+}
+
+
+/// Sends a GET request on a pooled connection and returns the body of the response.
+std::string Get(PooledConnection<Socket::TCPSocket>& connection, const std::string& target)
+{
+	Request request(Verb::GET, target);
+	request.GetHeader().Set("Host", "localhost");
+	connection->SendRequest(request);
+	auto response = connection->Receive();
+	return Body(response);
+}
+
+
+void TestConnectionPool()
+{
+	// Keep-Alive timeouts come from the target, and /close closes the connection after answering.
+	Endpoint   endpoint(IPv4Address::LocalHost(), 65535 - 1008);
+	TestServer server(endpoint, [](Socket::TCPSocket& socket, const std::string& request)
+	{
+		if (request.starts_with("GET /keep-alive"))
+		{
+			Write(socket, "HTTP/1.1 200 OK\r\nKeep-Alive: timeout=2\r\nContent-Length: 2\r\n\r\nok");
+			return true;
+		}
+
+		Write(socket, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+		return !request.starts_with("GET /close");
+	});
+
+
+	{
+		HTTPConnectionPool pool(HTTPConnectionPoolOptions {
+			.maxConnectionsPerHost = 2,
+			.idleTimeout           = std::chrono::seconds(60),
+			.evictionInterval      = std::chrono::milliseconds(100),
+			.tlsContext            = {},
+		});
+
+		// Connections go back to the pool once a response has been read, and are reused.
+		{
+			auto connection = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+			Core::AssertEQ(Get(connection, "/"), std::string("ok"));
+		}
+		Core::AssertEQ(pool.GetIdleCount(), size_t(1));
+		{
+			auto connection = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+			Core::AssertEQ(pool.GetIdleCount(), size_t(0));
+			Core::AssertEQ(Get(connection, "/"), std::string("ok"));
+		}
+		Core::AssertEQ(server.GetConnectionCount(), 1);
+
+
+		// Connections which the server has closed are left behind at checkout.
+		{
+			auto connection = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+			Core::AssertEQ(Get(connection, "/close"), std::string("ok"));
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		{
+			auto connection = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+			Core::AssertEQ(Get(connection, "/"), std::string("ok"));
+		}
+		Core::AssertEQ(server.GetConnectionCount(), 2);
+
+
+		// No more than maxConnectionsPerHost are open at once, and others wait for one to be given back.
+		{
+			auto              second   = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+			std::atomic<bool> acquired = false;
+			std::thread       waiter;
+			{
+				auto first = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+				waiter     = std::thread([&]
+				{
+					auto third = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+					acquired   = true;
+					Core::AssertEQ(Get(third, "/"), std::string("ok"));
+				});
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(200));
+				Core::Assert(!acquired);
+				Core::AssertEQ(Get(first, "/"), std::string("ok"));
+			}
+			waiter.join();
+			Core::AssertEQ(Get(second, "/"), std::string("ok"));
+		}
+		Core::AssertEQ(pool.GetIdleCount(), size_t(2));
+
+
+		// Discarded connections are closed, rather than kept.
+		{
+			auto connection = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+			Core::AssertEQ(Get(connection, "/"), std::string("ok"));
+			connection.Discard();
+		}
+		Core::AssertEQ(pool.GetIdleCount(), size_t(1));
+
+
+		// Idle connections are dropped a second before the server's Keep-Alive timeout, by the evictor.
+		pool.Clear();
+		{
+			auto connection = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+			Core::AssertEQ(Get(connection, "/keep-alive"), std::string("ok"));
+		}
+		Core::AssertEQ(pool.GetIdleCount(), size_t(1));
+		std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+		Core::AssertEQ(pool.GetIdleCount(), size_t(0));
+	}
+
+
+	// The pool's own idle timeout applies when the server doesn't give one.
+	{
+		HTTPConnectionPool pool(HTTPConnectionPoolOptions {
+			.maxConnectionsPerHost = 2,
+			.idleTimeout           = std::chrono::milliseconds(200),
+			.evictionInterval      = std::chrono::milliseconds(50),
+			.tlsContext            = {},
+		});
+
+		{
+			auto connection = pool.Acquire<Socket::TCPSocket>(endpoint).Unwrap();
+			Core::AssertEQ(Get(connection, "/"), std::string("ok"));
+		}
+		Core::AssertEQ(pool.GetIdleCount(), size_t(1));
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		Core::AssertEQ(pool.GetIdleCount(), size_t(0));
+	}
+}
+
+
+void TestStreamedBodies()
+{
+	// Bodies are sent in two parts, a little apart, so that they arrive separately.
+	Endpoint   endpoint(IPv4Address::LocalHost(), 65535 - 1009);
+	TestServer server(endpoint, [](Socket::TCPSocket& socket, const std::string& request)
+	{
+		if (request.starts_with("GET /chunked"))
+		{
+			Write(socket, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n");
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			Write(socket, "6\r\n world\r\n0\r\n\r\n");
+		}
+		else
+		{
+			Write(socket, "HTTP/1.1 200 OK\r\nContent-Length: 11\r\n\r\nhello");
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			Write(socket, " world");
+		}
+		return true;
+	});
+
+
+	{
+		HTTPClient client(endpoint);
+		for (auto target : {"/length", "/chunked", "/length"})
+		{
+			Request request(Verb::GET, target);
+			request.GetHeader().Set("Host", "localhost");
+			client.SendRequest(request);
+		}
+
+		// Each part is handed out as it arrives.
+		auto response = client.ReceiveHeaders().Unwrap();
+		Core::AssertEQ(response.GetHeader().Get(HeaderName::CONTENT_LENGTH), std::string_view("11"));
+		std::vector<std::string> parts;
+		while (true)
+		{
+			auto data = client.ReadBody().Unwrap();
+			if (data.empty()) break;
+			parts.emplace_back(reinterpret_cast<const char*>(data.data()), data.size());
+		}
+		Core::AssertEQ(parts.size(), size_t(2));
+		Core::AssertEQ(parts[0] + parts[1], std::string("hello world"));
+		// The end of the body is reported again, rather than running into the next response.
+		Core::Assert(client.ReadBody().Unwrap().empty());
+
+		// Chunk framing is removed.
+		response = client.ReceiveHeaders().Unwrap();
+		parts.clear();
+		client.ReceiveBody([&](std::span<const uint8_t> data)
+		{
+			parts.emplace_back(reinterpret_cast<const char*>(data.data()), data.size());
+		}).Unwrap();
+		Core::AssertEQ(parts.size(), size_t(2));
+		Core::AssertEQ(parts[0] + parts[1], std::string("hello world"));
+
+		// Once a body has been read to the end, the next response follows on the same connection,
+		// and the connection is only reusable once the last body has been read.
+		response = client.ReceiveHeaders().Unwrap();
+		Core::Assert(!client.IsReusable());
+		std::string body;
+		client.ReceiveBody([&](std::span<const uint8_t> data)
+		{
+			body.append(reinterpret_cast<const char*>(data.data()), data.size());
+		}).Unwrap();
+		Core::AssertEQ(body, std::string("hello world"));
+		Core::Assert(client.IsReusable());
+	}
+	Core::AssertEQ(server.GetConnectionCount(), 1);
+}
+
+
+void TestStreamedUploads()
+{
+	using Client = HTTPClientBase<Socket::TCPSocket>;
+
+	Endpoint   endpoint(IPv4Address::LocalHost(), 65535 - 1010);
+	TestServer server(endpoint, [](Socket::TCPSocket& socket, const std::string&)
+	{
+		Write(socket, "HTTP/1.1 204 No Content\r\n\r\n");
+		return true;
+	});
+
+
+	std::vector<uint8_t>                  first(100000, 'a');
+	std::vector<uint8_t>                  second(50000, 'b');
+	std::vector<std::span<const uint8_t>> buffers {first, second};
+
+	const size_t unknownLength = 2 * Client::UPLOAD_CHUNK_SIZE + Client::UPLOAD_CHUNK_SIZE / 2;
+	std::string  unknownBody;
+	for (size_t i = 0; i < unknownLength; i++) unknownBody.push_back(static_cast<char>('a' + i % 26));
+
+	{
+		HTTPClient client(endpoint);
+		Request    request(Verb::POST, "/upload");
+		request.GetHeader().Set("Host", "localhost");
+
+		client.SendRequest(request, BodySource::FromBuffers(buffers.begin(), buffers.end())).Unwrap();
+		Core::AssertEQ(client.Receive().GetStatus(), 204u);
+
+		size_t produced = 0;
+		client.SendRequest(request, BodySource([&](std::span<uint8_t> buffer) -> Core::Result<size_t, Error>
+		{
+			const size_t count = std::min(buffer.size(), unknownBody.size() - produced);
+			std::copy_n(unknownBody.begin() + produced, count, buffer.begin());
+			produced += count;
+			return count;
+		})).Unwrap();
+		Core::AssertEQ(client.Receive().GetStatus(), 204u);
+	}
+
+	auto requests = server.GetRequests();
+	Core::AssertEQ(requests.size(), size_t(2));
+
+
+	// Bodies of known length are sent as they are, with Content-Length.
+	const auto& known     = requests[0];
+	const auto  knownHead = known.find("\r\n\r\n") + 2;
+	Core::Assert(known.substr(0, knownHead).find("Content-Length: 150000\r\n") != std::string::npos);
+	Core::Assert(known.substr(0, knownHead).find("Transfer-Encoding") == std::string::npos);
+	Core::Assert(known.substr(knownHead + 2) == std::string(100000, 'a') + std::string(50000, 'b'));
+
+
+	// Bodies of unknown length are sent chunked, a chunk for each UPLOAD_CHUNK_SIZE read from the source.
+	const auto& unknown     = requests[1];
+	const auto  unknownHead = unknown.find("\r\n\r\n") + 2;
+	Core::Assert(unknown.substr(0, unknownHead).find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+	Core::Assert(unknown.substr(0, unknownHead).find("Content-Length") == std::string::npos);
+
+	std::vector<size_t> chunkSizes;
+	std::string         body;
+	size_t              position = unknownHead + 2;
+	while (true)
+	{
+		const auto lineEnd = unknown.find("\r\n", position);
+		const auto size    = std::stoul(unknown.substr(position, lineEnd - position), nullptr, 16);
+		chunkSizes.push_back(size);
+		position = lineEnd + 2;
+		if (size == 0) break;
+
+		body += unknown.substr(position, size);
+		Core::AssertEQ(unknown.substr(position + size, 2), std::string("\r\n"));
+		position += size + 2;
+	}
+	Core::AssertEQ(unknown.substr(position), std::string("\r\n"));
+	Core::Assert(chunkSizes == std::vector<size_t> {Client::UPLOAD_CHUNK_SIZE, Client::UPLOAD_CHUNK_SIZE, Client::UPLOAD_CHUNK_SIZE / 2, 0});
+	Core::Assert(body == unknownBody);
+}
 
 
 int main()
 {
+	TestConnectionPool();
+	TestStreamedBodies();
+	TestStreamedUploads();
+
+
 	Strawberry::Net::Endpoint endpoint = Strawberry::Net::Endpoint::Resolve("google.com", 443).Unwrap();
 	Strawberry::Net::HTTP::HTTPSClient client(endpoint);
 
@@ -18,4 +433,3 @@ int main()
 
 	return 0;
 }
-
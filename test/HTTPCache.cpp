@@ -0,0 +1,154 @@
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
+#include "Strawberry/Net/Address.hpp"
+#include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/HTTP/HTTPCache.hpp"
+#include "Strawberry/Net/HTTP/HTTPClient.hpp"
+#include "Strawberry/Net/HTTP/HTTPServer.hpp"
+#include <atomic>
+#include <filesystem>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+using namespace Strawberry;
+using namespace Net;
+using namespace Net::HTTP;
+
+
+std::string Body(const CachedResponse& response)
+{
+	auto body = response.GetBody();
+	return std::string(reinterpret_cast<const char*>(body.data()), body.size());
+}
+
+
+int main()
+{
+	Endpoint endpoint(IPv4Address::LocalHost(), 65535 - 1003);
+
+
+	// Each response says how many requests the server has handled, so hits can be told from misses.
+	std::atomic<int> handled = 0;
+	auto server = HTTPServer::Start(endpoint, [&](const RequestView& request)
+	{
+		const auto  count  = std::to_string(++handled);
+		std::string target(request.target);
+
+		Response response(Version::VERSION_1_1, 200, "OK");
+		if (target == "/fresh")
+		{
+			response.GetHeader().Set("Cache-Control", "max-age=60");
+		}
+		else if (target == "/validated")
+		{
+			response.GetHeader().Set("Cache-Control", "no-cache");
+			response.GetHeader().Set("ETag", "\"v1\"");
+			auto tag = request.Find("If-None-Match");
+			if (tag && *tag == "\"v1\"")
+			{
+				return Response(Version::VERSION_1_1, 304, "Not Modified");
+			}
+		}
+		else if (target == "/varies")
+		{
+			response.GetHeader().Set("Cache-Control", "max-age=60");
+			response.GetHeader().Set("Vary", "Accept-Language");
+		}
+		else if (target == "/large")
+		{
+			response.GetHeader().Set("Cache-Control", "max-age=60");
+		}
+		else
+		{
+			response.GetHeader().Set("Cache-Control", "no-store");
+		}
+
+		std::string body = target == "/large" ? std::string(4096, 'x') + count : count;
+		response.GetHeader().Set("Content-Length", std::to_string(body.size()));
+		response.SetPayload(Core::IO::DynamicByteBuffer(body.data(), body.size()));
+		return response;
+	}).Unwrap();
+
+
+	const auto directory = std::filesystem::temp_directory_path() / "StrawberryNetHTTPCache";
+	HTTPCache  cache(HTTPCacheOptions {.diskDirectory = directory, .diskThreshold = 1024});
+	HTTPClient client(endpoint);
+
+
+	// Fresh responses are served without asking the server.
+	auto first = cache.Send(client, Request(Verb::GET, "/fresh")).Unwrap();
+	auto again = cache.Send(client, Request(Verb::GET, "/fresh")).Unwrap();
+	Core::Assert(!first.IsFromCache());
+	Core::Assert(again.IsFromCache());
+	Core::AssertEQ(Body(again), Body(first));
+	Core::Assert(again.GetResponse().GetHeader().Contains(HeaderName::AGE));
+	Core::AssertEQ(handled.load(), 1);
+
+
+	// Responses which have to be revalidated are served again after a 304.
+	first = cache.Send(client, Request(Verb::GET, "/validated")).Unwrap();
+	again = cache.Send(client, Request(Verb::GET, "/validated")).Unwrap();
+	Core::Assert(again.IsFromCache());
+	Core::AssertEQ(again.GetResponse().GetStatus(), 200u);
+	Core::AssertEQ(Body(again), Body(first));
+	Core::AssertEQ(handled.load(), 3);
+
+
+	// Responses are stored separately for each value of the fields they vary on.
+	Request english(Verb::GET, "/varies");
+	english.GetHeader().Set("Accept-Language", "en");
+	Request french(Verb::GET, "/varies");
+	french.GetHeader().Set("Accept-Language", "fr");
+	auto englishResponse = cache.Send(client, english).Unwrap();
+	auto frenchResponse  = cache.Send(client, french).Unwrap();
+	Core::Assert(!frenchResponse.IsFromCache());
+	Core::Assert(cache.Send(client, english).Unwrap().IsFromCache());
+	Core::AssertEQ(handled.load(), 5);
+
+
+	// Responses which mustn't be stored always go to the server.
+	cache.Send(client, Request(Verb::GET, "/private")).Unwrap();
+	Core::Assert(!cache.Send(client, Request(Verb::GET, "/private")).Unwrap().IsFromCache());
+	Core::AssertEQ(handled.load(), 7);
+
+
+	// Large bodies are kept on disk, and stay readable after being evicted.
+	first = cache.Send(client, Request(Verb::GET, "/large")).Unwrap();
+	again = cache.Send(client, Request(Verb::GET, "/large")).Unwrap();
+	Core::Assert(again.IsFromCache());
+	Core::AssertEQ(Body(again), Body(first));
+	Core::AssertEQ(cache.GetEntryCount(), size_t(5));
+	cache.Clear();
+	Core::AssertEQ(Body(again).size(), size_t(4096 + 1));
+	Core::AssertEQ(cache.GetMemoryUsage(), size_t(0));
+
+
+	// Unsafe requests invalidate what is stored for their target.
+	cache.Send(client, Request(Verb::GET, "/fresh")).Unwrap();
+	Request post(Verb::POST, "/fresh");
+	post.GetHeader().Set("Content-Length", "0");
+	cache.Send(client, post).Unwrap();
+	Core::Assert(!cache.Send(client, Request(Verb::GET, "/fresh")).Unwrap().IsFromCache());
+
+
+	// Stored responses don't keep storage from the client's memory resource, which may be gone by the next hit.
+	{
+		HTTPClient arenaClient(endpoint);
+		{
+			std::pmr::monotonic_buffer_resource arena;
+			arenaClient.SetMemoryResource(&arena);
+			cache.Clear();
+			Core::Assert(!cache.Send(arenaClient, Request(Verb::GET, "/fresh")).Unwrap().IsFromCache());
+			arenaClient.SetMemoryResource(std::pmr::get_default_resource());
+		}
+		auto hit = cache.Send(arenaClient, Request(Verb::GET, "/fresh")).Unwrap();
+		Core::Assert(hit.IsFromCache());
+		Core::AssertEQ(*hit.GetResponse().GetHeader().Find("Cache-Control"), std::string_view("max-age=60"));
+	}
+
+
+	server.Stop();
+	std::filesystem::remove_all(directory);
+	return 0;
+}
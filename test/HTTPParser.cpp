@@ -0,0 +1,451 @@
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Net/HTTP/ContentDecoder.hpp"
+#include "Strawberry/Net/HTTP/HPACK.hpp"
+#include "Strawberry/Net/HTTP/Header.hpp"
+#include "Strawberry/Net/HTTP/Request.hpp"
+#include "Strawberry/Net/HTTP/RequestParser.hpp"
+#include "Strawberry/Net/HTTP/Response.hpp"
+#include "Strawberry/Net/HTTP/ResponseParser.hpp"
+#include "Strawberry/Net/HTTP/Scanner.hpp"
+#include <cctype>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <zlib.h>
+
+
+using namespace Strawberry;
+using namespace Strawberry::Net;
+using namespace Strawberry::Net::HTTP;
+
+
+struct ParsedResponse
+{
+	unsigned int                       status = 0;
+	std::string                        reason;
+	std::map<std::string, std::string> headers;
+	std::string                        body;
+	bool                               complete  = false;
+	bool                               error     = false;
+	bool                               keepAlive = false;
+};
+
+
+/// Parses a response which arrives step bytes at a time.
+ParsedResponse Parse(std::string_view response, size_t step)
+{
+	ParsedResponse result;
+	ResponseParser parser;
+	std::string    buffer;
+	size_t         offset = 0;
+
+	while (!result.complete && !result.error)
+	{
+		size_t consumed = 0;
+		auto   event    = parser.Next(buffer, consumed);
+		if (!event)
+		{
+			buffer.erase(0, consumed);
+			if (!event.Err().IsType<ErrorNoData>())
+			{
+				result.error = true;
+			}
+			else if (offset < response.size())
+			{
+				buffer.append(response.substr(offset, step));
+				offset += step;
+			}
+			else
+			{
+				result.complete = parser.Finish().IsOk();
+				result.error    = !result.complete;
+			}
+			continue;
+		}
+
+		if (event->IsType<ResponseParser::StatusLine>())
+		{
+			result.status = event->Ref<ResponseParser::StatusLine>().status;
+			result.reason = event->Ref<ResponseParser::StatusLine>().reason;
+		}
+		else if (event->IsType<ResponseParser::HeaderField>())
+		{
+			const auto& field = event->Ref<ResponseParser::HeaderField>();
+			result.headers[std::string(field.name)] = field.value;
+		}
+		else if (event->IsType<ResponseParser::BodyData>())
+		{
+			result.body += event->Ref<ResponseParser::BodyData>().data;
+		}
+		else if (event->IsType<ResponseParser::MessageComplete>())
+		{
+			result.complete = true;
+		}
+
+		buffer.erase(0, consumed);
+	}
+
+	result.keepAlive = parser.IsKeepAlive();
+	return result;
+}
+
+
+/// Checks that the vectorised scanners agree with the scalar one, at every offset of the match.
+void TestScanners()
+{
+	std::vector implementations = {ByteSet::GetBestImplementation()};
+	if (implementations[0] == ByteSet::Implementation::AVX2) implementations.push_back(ByteSet::Implementation::SSE42);
+
+	std::mt19937 rng(0);
+	std::string  printable(200, 'a');
+	std::string  binary(200, 'a');
+	for (auto& c : printable) c = static_cast<char>(0x21 + rng() % 0x5E);
+	for (auto& c : binary) c = static_cast<char>(rng());
+
+	for (const auto* set : {&Scanner::NAME_DELIMITERS, &Scanner::VALUE_DELIMITERS, &Scanner::LINE_FEED})
+	{
+		for (auto implementation : implementations)
+		{
+			for (size_t position = 0; position < 100; position++)
+			{
+				std::string sample = printable;
+				sample[position]   = '\n';
+				Core::AssertEQ(set->Find(sample.data(), sample.size(), implementation), set->Find(sample.data(), sample.size(), ByteSet::Implementation::Scalar));
+				Core::AssertEQ(set->Find(binary.data() + position, 100, implementation), set->Find(binary.data() + position, 100, ByteSet::Implementation::Scalar));
+			}
+		}
+	}
+
+	Core::AssertEQ(Scanner::NAME_DELIMITERS.Find(std::string_view("Content-Type: x")), size_t(12));
+	Core::AssertEQ(Scanner::VALUE_DELIMITERS.Find(std::string_view("text/html; charset=utf-8\r\n")), size_t(24));
+	Core::AssertEQ(Scanner::VALUE_DELIMITERS.Find(std::string_view("tab\tseparated")), size_t(13));
+}
+
+
+/// Compresses data with zlib, using windowBits to choose between the gzip, zlib and raw deflate formats.
+std::string Compress(std::string_view data, int windowBits)
+{
+	z_stream stream {};
+	Core::Assert(deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+
+	std::string compressed(deflateBound(&stream, data.size()), '\0');
+	stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	stream.avail_in  = data.size();
+	stream.next_out  = reinterpret_cast<Bytef*>(compressed.data());
+	stream.avail_out = compressed.size();
+	Core::AssertEQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+	return compressed;
+}
+
+
+/// Decodes data which arrives step bytes at a time, into an output buffer of outputSize bytes.
+std::string Decode(ContentDecoder& decoder, std::string_view data, size_t step, size_t outputSize)
+{
+	std::string          decoded;
+	std::vector<uint8_t> output(outputSize);
+
+	for (size_t offset = 0; offset < data.size(); offset += step)
+	{
+		std::span input(reinterpret_cast<const uint8_t*>(data.data()) + offset, std::min(step, data.size() - offset));
+		bool      full = false;
+		while (!input.empty() || full)
+		{
+			auto progress = decoder.Decode(input, output).Unwrap();
+			input         = input.subspan(progress.consumed);
+			full          = progress.produced == output.size();
+			decoded.append(reinterpret_cast<const char*>(output.data()), progress.produced);
+			if (progress.produced == 0 && progress.consumed == 0) break;
+		}
+	}
+
+	return decoded;
+}
+
+
+void TestContentDecoding()
+{
+	std::string original;
+	for (int i = 0; i < 2000; i++) original += "{\"id\": " + std::to_string(i) + ", \"name\": \"metadata\"},";
+
+	auto registry = ContentDecoderRegistry::Default();
+	Core::AssertEQ(registry.GetAcceptEncoding(), std::string("deflate, gzip"));
+	Core::Assert(registry.Create("identity") == nullptr);
+	Core::Assert(registry.Create("gzip, br") == nullptr);
+
+	struct Case
+	{
+		std::string_view coding;
+		int              windowBits;
+	};
+	// Deflate bodies come both with and without the zlib wrapper.
+	for (auto [coding, windowBits] : {Case {"gzip", 15 + 16}, Case {"X-GZip", 15 + 16}, Case {"deflate", 15}, Case {"deflate", -15}})
+	{
+		auto compressed = Compress(original, windowBits);
+		for (auto [step, outputSize] : {std::pair {size_t(1), size_t(7)}, std::pair {size_t(1000), size_t(64 * 1024)}})
+		{
+			auto decoder = registry.Create(coding);
+			Core::Assert(decoder != nullptr);
+			Core::Assert(Decode(*decoder, compressed, step, outputSize) == original);
+			Core::Assert(decoder->IsFinished());
+		}
+
+		// Truncated bodies don't reach the end.
+		auto decoder = registry.Create(coding);
+		Decode(*decoder, std::string_view(compressed).substr(0, compressed.size() / 2), 4096, 4096);
+		Core::Assert(!decoder->IsFinished());
+	}
+
+	// Gzip bodies can be made of several members.
+	ZlibDecoder decoder(ZlibDecoder::Format::GZip);
+	Core::Assert(Decode(decoder, Compress("first ", 31) + Compress("second", 31), 5, 3) == "first second");
+	Core::Assert(decoder.IsFinished());
+}
+
+
+std::vector<uint8_t> FromHex(std::string_view hex)
+{
+	std::vector<uint8_t> bytes;
+	for (size_t i = 0; i + 1 < hex.size(); i += 2) bytes.push_back(static_cast<uint8_t>(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+	return bytes;
+}
+
+
+void TestHPACK()
+{
+	// Requests with Huffman coding, from RFC 7541 appendix C.4, which share a dynamic table.
+	HPACK::Decoder decoder;
+	auto first = decoder.Decode(FromHex("828684418cf1e3c2e5f23a6ba0ab90f4ff")).Unwrap();
+	Core::AssertEQ(first.size(), size_t(4));
+	Core::AssertEQ(first[0].value, std::string("GET"));
+	Core::AssertEQ(first[3].value, std::string("www.example.com"));
+	auto second = decoder.Decode(FromHex("828684be5886a8eb10649cbf")).Unwrap();
+	Core::AssertEQ(second[3].value, std::string("www.example.com"));
+	Core::AssertEQ(second[4].value, std::string("no-cache"));
+	auto third = decoder.Decode(FromHex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf")).Unwrap();
+	Core::AssertEQ(third[4].name, std::string("custom-key"));
+	Core::AssertEQ(third[4].value, std::string("custom-value"));
+
+	// References past the end of the tables, and padding which isn't all ones, are rejected.
+	Core::Assert(!HPACK::Decoder().Decode(FromHex("be")));
+	Core::Assert(!HPACK::Huffman::Decode(FromHex("f1e3c2e5f23a6ba0ab90f400")));
+
+	// Encoded blocks decode to the same fields, and shrink as the table fills.
+	HPACK::Encoder                  encoder;
+	HPACK::Decoder                  peer;
+	std::vector<HPACK::HeaderField> fields = {{":method", "GET"}, {":path", "/api?id=1"}, {"authorization", "secret"}, {"x-trace", "a b c"}};
+	size_t                          lastSize = SIZE_MAX;
+	for (int i = 0; i < 3; i++)
+	{
+		std::vector<uint8_t> block;
+		encoder.Encode(fields, block);
+		auto decoded = peer.Decode(block).Unwrap();
+		Core::AssertEQ(decoded.size(), fields.size());
+		for (size_t j = 0; j < fields.size(); j++)
+		{
+			Core::AssertEQ(decoded[j].name, fields[j].name);
+			Core::AssertEQ(decoded[j].value, fields[j].value);
+		}
+		Core::Assert(block.size() <= lastSize);
+		lastSize = block.size();
+	}
+}
+
+
+/// Parses the whole of a request in place, and returns the status of the error if it's rejected.
+unsigned int ParseRequest(std::string text, std::string& body)
+{
+	std::vector<uint8_t> buffer(text.begin(), text.end());
+	RequestParser        parser;
+	size_t               consumed = 0;
+	auto                 request  = parser.Parse(buffer, consumed);
+	if (!request) return parser.GetErrorStatus();
+
+	Core::AssertEQ(consumed, buffer.size());
+	body.assign(reinterpret_cast<const char*>(request->body.data()), request->body.size());
+	return 0;
+}
+
+
+void TestRequestParser()
+{
+	std::string body;
+	Core::AssertEQ(ParseRequest("POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello", body), 0u);
+	Core::AssertEQ(body, std::string("hello"));
+	Core::AssertEQ(ParseRequest("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2;x=y\r\nde\r\n0\r\nT: 1\r\n\r\n", body), 0u);
+	Core::AssertEQ(body, std::string("abcde"));
+
+	// Requests which could be framed two ways, or not at all, are rejected.
+	Core::AssertEQ(ParseRequest("POST / HTTP/1.1\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n", body), 400u);
+	Core::AssertEQ(ParseRequest("POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nab", body), 400u);
+	Core::AssertEQ(ParseRequest("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n", body), 501u);
+	Core::AssertEQ(ParseRequest("GET / HTTP/2.0\r\n\r\n", body), 505u);
+	Core::AssertEQ(ParseRequest("GET / HTTP/1.1\r\n Folded: x\r\n\r\n", body), 400u);
+
+	// Pipelined requests are parsed one at a time from the front of the buffer.
+	std::string          pipelined = "GET /a HTTP/1.1\r\n\r\nGET /b HTTP/1.1\r\n\r\n";
+	std::vector<uint8_t> buffer(pipelined.begin(), pipelined.end());
+	RequestParser        parser;
+	size_t               consumed = 0;
+	Core::AssertEQ(parser.Parse(buffer, consumed)->target, std::string_view("/a"));
+	Core::AssertEQ(parser.Parse(std::span(buffer).subspan(consumed), consumed)->target, std::string_view("/b"));
+}
+
+
+void TestHeader()
+{
+	// Every well-known name hashes back to itself, in any case.
+	for (size_t i = 0; i < HeaderName::COUNT; i++)
+	{
+		HeaderName name = static_cast<HeaderName::_Enum>(i);
+		std::string lower(name.ToString());
+		for (auto& c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		Core::Assert(*HeaderName::Parse(name.ToString()) == name);
+		Core::Assert(*HeaderName::Parse(lower) == name);
+	}
+	Core::Assert(!HeaderName::Parse("X-Custom"));
+	Core::Assert(!HeaderName::Parse("Content-Lengthx"));
+
+	Header header;
+	header.Add("content-length", "5");
+	header.Add("X-Custom", "a");
+	header.Add(HeaderName::SET_COOKIE, "x=1");
+	header.Add("Set-Cookie", "y=2");
+	header.Add("x-custom", "b");
+
+	Core::Assert(header.Contains(HeaderName::CONTENT_LENGTH));
+	Core::AssertEQ(header.Get("Content-Length"), std::string_view("5"));
+	Core::AssertEQ(header.GetAll(HeaderName::SET_COOKIE).size(), size_t(2));
+	Core::AssertEQ(header.GetAll("X-CUSTOM").size(), size_t(2));
+	Core::Assert(!header.Contains(HeaderName::HOST));
+
+	// Fields keep the order they were added in, and well-known names are spelled conventionally.
+	std::vector<std::string> names;
+	for (const auto& field : header) names.emplace_back(field.name);
+	Core::AssertEQ(names, std::vector<std::string>{"Content-Length", "X-Custom", "Set-Cookie", "Set-Cookie", "x-custom"});
+
+	header.Set("x-custom", "c");
+	header.Remove(HeaderName::SET_COOKIE);
+	Core::AssertEQ(header.Size(), size_t(2));
+	Core::AssertEQ(header.Get("X-Custom"), std::string_view("c"));
+	Core::AssertEQ(header.Get(HeaderName::CONTENT_LENGTH), std::string_view("5"));
+
+	header.Add("Connection", "Upgrade, Close");
+	Core::Assert(header.ContainsToken(HeaderName::CONNECTION, "close"));
+	Core::Assert(!header.ContainsToken("connection", "keep-alive"));
+}
+
+
+void TestArena()
+{
+	// Nothing may come from the default resource while building an exchange in an arena.
+	std::byte                           storage[4096];
+	std::pmr::monotonic_buffer_resource arena(storage, sizeof(storage), std::pmr::null_memory_resource());
+	auto*                               previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+	{
+		Request request(Verb::GET, "/a/path/which/is/too/long/for/the/small/string/buffer", Version::VERSION_1_1, &arena);
+		request.GetHeader().Add(HeaderName::HOST, "example.com");
+		request.GetHeader().Add("X-Request-Id", "0123456789abcdef0123456789abcdef");
+
+		Response response(Version::VERSION_1_1, 200, "A reason phrase which is too long for the small string buffer", &arena);
+		response.GetHeader().Add(HeaderName::CONTENT_TYPE, "text/plain; charset=utf-8");
+		Core::AssertEQ(response.GetHeader().Get("content-type"), std::string_view("text/plain; charset=utf-8"));
+	}
+	std::pmr::set_default_resource(previous);
+	arena.release();
+}
+
+
+int main()
+{
+	TestScanners();
+	TestContentDecoding();
+	TestHPACK();
+	TestRequestParser();
+	TestHeader();
+	TestArena();
+
+	static constexpr std::string_view CONTENT_LENGTH =
+		"HTTP/1.1 200 OK\r\n"
+		"Content-Type: text/plain\r\n"
+		"Content-Length:   5  \r\n"
+		"\r\n"
+		"hello";
+
+	static constexpr std::string_view CHUNKED =
+		"HTTP/1.1 201 Created\r\n"
+		"Transfer-Encoding: chunked\r\n"
+		"\r\n"
+		"5;name=value\r\nhello\r\n"
+		"7\r\n, world\r\n"
+		"0\r\n"
+		"Expires: never\r\n"
+		"\r\n";
+
+	static constexpr std::string_view UNTIL_CLOSE =
+		"HTTP/1.0 200 OK\n"
+		"\n"
+		"everything until the end";
+
+	// Feeding one byte at a time exercises resuming from every possible position.
+	for (size_t step : {size_t(1), size_t(3), size_t(4096)})
+	{
+		auto contentLength = Parse(CONTENT_LENGTH, step);
+		Core::Assert(contentLength.complete);
+		Core::AssertEQ(contentLength.status, 200u);
+		Core::AssertEQ(contentLength.reason, std::string("OK"));
+		Core::AssertEQ(contentLength.headers["Content-Length"], std::string("5"));
+		Core::AssertEQ(contentLength.body, std::string("hello"));
+		Core::Assert(contentLength.keepAlive);
+
+		auto chunked = Parse(CHUNKED, step);
+		Core::Assert(chunked.complete);
+		Core::AssertEQ(chunked.status, 201u);
+		Core::AssertEQ(chunked.body, std::string("hello, world"));
+		Core::AssertEQ(chunked.headers["Expires"], std::string("never"));
+
+		auto untilClose = Parse(UNTIL_CLOSE, step);
+		Core::Assert(untilClose.complete);
+		Core::AssertEQ(untilClose.body, std::string("everything until the end"));
+		Core::Assert(!untilClose.keepAlive);
+	}
+
+	// Connection reuse follows the version, the Connection header and the Keep-Alive parameters.
+	Core::Assert(!Parse("HTTP/1.1 204 No Content\r\nConnection: Upgrade, close\r\n\r\n", 4096).keepAlive);
+	Core::Assert(!Parse("HTTP/1.0 204 No Content\r\n\r\n", 4096).keepAlive);
+	Core::Assert(Parse("HTTP/1.0 204 No Content\r\nconnection: Keep-Alive\r\n\r\n", 4096).keepAlive);
+	Core::Assert(!Parse("HTTP/1.1 204 No Content\r\nKeep-Alive: timeout=5, max=0\r\n\r\n", 4096).keepAlive);
+	{
+		ResponseParser parser;
+		std::string_view input = "HTTP/1.1 204 No Content\r\nKeep-Alive: timeout=5, max=99\r\n\r\n";
+		size_t           consumed = 0;
+		while (!parser.IsComplete())
+		{
+			Core::Assert(parser.Next(input, consumed).IsOk());
+			input.remove_prefix(consumed);
+		}
+		Core::Assert(parser.IsKeepAlive());
+		Core::AssertEQ(parser.GetKeepAliveTimeout().Unwrap(), size_t(5));
+		Core::AssertEQ(parser.GetKeepAliveMax().Unwrap(), size_t(99));
+	}
+
+	// Transfer-Encoding overrides Content-Length, so a body which isn't chunked runs until the connection closes.
+	auto transferEncoded = Parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip\r\nContent-Length: 2\r\n\r\nnot two bytes", 4096);
+	Core::Assert(transferEncoded.complete);
+	Core::AssertEQ(transferEncoded.body, std::string("not two bytes"));
+	Core::Assert(!transferEncoded.keepAlive);
+
+	// Malformed responses are rejected.
+	Core::Assert(Parse("HTTP/1.1 20 OK\r\n\r\n", 4096).error);
+	Core::Assert(Parse("HTTP/1.1 200 OK\r\nBad Name: value\r\n\r\n", 4096).error);
+	Core::Assert(Parse("HTTP/1.1 200 OK\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n", 4096).error);
+	Core::Assert(Parse("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", 4096).error);
+	// Truncated bodies are errors, rather than complete responses.
+	Core::Assert(Parse("HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort", 4096).error);
+
+	return 0;
+}
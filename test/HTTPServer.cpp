@@ -0,0 +1,123 @@
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
+#include "Strawberry/Net/Address.hpp"
+#include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/HTTP/HTTPAsyncClient.hpp"
+#include "Strawberry/Net/HTTP/HTTPClient.hpp"
+#include "Strawberry/Net/HTTP/HTTPServer.hpp"
+#include "Strawberry/Net/Socket/TCPSocket.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Strawberry;
+using namespace Net;
+using namespace Net::HTTP;
+
+
+int main()
+{
+	Endpoint endpoint(IPv4Address::LocalHost(), 65535 - 1002);
+
+
+	// Echo each request's method, target and body back to the client.
+	HTTPServerOptions serverOptions;
+	serverOptions.threads = 2;
+	auto server = HTTPServer::Start(endpoint, [](const RequestView& request)
+	{
+		std::string body = std::string(request.method) + " " + std::string(request.target) + " ";
+		body.append(reinterpret_cast<const char*>(request.body.data()), request.body.size());
+
+		Response response(Version::VERSION_1_1, 200, "OK");
+		response.GetHeader().Set("Content-Type", "text/plain");
+		if (request.target == "/close") response.GetHeader().Set("Connection", "close");
+		response.SetPayload(Core::IO::DynamicByteBuffer(body.data(), body.size()));
+		return response;
+	}, serverOptions).Unwrap();
+
+
+	// Pipelined requests are answered in order on one connection.
+	HTTPClient           client(endpoint);
+	std::vector<Request> requests;
+	for (int i = 0; i < 8; i++)
+	{
+		requests.emplace_back(Verb::GET, "/" + std::to_string(i));
+	}
+	Request post(Verb::POST, "/upload");
+	post.GetHeader().Set("Content-Length", "5");
+	post.SetPayload(Core::IO::DynamicByteBuffer("hello", 5));
+	requests.push_back(std::move(post));
+
+	auto responses = client.Pipeline(requests);
+	Core::AssertEQ(responses.size(), requests.size());
+	for (int i = 0; i < 8; i++)
+	{
+		Core::Assert(responses[i].IsOk());
+		const auto& response = *responses[i];
+		Core::AssertEQ(response.GetStatus(), 200u);
+		Core::AssertEQ(response.GetPayload().AsString(), "GET /" + std::to_string(i) + " ");
+		Core::Assert(response.GetHeader().Contains(HeaderName::DATE));
+	}
+	Core::Assert(responses.back().IsOk());
+	Core::AssertEQ(responses.back()->GetPayload().AsString(), std::string("POST /upload hello"));
+
+
+	// Malformed requests are rejected, and the connection closed.
+	auto socket = Socket::TCPSocket::Connect(endpoint).Unwrap();
+	static constexpr std::string_view MALFORMED = "GET /\r\n\r\n";
+	socket.Write(Core::IO::DynamicByteBuffer(MALFORMED.data(), MALFORMED.size())).Unwrap();
+
+	std::string reply;
+	while (true)
+	{
+		auto bytes = socket.Read(1024);
+		if (!bytes || bytes->Size() == 0) break;
+		reply += bytes->AsString();
+	}
+	Core::Assert(reply.starts_with("HTTP/1.1 400 Bad Request\r\n"));
+	Core::Assert(reply.find("Connection: close\r\n") != std::string::npos);
+
+
+	// Requests pipelined after one which the handler closes the connection on go unanswered.
+	auto closed = Socket::TCPSocket::Connect(endpoint).Unwrap();
+	static constexpr std::string_view CLOSE_THEN_GET = "GET /close HTTP/1.1\r\nHost: localhost\r\n\r\nGET /after HTTP/1.1\r\nHost: localhost\r\n\r\n";
+	closed.Write(Core::IO::DynamicByteBuffer(CLOSE_THEN_GET.data(), CLOSE_THEN_GET.size())).Unwrap();
+
+	reply.clear();
+	while (true)
+	{
+		auto bytes = closed.Read(1024);
+		if (!bytes || bytes->Size() == 0) break;
+		reply += bytes->AsString();
+	}
+	Core::Assert(reply.find("GET /close ") != std::string::npos);
+	Core::Assert(reply.find("/after") == std::string::npos);
+
+
+	// Many requests are fanned out across a few threads, and each future gets its own response.
+	{
+		HTTPAsyncClientOptions asyncOptions;
+		asyncOptions.threads       = 3;
+		asyncOptions.pipelineDepth = 4;
+		HTTPAsyncClient asyncClient(asyncOptions);
+
+		std::vector<HTTPAsyncClient::Future> futures;
+		for (int i = 0; i < 64; i++)
+		{
+			futures.push_back(asyncClient.Send<Socket::TCPSocket>(endpoint, Request(Verb::GET, "/async/" + std::to_string(i))));
+		}
+
+		for (int i = 0; i < 64; i++)
+		{
+			auto response = futures[i].get();
+			Core::Assert(response.IsOk());
+			Core::AssertEQ(response->GetPayload().AsString(), "GET /async/" + std::to_string(i) + " ");
+		}
+		asyncClient.Wait();
+		Core::AssertEQ(asyncClient.GetPendingCount(), size_t(0));
+	}
+
+
+	server.Stop();
+	return 0;
+}
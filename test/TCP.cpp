@@ -6,6 +6,7 @@
 #include "Strawberry/Net/Socket/TCPSocket.hpp"
 #include <chrono>
 #include <random>
+#include <span>
 #include <thread>
 
 using namespace Strawberry;
@@ -75,4 +76,106 @@ int main()
 		receivedMessage = client.ReadAll(MESSAGE_SIZE).Unwrap();
 		Core::AssertEQ(receivedMessage, message);
 	}
+
+
+	// Non-blocking sockets hand control back when they can't go on, keeping track of how far they got.
+	static constexpr size_t LARGE_MESSAGE_SIZE = 64 * 1024 * 1024;
+	Endpoint endpoint(IPv4Address::LocalHost(), 65535 - 1006);
+	auto     listener = Socket::TCPListener::Bind(endpoint).Unwrap();
+	auto     client   = Socket::TCPSocket::Connect(endpoint, false).Unwrap();
+	auto     server   = listener.Accept().Unwrap();
+	server.SetBlocking(false).Unwrap();
+
+	auto message = Core::IO::DynamicByteBuffer::Zeroes(LARGE_MESSAGE_SIZE);
+	for (size_t i = 0; i < message.Size(); i++)
+	{
+		message.Data()[i] = static_cast<uint8_t>(i % 251);
+	}
+
+	Core::Assert(server.ReadAll(LARGE_MESSAGE_SIZE).Err().IsType<ErrorNoData>());
+	size_t written = 0;
+	while (true)
+	{
+		auto write = client.Write(std::span<const uint8_t>(message.Data() + written, message.Size() - written));
+		if (write)
+		{
+			break;
+		}
+
+		// The receiver isn't keeping up, so only part of the message fits in the socket buffers.
+		Core::Assert(write.Err().IsType<ErrorWantWrite>());
+		written += write.Err().Ref<ErrorWantWrite>().bytesWritten;
+		Core::Assert(written < message.Size());
+
+		auto read = server.ReadAll(LARGE_MESSAGE_SIZE);
+		Core::Assert(read.Err().IsType<ErrorNoData>());
+	}
+
+	Core::Assert(server.Poll(std::chrono::seconds(1)));
+	auto received = server.ReadAll(LARGE_MESSAGE_SIZE);
+	while (!received)
+	{
+		Core::Assert(received.Err().IsType<ErrorNoData>());
+		Core::Assert(server.Poll(std::chrono::seconds(1)));
+		received = server.ReadAll(LARGE_MESSAGE_SIZE);
+	}
+	Core::AssertEQ(received.Unwrap(), message);
+
+
+	// Writing to a connection the peer has closed fails, rather than raising SIGPIPE.
+	auto dropped = Socket::TCPSocket::Connect(endpoint).Unwrap();
+	{
+		// Closing with unread data resets the connection.
+		auto peer = listener.Accept().Unwrap();
+		dropped.Write(Core::IO::DynamicByteBuffer::Zeroes(1)).Unwrap();
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+
+	auto write = dropped.Write(Core::IO::DynamicByteBuffer::Zeroes(1));
+	for (int i = 0; i < 100 && write; i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		write = dropped.Write(Core::IO::DynamicByteBuffer::Zeroes(1));
+	}
+	Core::Assert(write.Err().IsType<ErrorConnectionReset>());
+
+
+#if STRAWBERRY_TARGET_LINUX
+	// Reads are stamped with the time the kernel received the data, and writes with the time it was sent.
+	auto timestamped = Socket::TCPSocket::Connect(endpoint).Unwrap();
+	auto receiver    = listener.Accept().Unwrap();
+	receiver.SetTimestamping(true).Unwrap();
+	timestamped.SetTransmitTimestamping(true).Unwrap();
+	Core::Assert(!receiver.GetReceiveTimestamp().HasValue());
+
+	Core::Optional<Socket::Timestamp> lastReceived;
+	for (int i = 0; i < 3; i++)
+	{
+		const auto sent = Socket::Timestamp::clock::now();
+		timestamped.Write(Core::IO::DynamicByteBuffer::Zeroes(16)).Unwrap();
+		receiver.ReadAll(16).Unwrap();
+
+		auto timestamp = receiver.GetReceiveTimestamp();
+		Core::Assert(timestamp.HasValue());
+		Core::Assert(*timestamp >= sent);
+		Core::Assert(Socket::GetQueueingDelay(*timestamp) >= std::chrono::nanoseconds(0));
+		if (lastReceived) Core::Assert(*timestamp >= *lastReceived);
+		lastReceived = timestamp;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	// Transmit timestamps are identified by the offset of the last byte of each write.
+	Core::Optional<Socket::Timestamp> lastSent;
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		auto transmitted = timestamped.ReadTransmitTimestamp();
+		Core::Assert(transmitted.HasValue());
+		Core::AssertEQ(transmitted->id, 16 * (i + 1) - 1);
+		if (lastSent) Core::Assert(transmitted->timestamp >= *lastSent);
+		lastSent = transmitted->timestamp;
+	}
+
+	receiver.SetTimestamping(false).Unwrap();
+	Core::Assert(!receiver.GetReceiveTimestamp().HasValue());
+#endif
 }
@@ -0,0 +1,476 @@
+#include "Strawberry/Core/Assert.hpp"
+#include "Strawberry/Core/IO/DynamicByteBuffer.hpp"
+#include "Strawberry/Net/Address.hpp"
+#include "Strawberry/Net/Endpoint.hpp"
+#include "Strawberry/Net/HTTP/HTTPClient.hpp"
+#include "Strawberry/Net/Socket/TCPListener.hpp"
+#include "Strawberry/Net/Socket/TLSContext.hpp"
+#include "Strawberry/Net/Socket/TLSEngine.hpp"
+#include "Strawberry/Net/Socket/TLSListener.hpp"
+#include "Strawberry/Net/Socket/TLSSessionCache.hpp"
+#include "Strawberry/Net/Socket/TLSSocket.hpp"
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#if STRAWBERRY_TARGET_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Strawberry;
+using namespace Net;
+using namespace Net::Socket;
+
+
+struct Certificate
+{
+	std::string certificateFile;
+	std::string privateKeyFile;
+};
+
+
+/// Writes a self-signed certificate for localhost and 127.0.0.1, and its key, to PEM files in the given directory.
+Certificate MakeCertificate(const std::filesystem::path& directory)
+{
+	std::filesystem::create_directories(directory);
+	Certificate files {(directory / "certificate.pem").string(), (directory / "key.pem").string()};
+
+	EVP_PKEY* key         = EVP_EC_gen("P-256");
+	X509*     certificate = X509_new();
+	Core::Assert(key && certificate);
+
+	X509_set_version(certificate, 2);
+	ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+	X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+	X509_gmtime_adj(X509_getm_notAfter(certificate), 60 * 60);
+	X509_set_pubkey(certificate, key);
+
+	X509_NAME* name = X509_get_subject_name(certificate);
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+	X509_set_issuer_name(certificate, name);
+
+	X509V3_CTX extensionContext;
+	X509V3_set_ctx_nodb(&extensionContext);
+	X509V3_set_ctx(&extensionContext, certificate, certificate, nullptr, nullptr, 0);
+	X509_EXTENSION* names = X509V3_EXT_conf_nid(nullptr, &extensionContext, NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1");
+	X509_EXTENSION* basic = X509V3_EXT_conf_nid(nullptr, &extensionContext, NID_basic_constraints, "critical,CA:TRUE");
+	Core::Assert(names && basic);
+	X509_add_ext(certificate, names, -1);
+	X509_add_ext(certificate, basic, -1);
+	X509_EXTENSION_free(names);
+	X509_EXTENSION_free(basic);
+	Core::Assert(X509_sign(certificate, key, EVP_sha256()) > 0);
+
+	FILE* file = std::fopen(files.certificateFile.c_str(), "w");
+	PEM_write_X509(file, certificate);
+	std::fclose(file);
+	file = std::fopen(files.privateKeyFile.c_str(), "w");
+	PEM_write_PrivateKey(file, key, nullptr, nullptr, 0, nullptr, nullptr);
+	std::fclose(file);
+
+	X509_free(certificate);
+	EVP_PKEY_free(key);
+	return files;
+}
+
+
+Core::IO::DynamicByteBuffer Bytes(std::string_view string)
+{
+	return {string.data(), string.size()};
+}
+
+
+/// A client engine connected to an OpenSSL server through memory buffers.
+struct EnginePeer
+{
+	TLSEngine engine;
+	SSL*      peer;
+	BIO*      peerIn;
+	BIO*      peerOut;
+
+
+	EnginePeer(TLSEngine engine, const TLSContext& server)
+		: engine(std::move(engine))
+		, peer(SSL_new(server.GetHandle()))
+		, peerIn(BIO_new(BIO_s_mem()))
+		, peerOut(BIO_new(BIO_s_mem()))
+	{
+		BIO_set_mem_eof_return(peerIn, -1);
+		SSL_set_bio(peer, peerIn, peerOut);
+		SSL_set_accept_state(peer);
+	}
+
+
+	EnginePeer(const EnginePeer&)            = delete;
+	EnginePeer& operator=(const EnginePeer&) = delete;
+
+
+	~EnginePeer()
+	{
+		SSL_free(peer);
+	}
+
+
+	/// Passes whatever each side has written to the other.
+	void Exchange()
+	{
+		auto toPeer = engine.ReadCiphertext();
+		if (toPeer.Size() > 0) BIO_write(peerIn, toPeer.Data(), static_cast<int>(toPeer.Size()));
+
+		uint8_t buffer[16 * 1024];
+		int     read;
+		while ((read = BIO_read(peerOut, buffer, sizeof(buffer))) > 0) engine.WriteCiphertext(buffer, read);
+	}
+
+
+	void Handshake()
+	{
+		for (int i = 0; i < 8 && !(engine.IsHandshakeComplete() && SSL_is_init_finished(peer)); i++)
+		{
+			(void) engine.Handshake();
+			Exchange();
+			SSL_do_handshake(peer);
+			Exchange();
+		}
+		Core::Assert(engine.IsHandshakeComplete());
+		Core::Assert(SSL_is_init_finished(peer));
+	}
+};
+
+
+int main()
+{
+	const auto directory   = std::filesystem::temp_directory_path() / "StrawberryNetTLS";
+	const auto certificate = MakeCertificate(directory);
+
+	TLSServerOptions serverOptions;
+	serverOptions.certificateChainFile = certificate.certificateFile;
+	serverOptions.privateKeyFile       = certificate.privateKeyFile;
+	auto server = TLSContext::CreateServer(serverOptions).Unwrap();
+
+	// Endpoints given by address are verified against the certificate's IP addresses.
+	TLSContextOptions clientOptions;
+	clientOptions.verifyPeer = true;
+	clientOptions.trustStore = TLSTrustStore::Load(certificate.certificateFile).Unwrap();
+	auto client = TLSContext::Create(clientOptions).Unwrap();
+
+
+	// Data which has been received but not yet decrypted is reported by Poll(), both when OpenSSL has read
+	// ahead on non-blocking sockets and when it has been left on blocking ones.
+	Endpoint endpoint(IPv4Address::LocalHost(), 65535 - 1004);
+	auto     listener = TCPListener::Bind(endpoint).Unwrap();
+	for (bool blocking : {false, true})
+	{
+		std::thread serverThread([&]
+		{
+			auto socket = TLSSocket::Accept(listener.Accept().Unwrap(), server).Unwrap();
+
+			// Two records, sent together.
+			TLSRecordSizing sizing;
+			sizing.smallRecordSize = 512;
+			socket.SetRecordSizing(sizing);
+			socket.Write(Core::IO::DynamicByteBuffer::Zeroes(1024)).Unwrap();
+
+			// Wait for the client to finish before closing.
+			socket.ReadAll(1).Unwrap();
+		});
+
+		TLSConnectOptions options;
+		options.context  = client;
+		options.blocking = blocking;
+		auto socket      = TLSSocket::Connect(endpoint, options).Unwrap();
+		while (!socket.IsHandshakeComplete())
+		{
+			auto handshake = socket.Handshake();
+			Core::Assert(handshake || handshake.Err().IsType<ErrorWantRead>() || handshake.Err().IsType<ErrorWantWrite>());
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		Core::AssertEQ(socket.Read(512).Unwrap().Size(), size_t(512));
+		Core::Assert(socket.Poll());
+		Core::AssertEQ(socket.Read(512).Unwrap().Size(), size_t(512));
+		Core::Assert(!socket.Poll());
+
+		socket.Write(Core::IO::DynamicByteBuffer::Zeroes(1)).Unwrap();
+		serverThread.join();
+	}
+
+
+#if STRAWBERRY_TARGET_LINUX
+	// Files and pipes are sent whole, through the kernel with kernel TLS, or else read and encrypted in user space.
+	auto content = Core::IO::DynamicByteBuffer::Zeroes(200000);
+	for (size_t i = 0; i < content.Size(); i++) content.Data()[i] = static_cast<uint8_t>(i % 251);
+	const auto contentFile = (directory / "content.bin").string();
+	{
+		FILE* file = std::fopen(contentFile.c_str(), "wb");
+		std::fwrite(content.Data(), 1, content.Size(), file);
+		std::fclose(file);
+	}
+	const int contentDescriptor = open(contentFile.c_str(), O_RDONLY);
+	Core::Assert(contentDescriptor >= 0);
+
+	for (bool kernelTLS : {false, true})
+	{
+		std::thread serverThread([&]
+		{
+			auto socket = TLSSocket::Accept(listener.Accept().Unwrap(), server).Unwrap();
+			Core::AssertEQ(socket.ReadAll(150000).Unwrap(), Core::IO::DynamicByteBuffer(content.Data() + 1000, 150000));
+			Core::AssertEQ(socket.ReadAll(content.Size()).Unwrap(), content);
+			socket.Write(Core::IO::DynamicByteBuffer::Zeroes(1)).Unwrap();
+		});
+
+		TLSConnectOptions options;
+		options.context   = client;
+		options.kernelTLS = kernelTLS;
+		auto socket       = TLSSocket::Connect(endpoint, options).Unwrap();
+		socket.SendFile(contentDescriptor, 1000, 150000).Unwrap();
+
+		// Pipes hold less than the content, so it is written in while being spliced out.
+		int pipeDescriptors[2];
+		Core::Assert(pipe(pipeDescriptors) == 0);
+		std::thread pipeThread([&]
+		{
+			Core::AssertEQ(write(pipeDescriptors[1], content.Data(), content.Size()), static_cast<ssize_t>(content.Size()));
+		});
+		socket.Splice(pipeDescriptors[0], content.Size()).Unwrap();
+		pipeThread.join();
+		close(pipeDescriptors[0]);
+		close(pipeDescriptors[1]);
+
+		socket.ReadAll(1).Unwrap();
+		serverThread.join();
+	}
+	close(contentDescriptor);
+#endif
+
+
+	// Servers pick the first of their ALPN protocols which the client offers, and none when there is no overlap.
+	TLSServerOptions alpnServerOptions = serverOptions;
+	alpnServerOptions.alpnProtocols    = {"h2", "http/1.1"};
+	auto alpnServer = TLSContext::CreateServer(alpnServerOptions).Unwrap();
+	for (const auto& [offered, selected] : std::vector<std::pair<std::vector<std::string>, Core::Optional<std::string>>> {
+			 {{"http/1.1", "h2"}, std::string("h2")},
+			 {{"http/1.1"}, std::string("http/1.1")},
+			 {{"spdy/3"}, {}},
+		 })
+	{
+		std::thread serverThread([&]
+		{
+			auto socket = TLSSocket::Accept(listener.Accept().Unwrap(), alpnServer).Unwrap();
+			Core::AssertEQ(socket.GetALPNProtocol(), selected);
+			socket.ReadAll(1).Unwrap();
+		});
+
+		TLSContextOptions alpnClientOptions = clientOptions;
+		alpnClientOptions.alpnProtocols     = offered;
+		auto socket = TLSSocket::Connect(endpoint, TLSContext::Create(alpnClientOptions).Unwrap()).Unwrap();
+		Core::AssertEQ(socket.GetALPNProtocol(), selected);
+		socket.Write(Bytes(".")).Unwrap();
+		serverThread.join();
+	}
+
+
+	// Clients verifying their peer refuse certificates which aren't issued by an authority they trust.
+	{
+		std::thread serverThread([&]
+		{
+			Core::Assert(!TLSSocket::Accept(listener.Accept().Unwrap(), server).IsOk());
+		});
+
+		TLSContextOptions untrustingOptions;
+		untrustingOptions.verifyPeer = true;
+		untrustingOptions.trustStore = TLSTrustStore::System().Unwrap();
+		auto socket = TLSSocket::Connect(endpoint, TLSContext::Create(untrustingOptions).Unwrap());
+		Core::Assert(!socket.IsOk());
+		Core::Assert(socket.Err().IsType<ErrorSSLHandshake>());
+		serverThread.join();
+	}
+
+
+	// Listeners hand handshakes to their workers, and clients resume sessions from the tickets they were sent.
+	Endpoint         listenerEndpoint(IPv4Address::LocalHost(), 65535 - 1005);
+	auto             tlsListener = TLSListener::Bind(listenerEndpoint, server, TLSListenerOptions {
+		.handshakeWorkers = 2,
+		.handshakeTimeout = std::chrono::milliseconds(500),
+	}).Unwrap();
+	std::atomic<int> handshakes = 0;
+	std::atomic<int> timeouts   = 0;
+	std::thread      acceptThread([&]
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			tlsListener.Accept([&](Core::Result<TLSSocket, Error> socket)
+			{
+				if (!socket)
+				{
+					if (socket.Err().IsType<ErrorTimeout>()) timeouts++;
+					return;
+				}
+
+				handshakes++;
+				socket->Write(Core::IO::DynamicByteBuffer::Zeroes(1)).Unwrap();
+				socket->ReadAll(1).Unwrap();
+			}).Unwrap();
+		}
+	});
+
+	for (bool resumed : {false, true})
+	{
+		auto socket = TLSSocket::Connect(listenerEndpoint, client).Unwrap();
+		Core::AssertEQ(socket.IsSessionReused(), resumed);
+		// Tickets arrive after the handshake, and are taken in while reading.
+		socket.ReadAll(1).Unwrap();
+		socket.Write(Core::IO::DynamicByteBuffer::Zeroes(1)).Unwrap();
+	}
+
+
+	// Sessions are evicted once the cache is full, oldest first. TLS 1.3 tickets are only handed out once.
+	{
+		auto makeSession = [](int version, uint8_t id)
+		{
+			SSL_SESSION* session = SSL_SESSION_new();
+			SSL_SESSION_set1_id(session, &id, 1);
+			SSL_SESSION_set_protocol_version(session, version);
+			return session;
+		};
+
+		TLSSessionCache cache(2);
+		cache.Store("a", makeSession(TLS1_2_VERSION, 1));
+		cache.Store("b", makeSession(TLS1_2_VERSION, 2));
+		cache.Store("c", makeSession(TLS1_3_VERSION, 3));
+		Core::AssertEQ(cache.Size(), size_t(2));
+		Core::Assert(cache.Take("a") == nullptr);
+
+		for (int i = 0; i < 2; i++)
+		{
+			SSL_SESSION* session = cache.Take("b");
+			Core::Assert(session != nullptr);
+			SSL_SESSION_free(session);
+		}
+
+		SSL_SESSION* ticket = cache.Take("c");
+		Core::Assert(ticket != nullptr);
+		SSL_SESSION_free(ticket);
+		Core::Assert(cache.Take("c") == nullptr);
+		Core::AssertEQ(cache.Size(), size_t(1));
+	}
+
+
+	// Early data which the server rejects is sent again after the handshake, so it arrives exactly once.
+	auto earlyDataServer = TLSContext::CreateServer(serverOptions).Unwrap();
+	// Tickets allow early data, but accepting connections with a plain handshake rejects it.
+	SSL_CTX_set_max_early_data(earlyDataServer.GetHandle(), 1024);
+	Endpoint    earlyDataEndpoint(IPv4Address::LocalHost(), 65535 - 1011);
+	auto        earlyDataListener = TCPListener::Bind(earlyDataEndpoint).Unwrap();
+	std::thread earlyDataThread([&]
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			auto socket = TLSSocket::Accept(earlyDataListener.Accept().Unwrap(), earlyDataServer).Unwrap();
+			Core::AssertEQ(socket.ReadAll(5).Unwrap(), Bytes("hello"));
+			socket.Write(Bytes("!")).Unwrap();
+			Core::AssertEQ(socket.ReadAll(1).Unwrap(), Bytes("."));
+		}
+	});
+
+	for (bool resumed : {false, true})
+	{
+		auto socket = TLSSocket::Connect(earlyDataEndpoint, Bytes("hello")).Unwrap();
+		Core::AssertEQ(socket.IsSessionReused(), resumed);
+		Core::Assert(!socket.WasEarlyDataAccepted());
+		Core::AssertEQ(socket.ReadAll(1).Unwrap(), Bytes("!"));
+		socket.Write(Bytes(".")).Unwrap();
+	}
+	earlyDataThread.join();
+
+
+	// Clients which never send a handshake are dropped once it times out.
+	auto silent = TCPSocket::Connect(listenerEndpoint).Unwrap();
+	acceptThread.join();
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	Core::AssertEQ(timeouts.load(), 1);
+	Core::AssertEQ(handshakes.load(), 2);
+
+
+	// HTTPS clients reconnect with the context they were created with, so its session cache resumes the session.
+	Endpoint    httpsEndpoint(IPv4Address::LocalHost(), 65535 - 1007);
+	auto        httpsListener = TCPListener::Bind(httpsEndpoint).Unwrap();
+	std::thread httpsThread([&]
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			auto        socket = TLSSocket::Accept(httpsListener.Accept().Unwrap(), server).Unwrap();
+			std::string request;
+			while (request.find("\r\n\r\n") == std::string::npos) request += socket.Read(4096).Unwrap().AsString();
+			socket.Write(Bytes("HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok")).Unwrap();
+		}
+	});
+
+	HTTP::HTTPSClient          httpsClient(httpsEndpoint, client);
+	std::vector<HTTP::Request> requests;
+	for (int i = 0; i < 2; i++)
+	{
+		HTTP::Request request(HTTP::Verb::GET, "/");
+		request.GetHeader().Set("Host", "localhost");
+		requests.push_back(std::move(request));
+	}
+	for (auto& response : httpsClient.Pipeline(requests))
+	{
+		Core::AssertEQ(response.Unwrap().GetPayload(), Bytes("ok"));
+	}
+	Core::Assert(std::move(httpsClient).IntoSocket().TakeSocket().IsSessionReused());
+	httpsThread.join();
+
+
+	// Engines verifying their peer need a name or address to check it against.
+	Core::Assert(!TLSEngine::Client(client).IsOk());
+
+
+	// Engines handshake and exchange data with a peer over memory buffers.
+	EnginePeer pair(TLSEngine::Client(client, std::string("localhost")).Unwrap(), server);
+	pair.Handshake();
+
+	pair.engine.Encrypt(Bytes("ping")).Unwrap();
+	pair.Exchange();
+	char received[4];
+	Core::AssertEQ(SSL_read(pair.peer, received, sizeof(received)), 4);
+	Core::AssertEQ(std::string_view(received, sizeof(received)), std::string_view("ping"));
+
+	Core::AssertEQ(SSL_write(pair.peer, "pong", 4), 4);
+	pair.Exchange();
+	Core::AssertEQ(pair.engine.Decrypt().Unwrap(), Bytes("pong"));
+	Core::Assert(pair.engine.Decrypt().Err().IsType<ErrorNoData>());
+
+	// Each side sees the other's close_notify.
+	pair.engine.Shutdown();
+	pair.Exchange();
+	Core::AssertEQ(SSL_read(pair.peer, received, sizeof(received)), 0);
+	Core::AssertEQ(SSL_get_error(pair.peer, 0), SSL_ERROR_ZERO_RETURN);
+	SSL_shutdown(pair.peer);
+	pair.Exchange();
+	Core::Assert(pair.engine.Decrypt().Err().IsType<ErrorConnectionReset>());
+
+
+	// Malformed records from the peer are errors.
+	EnginePeer corrupted(TLSEngine::Client(client, std::string("localhost")).Unwrap(), server);
+	corrupted.Handshake();
+	Core::AssertEQ(SSL_write(corrupted.peer, "data", 4), 4);
+	auto record = Core::IO::DynamicByteBuffer::Zeroes(BIO_ctrl_pending(corrupted.peerOut));
+	Core::AssertEQ(BIO_read(corrupted.peerOut, record.Data(), static_cast<int>(record.Size())), static_cast<int>(record.Size()));
+	record.Data()[record.Size() - 1] ^= 0xFF;
+	corrupted.engine.WriteCiphertext(record);
+	Core::Assert(corrupted.engine.Decrypt().Err().IsType<ErrorOpenSSL>());
+
+
+	std::filesystem::remove_all(directory);
+	return 0;
+}
@@ -73,4 +73,88 @@ int main()
 	Core::Logging::Trace("Receiving message B");
 	auto receivedB = clientA.Receive().Unwrap();
 	Core::AssertEQ(receivedB.contents, messageB);
+
+
+	// Non-blocking sockets should report that they have been drained.
+	clientA.SetBlocking(false).Unwrap();
+	auto drained = clientA.Receive();
+	Core::Assert(drained.IsErr() && drained.Err().IsType<ErrorNoData>());
+
+
+	// Packets sent to a multicast group are looped back to every local member of the group.
+	// Members share the port, and everything goes over the loopback interface so no network is needed.
+	static constexpr uint16_t multicastPort = 65535 - 1012;
+#if STRAWBERRY_TARGET_MAC
+	const auto loopback = UDPSocket::GetInterfaceIndex("lo0").Unwrap();
+#else
+	const auto loopback = UDPSocket::GetInterfaceIndex("lo").Unwrap();
+#endif
+	const IPAddress group = IPv4Address(239, 255, 0, 1);
+
+	UDPSocket memberA = UDPSocket::CreateIPv4().Unwrap();
+	UDPSocket memberB = UDPSocket::CreateIPv4().Unwrap();
+	for (auto* member : {&memberA, &memberB})
+	{
+		member->SetReuseAddress(true).Unwrap();
+		member->Bind(Endpoint::AnyIPv4(multicastPort)).Unwrap();
+		member->JoinGroup(group, loopback).Unwrap();
+	}
+
+	UDPSocket sender = UDPSocket::CreateIPv4().Unwrap();
+	sender.SetMulticastInterface(loopback).Unwrap();
+	sender.SetMulticastTTL(1).Unwrap();
+	sender.SetMulticastLoopback(true).Unwrap();
+
+	const auto multicastMessage = CreateRandomMessage();
+	sender.Send(Endpoint(group, multicastPort), multicastMessage).Unwrap();
+	Wait();
+	Core::Assert(memberA.Poll());
+	Core::AssertEQ(memberA.Receive().Unwrap().contents, multicastMessage);
+	Core::Assert(memberB.Poll());
+	Core::AssertEQ(memberB.Receive().Unwrap().contents, multicastMessage);
+
+	// Once every member has left, the group's packets are no longer delivered.
+	// Linux delivers a group to every socket bound to the port while any of them is a member,
+	// so individual members leaving isn't observable here.
+	memberA.LeaveGroup(group, loopback).Unwrap();
+	memberB.LeaveGroup(group, loopback).Unwrap();
+	sender.Send(Endpoint(group, multicastPort), multicastMessage).Unwrap();
+	Wait();
+	Core::Assert(!memberA.Poll());
+	Core::Assert(!memberB.Poll());
+
+
+	// Packets are stamped with the time the kernel received them, which never goes backwards.
+	clientB.SetTimestamping(true).Unwrap();
+#if STRAWBERRY_TARGET_LINUX
+	clientA.SetTransmitTimestamping(true).Unwrap();
+#endif
+	Core::Optional<Timestamp> lastReceived;
+	for (int i = 0; i < 3; i++)
+	{
+		const auto sent = Timestamp::clock::now();
+		clientA.Send(Endpoint::LocalHostIPv4(portB), messageA).Unwrap();
+		auto packet = clientB.Receive().Unwrap();
+
+		Core::Assert(packet.timestamp.HasValue());
+		Core::Assert(*packet.timestamp >= sent);
+		Core::Assert(GetQueueingDelay(*packet.timestamp) >= std::chrono::nanoseconds(0));
+		if (lastReceived) Core::Assert(*packet.timestamp >= *lastReceived);
+		lastReceived = packet.timestamp;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+#if STRAWBERRY_TARGET_LINUX
+	// Each sent packet gets a transmit timestamp, numbered in the order they were sent.
+	Core::Optional<Timestamp> lastSent;
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		auto transmitted = clientA.ReadTransmitTimestamp();
+		Core::Assert(transmitted.HasValue());
+		Core::AssertEQ(transmitted->id, i);
+		if (lastSent) Core::Assert(transmitted->timestamp >= *lastSent);
+		lastSent = transmitted->timestamp;
+	}
+	Core::Assert(!clientA.ReadTransmitTimestamp().HasValue());
+#endif
 }